@@ -0,0 +1,49 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include <cstdint>
+#include <vector>
+
+// Учет активных областей поля. Поле делится на плитки TILE_WIDTH x TILE_HEIGHT клеток;
+// трекер помнит, какие плитки изменились за последнее поколение. Следующее поколение
+// нужно считать только в них и в их соседях (на торе): остальные плитки не изменятся.
+class ActivityTracker {
+public:
+    static const int TILE_WORDS = 1;                               // ширина плитки в словах строки
+    static const int TILE_WIDTH = TILE_WORDS * BitGrid::WORD_BITS; // ширина плитки в клетках
+    static const int TILE_HEIGHT = 16;                             // высота плитки в строках
+
+    ActivityTracker();
+    ActivityTracker(int width, int height);
+
+    int getTilesX() const;
+    int getTilesY() const;
+
+    // изменившиеся плитки; номер плитки — tileY * getTilesX() + tileX
+    bool isChanged(int tileX, int tileY) const;
+    const std::vector<int>& getChangedTiles() const;
+
+    void markAll();                  // все поле изменилось (новое поле, сброс)
+    void markCell(int row, int col); // клетка изменена вне update()
+
+    // Шаг поколения: beginStep() находит плитки для пересчета, затем для каждой из них
+    // вызывается setChanged() (разные строки плиток можно обрабатывать параллельно),
+    // endStep() собирает новый список изменившихся плиток.
+    void beginStep();
+    const std::vector<int>& getActiveBands() const; // строки плиток, где есть что считать
+    bool isActive(int tileX, int tileY) const;
+    void setChanged(int tileX, int tileY, bool tileChanged);
+    void endStep();
+
+private:
+    void activate(int tileX, int tileY);
+
+    int tilesX;
+    int tilesY;
+    std::vector<std::uint8_t> changed;
+    std::vector<std::uint8_t> active;
+    std::vector<std::uint8_t> bandActive;
+    std::vector<int> changedTiles;
+    std::vector<int> activeTiles;
+    std::vector<int> activeBands;
+};
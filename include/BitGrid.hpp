@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// аллокатор, выравнивающий начало буфера по заданной границе (для строк по кэш-линии)
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        std::size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void* ptr = std::aligned_alloc(Alignment, bytes);
+        if (!ptr) throw std::bad_alloc();
+        allocationCounter().fetch_add(1, std::memory_order_relaxed);
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t) { std::free(ptr); }
+
+    // сколько раз выделялась память этим аллокатором за время работы программы
+    static std::atomic<std::size_t>& allocationCounter() {
+        static std::atomic<std::size_t> counter{0};
+        return counter;
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+// Упакованное игровое поле: 1 бит на клетку, все строки лежат в одном непрерывном блоке
+// 64-битных слов. Клетка (row, col) хранится в бите col % 64 слова col / 64 строки row.
+// Каждая строка дополнена до целого числа кэш-линий, биты за пределами ширины всегда равны 0.
+class BitGrid {
+public:
+    static const int WORD_BITS = 64;
+    static const int CACHE_LINE_BYTES = 64;
+    static const int CACHE_LINE_WORDS = CACHE_LINE_BYTES / sizeof(std::uint64_t);
+
+    // строка поля только для чтения, чтобы можно было писать grid[row][col]
+    class RowView {
+    public:
+        RowView(const std::uint64_t* words, int width) : words(words), width(width) {}
+        bool operator[](int col) const { return (words[col / WORD_BITS] >> (col % WORD_BITS)) & 1u; }
+        std::size_t size() const { return static_cast<std::size_t>(width); }
+
+    private:
+        const std::uint64_t* words;
+        int width;
+    };
+
+    BitGrid();
+    BitGrid(int width, int height); // создает поле из мертвых клеток
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getWordsPerRow() const { return wordsPerRow; } // слова, в которых есть клетки
+    int getStride() const { return stride; }           // слова между началами соседних строк
+    std::uint64_t getLastWordMask() const { return lastWordMask; } // значимые биты последнего слова строки
+
+    std::size_t size() const { return static_cast<std::size_t>(height); }
+    RowView operator[](int row) const { return RowView(this->row(row), width); }
+
+    std::uint64_t* row(int r) { return words.data() + static_cast<std::size_t>(r) * stride; }
+    const std::uint64_t* row(int r) const { return words.data() + static_cast<std::size_t>(r) * stride; }
+
+    bool get(int r, int col) const { return (row(r)[col / WORD_BITS] >> (col % WORD_BITS)) & 1u; }
+
+    void set(int r, int col, bool alive) {
+        std::uint64_t bit = std::uint64_t(1) << (col % WORD_BITS);
+        std::uint64_t& word = row(r)[col / WORD_BITS];
+        word = alive ? (word | bit) : (word & ~bit);
+    }
+
+    // count (1..64) клеток строки r со столбца col, клетка col — в младшем бите;
+    // col + count не больше ширины, так что слово за концом строки не читается
+    std::uint64_t getBits(int r, int col, int count) const {
+        const std::uint64_t* w = row(r) + col / WORD_BITS;
+        int shift = col % WORD_BITS;
+        std::uint64_t bits = w[0] >> shift;
+        if (shift + count > WORD_BITS) {
+            bits |= w[1] << (WORD_BITS - shift);
+        }
+        return count == WORD_BITS ? bits : bits & ((std::uint64_t(1) << count) - 1);
+    }
+
+    void setBits(int r, int col, int count, std::uint64_t bits) {
+        std::uint64_t mask = count == WORD_BITS ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+        bits &= mask;
+        std::uint64_t* w = row(r) + col / WORD_BITS;
+        int shift = col % WORD_BITS;
+        w[0] = (w[0] & ~(mask << shift)) | (bits << shift);
+        if (shift + count > WORD_BITS) {
+            w[1] = (w[1] & ~(mask >> (WORD_BITS - shift))) | (bits >> (WORD_BITS - shift));
+        }
+    }
+
+    void clear();                   // делает все клетки мертвыми
+    std::size_t population() const; // количество живых клеток
+
+    bool operator==(const BitGrid& other) const;
+    bool operator!=(const BitGrid& other) const { return !(*this == other); }
+
+    // число выделений памяти под все поля BitGrid; позволяет проверить, что шаги не выделяют память
+    static std::size_t getAllocationCount();
+
+private:
+    using Allocator = AlignedAllocator<std::uint64_t, CACHE_LINE_BYTES>;
+
+    int width;
+    int height;
+    int wordsPerRow;
+    int stride;
+    std::uint64_t lastWordMask;
+    std::vector<std::uint64_t, Allocator> words;
+};
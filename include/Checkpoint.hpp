@@ -0,0 +1,110 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include "LifeRule.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class GameOfLifeCore;
+
+// Двоичный снимок поля для остановки и продолжения долгих прогонов. Файл — заголовок
+// на одну страницу (размеры, правило, поколение, контрольная сумма), за ним строки поля
+// ровно в том виде, в каком они лежат в BitGrid. Запись — один вызов writev во временный
+// файл и переименование, так что недописанный снимок никогда не заменит готовый.
+// Чтение — mmap: данные не разбираются и не копируются через буфер чтения.
+namespace Checkpoint {
+
+const std::uint32_t VERSION = 1;
+const std::size_t HEADER_BYTES = 4096; // строки начинаются с границы страницы
+
+bool save(const std::string& path, const BitGrid& grid, const LifeRule& rule, std::uint64_t generation,
+          std::string& error);
+bool save(const std::string& path, const GameOfLifeCore& game, std::string& error);
+
+// Загружает снимок в game (поле, правило, поколение). verify — сверить контрольную сумму,
+// это один проход по данным. Поколение больше INT_MAX — ошибка. При ошибке game не меняется.
+bool restore(const std::string& path, GameOfLifeCore& game, std::string& error, bool verify = true);
+
+bool isCheckpoint(const std::string& path); // в начале файла сигнатура снимка
+
+std::uint64_t checksum(const std::uint64_t* words, std::size_t count);
+
+} // namespace Checkpoint
+
+// Снимок, отображенный в память только для чтения. Строки читаются прямо из страниц файла:
+// ничего не копируется, пока их не тронут.
+class MappedCheckpoint {
+public:
+    MappedCheckpoint();
+    ~MappedCheckpoint();
+
+    MappedCheckpoint(const MappedCheckpoint&) = delete;
+    MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+
+    bool open(const std::string& path, std::string& error); // проверяет заголовок, но не данные
+    void close();
+    bool verify() const; // контрольная сумма данных совпадает с заголовком
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    std::uint64_t getGeneration() const { return generation; }
+    const LifeRule& getRule() const { return rule; }
+
+    const std::uint64_t* row(int r) const { return data + static_cast<std::size_t>(r) * stride; }
+    void copyTo(BitGrid& grid) const; // grid должен быть того же размера
+
+private:
+    void* mapping;
+    std::size_t mappingBytes;
+    const std::uint64_t* data;
+    int width;
+    int height;
+    int stride; // слов между началами строк в файле
+    std::uint64_t generation;
+    std::uint64_t expectedChecksum;
+    LifeRule rule;
+};
+
+// Фоновая запись снимков: request() только копирует поле в свой буфер, диск трогает
+// отдельный поток. Если предыдущий снимок еще ждет записи, новый пропускается, так что
+// вызывающий никогда не ждет диск.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter(); // дописывает уже принятый снимок
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    bool request(const BitGrid& grid, const LifeRule& rule, std::uint64_t generation);
+    void flush(); // ждет, пока принятые снимки окажутся на диске
+
+    std::size_t getWrittenCount() const { return written.load(); }
+    std::size_t getSkippedCount() const { return skipped.load(); }
+    std::size_t getFailedCount() const { return failed.load(); }
+
+private:
+    void loop();
+
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable done;
+    BitGrid pending; // принятый снимок, ждущий записи
+    LifeRule pendingRule;
+    std::uint64_t pendingGeneration;
+    bool hasPending;
+    bool writing;
+    bool stopping;
+    BitGrid current; // снимок, который пишется сейчас
+
+    std::atomic<std::size_t> written;
+    std::atomic<std::size_t> skipped;
+    std::atomic<std::size_t> failed;
+    std::thread worker; // последним: запускается, когда остальное уже готово
+};
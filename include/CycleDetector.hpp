@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Обнаружение конца игры по хэшам поколений: вымирание, устойчивая фигура или цикл с
+// периодом до HISTORY поколений. Хэши последних поколений лежат в небольшой таблице
+// с открытой адресацией фиксированного размера, так что запись поколения стоит O(1)
+// и не выделяет память. Старые записи не удаляются, а затираются новыми; reset() только
+// начинает новую эпоху. Поколения могут записываться с пропусками (GameOfLifeCore::step()
+// видит только концы проходов): тогда найденный период кратен настоящему.
+class CycleDetector {
+public:
+    static const int HISTORY = 1024; // самый длинный замечаемый период
+
+    enum class State {
+        Running,    // повторов пока нет
+        Extinct,    // живых клеток не осталось
+        StillLife,  // поле не изменилось за поколение
+        Oscillating // поле повторилось через getPeriod() поколений
+    };
+
+    CycleDetector();
+
+    void reset(); // история стирается (поле изменено не шагом)
+    void record(std::uint64_t hash, std::size_t population, int generation);
+    // настоящий период уже найденного повтора, если поколения записывались с пропусками
+    void setPeriod(int exactPeriod);
+
+    State getState() const { return state; }
+    int getPeriod() const { return period; } // 1 для устойчивой фигуры и пустого поля, 0 пока идет
+    int getDetectedAt() const { return detectedAt; } // поколение, на котором замечен повтор
+    bool isFinished() const { return state != State::Running; }
+
+private:
+    static const int TABLE_SIZE = HISTORY * 4;
+    static const int MAX_PROBES = 16;
+
+    struct Entry {
+        std::uint64_t hash;
+        std::uint64_t population;
+        int generation;
+        unsigned epoch; // записи прошлых эпох устарели
+    };
+
+    std::vector<Entry> table;
+    unsigned epoch = 0; // число вызовов reset()
+    State state;
+    int period;
+    int detectedAt;
+};
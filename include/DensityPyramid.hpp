@@ -0,0 +1,46 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include <cstdint>
+#include <vector>
+
+// Пирамида плотности для отрисовки сильно уменьшенного поля: уровень level делит поле
+// на блоки 2^level x 2^level клеток и хранит число живых клеток в каждом блоке.
+// Уровни от BASE_LEVEL и выше хранятся и обновляются по изменившимся плиткам
+// ActivityTracker, мелкие блоки считаются прямо по упакованным словам (это не больше
+// нескольких popcount на блок). Так кадр при любом масштабе стоит порядка числа
+// пикселей экрана, а не числа клеток поля.
+class DensityPyramid {
+public:
+    static const int BASE_LEVEL = 4; // блоки 16x16: четверть плитки ActivityTracker
+
+    DensityPyramid();
+
+    void rebuild(const BitGrid& grid);
+    // пересчитывает блоки плиток tiles (номера как в ActivityTracker) и их предков
+    void updateTiles(const BitGrid& grid, const std::vector<int>& tiles);
+
+    int getWidth() const;
+    int getHeight() const;
+    int getLevelCount() const; // уровни 0..getLevelCount()-1; на последнем один блок
+
+    // число живых клеток в блоке (blockRow, blockCol) уровня level; вне поля — 0
+    std::uint32_t count(const BitGrid& grid, int level, int blockRow, int blockCol) const;
+
+private:
+    struct Level {
+        int blocksX = 0;
+        int blocksY = 0;
+        std::vector<std::uint32_t> counts;
+    };
+
+    void computeBase(const BitGrid& grid, int blockRow, int blockCol);
+    void computeParent(int level, int blockRow, int blockCol);
+
+    int width;
+    int height;
+    std::vector<Level> levels;      // levels[i] — уровень BASE_LEVEL + i
+    std::vector<int> dirty;         // блоки, пересчитанные на текущем уровне
+    std::vector<int> dirtyParents;
+    std::vector<std::uint8_t> marked; // блок следующего уровня уже в dirtyParents
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include "GameOfLifeCore.hpp"
+#include "LifeRule.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Счет одного поля несколькими процессами. Тор делится на tilesX x tilesY прямоугольников,
+// каждый считает свой процесс на локальном поле, расширенном ореолом из клеток соседей.
+// За поколение неверная полоса у края локального поля растет на радиус правила, так что
+// ореол ширины radius * steps позволяет сделать steps поколений между обменами. Обмен идет
+// в две фазы: сначала столбцы с левым и правым соседом, затем строки (уже с новыми
+// столбцами ореола) с верхним и нижним, так что углы доходят без диагональных соседей.
+// Соседи замкнуты по тору, поэтому результат побитово совпадает со счетом одним процессом.
+namespace Distributed {
+
+enum Side { Left, Right, Up, Down, SIDES };
+
+// Канал обмена ореолами рабочего процесса: по соседу с каждой стороны (на маленьком торе
+// соседом может быть сам процесс). Реализация выбирает способ доставки: сокеты, общая
+// память, сеть — TileWorker от него не зависит.
+class HaloTransport {
+public:
+    struct Message {
+        Side side;
+        const std::vector<std::uint64_t>* send; // соседу со стороны side
+        std::vector<std::uint64_t>* receive;    // от него же; размер задан заранее
+    };
+
+    virtual ~HaloTransport() = default;
+    // отправляет и принимает все сообщения одновременно, так что обмен по кольцу не встает
+    virtual bool exchange(Message* messages, int count, std::string& error) = 0;
+};
+
+// соседи — концы пар Unix-сокетов (socketpair) на одном компьютере
+class SocketTransport : public HaloTransport {
+public:
+    explicit SocketTransport(const int (&fds)[SIDES]); // забирает дескрипторы
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    bool exchange(Message* messages, int count, std::string& error) override;
+
+private:
+    int fds[SIDES];
+};
+
+// разбиение поля width x height на tilesX x tilesY прямоугольников почти равного размера
+struct Partition {
+    int width = 0;
+    int height = 0;
+    int tilesX = 1;
+    int tilesY = 1;
+
+    int colBegin(int tileX) const { return static_cast<int>(static_cast<std::int64_t>(width) * tileX / tilesX); }
+    int rowBegin(int tileY) const { return static_cast<int>(static_cast<std::int64_t>(height) * tileY / tilesY); }
+    int tileWidth(int tileX) const { return colBegin(tileX + 1) - colBegin(tileX); }
+    int tileHeight(int tileY) const { return rowBegin(tileY + 1) - rowBegin(tileY); }
+};
+
+// Прямоугольник (tileX, tileY) разбиения: локальное ядро размером с прямоугольник плюс
+// ореол halo клеток с каждой стороны.
+class TileWorker {
+public:
+    TileWorker(const Partition& partition, int tileX, int tileY, const LifeRule& rule, int stepsPerExchange);
+
+    int getHalo() const { return halo; }
+
+    // забирает прямоугольник с ореолом, вырезанный cut()
+    void load(BitGrid&& local);
+    // generations поколений с обменом ореолами через каждые stepsPerExchange
+    bool advance(int generations, HaloTransport& transport, std::string& error);
+    // клетки прямоугольника без ореола
+    BitGrid getInterior() const;
+
+private:
+    bool exchange(HaloTransport& transport, std::string& error);
+
+    Partition partition;
+    int tileX;
+    int tileY;
+    int width;  // прямоугольника без ореола
+    int height;
+    int steps;
+    int halo;
+    GameOfLifeCore core;
+    // буферы обмена: полосы ореола и их упаковка в слова
+    BitGrid strips[SIDES];
+    std::vector<std::uint64_t> sendWords[SIDES];
+    std::vector<std::uint64_t> receiveWords[SIDES];
+};
+
+// прямоугольник (tileX, tileY) с ореолом halo из всего поля (с заворотом по тору)
+BitGrid cut(const BitGrid& field, const Partition& partition, int tileX, int tileY, int halo);
+
+struct Options {
+    int tilesX = 2;
+    int tilesY = 2;
+    int stepsPerExchange = 1; // поколений между обменами; ореол растет пропорционально
+};
+
+// Проверяет, что разбиение годится для правила: прямоугольник не уже ореола, Generations не
+// поддерживаются (возраст умирающих клеток не передается).
+bool validate(const Partition& partition, const LifeRule& rule, int stepsPerExchange, std::string& error);
+
+// Считает generations поколений game в tilesX * tilesY процессах (fork), соединенных
+// SocketTransport, и собирает результат обратно в game. Поле целиком есть только у
+// родителя: рабочий получает по своей связи лишь прямоугольник с ореолом, а результат
+// приходит по прямоугольникам прямо в game (setRegion), так что сверх поля родитель держит
+// один прямоугольник. Сборка начинается, когда все рабочие досчитали; если рабочий умрет
+// уже во время сборки, game останется собранным частично, а поколение — прежним.
+bool run(GameOfLifeCore& game, int generations, const Options& options, std::string& error);
+
+} // namespace Distributed
@@ -1,28 +1,176 @@
 #pragma once
 
+#include "ActivityTracker.hpp"
+#include "BitGrid.hpp"
+#include "CycleDetector.hpp"
+#include "GenerationHistory.hpp"
+#include "LifeKernels.hpp"
+#include "LifeRule.hpp"
+#include "Random.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 class GameOfLifeCore {
+public:
+    // реализация шага поколения
+    enum class Kernel {
+        Reference, // поклеточно через countNeighbors()
+        Swar,      // 64 клетки за раз обычными 64-битными операциями
+        Avx2,      // 256 клеток за инструкцию
+        Avx512,    // 512 клеток за инструкцию
+        Lut        // блок 2x2 одной выборкой из таблицы по окрестности 4x4, без SIMD
+    };
+
 private:
-    std::vector<std::vector<bool>> grid; // двумерный массив, который делает игровое поле
+    int width;
+    int height;
+    BitGrid grid;     // упакованное игровое поле, 1 бит на клетку
+    BitGrid nextGrid; // заранее выделенный буфер для следующего поколения
     int generation;
+    Kernel kernel;
+    LifeKernels::RowStep rowStep; // построчное ядро для kernel (кроме Reference) и правила радиуса 1
+    std::unique_ptr<ThreadPool> pool; // нет, если поле считается в одном потоке
+    ActivityTracker activity;         // плитки, изменившиеся за последнее поколение
+    bool trackActivity;
+    LifeRule rule;
+    bool conwayRule;                  // B3/S23: формула зашита в ядра, таблица не нужна
+    LifeKernels::RuleMasks ruleMasks; // rule для побитового ядра (радиус 1)
+    const LifeKernels::LutTable* lut = nullptr;     // таблица rule для ядра Lut
+    std::unique_ptr<LifeKernels::LutTable> ruleLut; // она же для правил, кроме B3/S23
+    BitGrid dying;                    // Generations: клетки в состояниях 2..states-1
+    std::vector<std::uint8_t> ages;   // состояние умирающей клетки, по байту на клетку
+    std::vector<int> columnSums;      // Larger than Life: суммы столбцов в окне строк
+    std::vector<BitGrid> blockBuffers; // step(): пара буферов полосы с ореолом на поток
+
+    // изменение хэша и числа живых клеток за шаг куска поля
+    struct HashDelta {
+        std::uint64_t hash = 0;
+        std::int64_t population = 0;
+        std::int64_t changedCells = 0; // клеток, сменивших состояние
+    };
+    std::uint64_t gridHash;            // XOR хэшей слов поля (и возрастов умирающих клеток)
+    std::size_t population;            // живых клеток
+    std::size_t changedCells;          // за последний шаг
+    std::vector<HashDelta> partDeltas; // по строке плиток или полосе на поток, чтобы не делить запись
+    std::vector<HashDelta> blockDeltas; // step(): по полосе
+    CycleDetector cycles;
+    Random seeds; // зерна для randomizeGrid() без аргументов, по порядку
+    std::unique_ptr<GenerationHistory> history; // нет, пока история выключена
+
+    class HistorySink; // перемотка поля историей с обновлением хэша и плиток
+
+    void stepRows(int rowBegin, int rowEnd, int wordBegin, int wordEnd);
+    void stepBand(int tileY);
+    void stepLargerThanLife();
+    void updateRowStep(); // построчное ядро под текущие kernel и правило
+    void updateLut(); // таблица под текущие ядро и правило
+    void stepBlock(BitGrid& from, BitGrid& to, int rowBegin, int rowEnd, int depth);
+    HashDelta stepBlocks(int blockRows, int depth);
+    void refinePeriod(int blockRows, int depth); // точный период повтора, замеченного step()
+    void addRowToColumns(int row, int delta);
+    std::uint64_t advanceDying(int rowBegin, int rowEnd, int wordBegin, int wordEnd);
+    HashDelta diffRows(int rowBegin, int rowEnd, int wordBegin, int wordEnd) const;
+    void addRowHash(int row, HashDelta& part) const;
+    void rehash(); // полный пересчет хэша после замены поля; история повторов стирается
+    void sumBandHashes();
+    void beginEdit(); // правка поля открывает группу в истории
+    void seekHistory(int entry);
 
 public:
     static const int FIELD_WIDTH = 90;
     static const int FIELD_HEIGHT = 50;
     static const int CELL_SIZE = 15;
     static const int RANDOM_FILL_PERCENTAGE = 40;
+    static const std::uint64_t DEFAULT_SEED = 1;
+    static const int TEMPORAL_DEPTH = 8;                // поколений step() за проход по полю
+    static const int TEMPORAL_BLOCK_BYTES = 256 * 1024; // буферы полосы одного потока, под L2
 
     GameOfLifeCore(); //инициализирует пустое игровое поле
-    void randomizeGrid(); 
-    void reset();        
+    // поле заданного размера, заполненное randomizeGrid() из последовательности зерен seed
+    GameOfLifeCore(int width, int height, std::uint64_t seed = DEFAULT_SEED);
+    // Случайное поле с плотностью fillPercent. Строка r заполняется генератором Random(seed, r)
+    // целыми словами, полосы строк — параллельно, так что поле зависит только от seed и размеров.
+    void randomizeGrid(std::uint64_t seed, int fillPercent = RANDOM_FILL_PERCENTAGE);
+    void randomizeGrid(); // следующее зерно последовательности: каждый вызов дает новое поле
+    void setSeed(std::uint64_t seed); // перезапускает последовательность зерен randomizeGrid()
+    void reset();
+
+    void update();
+    // generations поколений с временными блоками: поле делится на полосы строк, и каждая
+    // полоса вместе с ореолом в depth строк проходит depth поколений в буферах размером с кэш,
+    // так что поле читается из памяти и пишется в нее раз в depth поколений, а не каждое.
+    // Ореол считается лишний раз, поэтому выигрыш есть на полях больше кэша; учет плиток
+    // не используется. Для правил с радиусом больше 1, Generations и ядра Reference — это
+    // просто generations вызовов update(); ядро Lut в блоках заменяется Swar. Детектор
+    // повторов получает поле после каждого прохода, getChangedCells() — сумма по проходам.
+    void step(int generations, int depth = TEMPORAL_DEPTH);
 
-    void update();         
+    static bool isKernelSupported(Kernel kernel);
+    static Kernel bestKernel(); // самое быстрое ядро, доступное на этом процессоре
+    bool setKernel(Kernel kernel); // false, если ядро не поддерживается
+    Kernel getKernel() const;
 
-    const std::vector<std::vector<bool>>& getGrid() const; //возвращаетссылку на текущее игровое поле
+    // число потоков для update(): поле делится на столько же горизонтальных полос;
+    // меньше одного потока не бывает
+    void setThreadCount(int threads);
+    int getThreadCount() const;
+
+    // пересчитывать только изменившиеся плитки и их соседей (включено по умолчанию)
+    void setActivityTracking(bool enabled);
+    bool getActivityTracking() const;
+    const ActivityTracker& getActivity() const; // плитки, изменившиеся за последний шаг
+
+    // правило автомата (по умолчанию B3/S23); false, если окрестность не помещается на поле.
+    // Учет плиток работает только для жизнеподобных правил, для остальных поле считается целиком.
+    bool setRule(const LifeRule& newRule);
+    bool setRule(const std::string& rulestring); // false и для неразобранной строки
+    const LifeRule& getRule() const;
+
+    const BitGrid& getGrid() const; //возвращаетссылку на текущее игровое поле
+    bool setGrid(const BitGrid& newGrid); //заменяет поле целиком, размеры должны совпадать
+    // забирает поле любого размера без копирования; остальные буферы подстраиваются под него
+    void loadGrid(BitGrid&& newGrid);
     int getGeneration() const;
+    void setGeneration(int newGeneration);
+    int getWidth() const;
+    int getHeight() const;
 
-    int countNeighbors(int x, int y); //считаем кол-во живых соседей
+    int countNeighbors(int x, int y) const; //считаем кол-во живых соседей
+
+    // 64-битный хэш поля: шаг обновляет его только по изменившимся словам, так что
+    // равные поля одного размера имеют равный хэш независимо от истории
+    std::uint64_t getHash() const;
+    std::size_t getPopulation() const; // живых клеток, без пересчета
+    std::size_t getChangedCells() const; // живых клеток родилось и умерло за последний шаг
+    // вымирание, устойчивая фигура или цикл с периодом до CycleDetector::HISTORY поколений,
+    // замеченные с последней замены поля
+    const CycleDetector& getCycles() const;
+    bool isFinished() const; // дальше поле только повторяется
 
     void setCell(int row, int col, bool alive); //установка конкретного состояния клетки
+    // Копирует клетки region в прямоугольник с левым верхним углом (row, col) целыми словами:
+    // хэш и плитки обновляются по изменившимся словам, история повторов стирается один раз.
+    // Умирающие клетки (Generations) в прямоугольнике становятся мертвыми. false, если
+    // прямоугольник не помещается на поле.
+    bool setRegion(int row, int col, const BitGrid& region);
+    int getCellState(int row, int col) const;   // 0 — мертвая, 1 — живая, 2.. — умирающая (Generations)
+
+    // История поколений и правок (GenerationHistory) с бюджетом памяти bytes, 0 — выключить.
+    // По умолчанию выключена. Поколение записывается по плиткам, изменившимся за шаг; без
+    // учета плиток (правила не жизнеподобные или учет выключен) сравнивается все поле.
+    // Включение начинает историю с текущего поля. Правки между поколениями (setCell,
+    // setRegion, setGrid, новое случайное поле) собираются в одну запись до следующего шага
+    // или commitEdit().
+    // Хранятся только живые клетки: у Generations после перемотки умирающих клеток нет.
+    void setHistoryBudget(std::size_t bytes);
+    const GenerationHistory* getHistory() const; // nullptr, если история выключена
+    void commitEdit(); // следующая правка отменяется отдельно от уже сделанных
+    // на запись назад: поколение или группу правок; false, если назад истории нет
+    bool undo();
+    bool redo(); // отмененная запись обратно; false, если после undo() поле менялось
+    // к записанному поколению, ближайшему к generation; false, если история выключена
+    bool seekGeneration(int generation);
 };
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "DensityPyramid.hpp"
 #include "GameOfLifeCore.hpp"
+#include "Profiler.hpp"
+#include "SimulationThread.hpp"
 #include <SFML/Graphics.hpp>
+#include <vector>
 
 class GameOfLifeRenderer {
 public:
@@ -18,18 +22,30 @@ private:
     void renderControl();
     void renderMainMenuButtons();
     void renderInfoPanel();
-    void renderCellHighlight(int offsetX, int offsetY);
+    void renderProfilerOverlay(const sf::FloatRect& panel);
+    void draw(const sf::Drawable& drawable); // window.draw() со счетом вызовов за кадр
+    void updateStats();
+    void renderCellHighlight();
+    void renderField();
+    bool renderFieldTexture();
+    void renderFieldOverview();
+    bool createFieldTextures(int width, int height, int tilesX, int tilesY);
+    void uploadTiles(const BitGrid& grid, int tileY, int tileBegin, int tileEnd);
+    void updatePyramid();
+    void resetCamera();
+    void zoomCamera(double factor, sf::Vector2i anchor);
+    void panCamera(double dx, double dy);
+    bool screenToCell(sf::Vector2i pos, int& row, int& col) const;
     void handleMouseDrawing();
     void handleMouseRelease(sf::Mouse::Button button);
     void handleKeyPress(sf::Keyboard::Key key);
     void handleMousePress(const sf::Event& event);
     void handleMenuClick(const sf::Vector2i& mousePos);
     void handleGameFieldClick(const sf::Vector2i& mousePos, sf::Mouse::Button button);
+    void editCell(int row, int col, bool alive);
     bool isInside(sf::Vector2i pos, float x, float y, float w, float h);
 
-    static constexpr int CELL_SIZE = 15;
-    static constexpr int FIELD_WIDTH = 90;
-    static constexpr int FIELD_HEIGHT = 50;
+    static constexpr int CELL_SIZE = 15; // масштаб камеры по умолчанию, пикселей на клетку
     
     struct UIConstants {
 
@@ -39,20 +55,30 @@ private:
         static constexpr float BUTTON_X_OFFSET = 150;
         static constexpr float BUTTON_Y_OFFSET = 150;
         
-        static constexpr int DEFAULT_DELAY = 200;
-        static constexpr int MIN_DELAY = 50;
-        static constexpr int DELAY_STEP = 50;
+        static constexpr double MIN_RATE = 0.5;      // поколений в секунду
+        static constexpr double MAX_RATE = 1000000.0;
+        static constexpr double RATE_FACTOR = 2.0;   // W/S умножают и делят скорость
+        static constexpr float STATS_INTERVAL = 0.5f; // секунды между пересчетами gen/s
+        static constexpr float FRAME_TIME_SMOOTHING = 0.1f;
         
         static constexpr float HIGHLIGHT_ALPHA_ADD = 80;
         static constexpr float HIGHLIGHT_ALPHA_REMOVE = 80;
         static constexpr float FIELD_OFFSET_Y_RATIO = 1.5f;
         static constexpr float FIELD_BORDER_THICKNESS = 3.0f;
+
+        static constexpr double MIN_ZOOM = 1.0 / 4096; // пикселей на клетку
+        static constexpr double MAX_ZOOM = 64.0;
+        static constexpr double ZOOM_FACTOR = 1.25;    // за одно деление колеса мыши
+        static constexpr double PAN_FRACTION = 0.1;    // доля окна за нажатие стрелки
+        static constexpr int SCRUB_GENERATIONS = 50;   // PageUp/PageDown по истории
+        static constexpr double GRID_LINES_MIN_ZOOM = 8.0; // мельче сетка только мешает
         
         static constexpr int MAIN_FONT_SIZE = 20;
         static constexpr int RULES_FONT_SIZE = 28;
         static constexpr int HINT_FONT_SIZE = 24;
         static constexpr int CONTROL_FONT_SIZE = 32;
         static constexpr float LINE_SPACING = 1.5f;
+        static constexpr unsigned FRAME_RATE_LIMIT = 60; // кадры не зависят от скорости поколений
 
         static constexpr float INFO_TEXT_X = 10.0f;
         static constexpr float INFO_TEXT_Y_OFFSET = 40.0f;
@@ -61,16 +87,23 @@ private:
         static constexpr float HINT_TEXT_Y_OFFSET = 60.0f;
         static constexpr float CONTROL_TEXT_X = 50.0f;
         static constexpr float CONTROL_TEXT_Y_RATIO = 4.0f;
+
+        static constexpr int PROFILER_FONT_SIZE = 16;
+        static constexpr float PROFILER_MARGIN = 8.0f;
+        static constexpr sf::Uint8 PROFILER_BACKGROUND_ALPHA = 170;
+        static constexpr const char* TRACE_FILE = "gameoflife-trace.json"; // в текущем каталоге
     };
 
     // Состояние приложения
     struct AppState {
-        int delay = UIConstants::DEFAULT_DELAY;
+        double targetRate = Scheduler::DEFAULT_RATE;
+        Scheduler::Mode schedulerMode = Scheduler::Mode::FixedRate;
         bool isPaused = false;
         bool showMainMenu = true;
         bool showRules = false;
         bool showControl = false;
         bool drawMode = true;
+        bool historyEnabled = false; // запись истории для Z/Y и перемотки, включается H
         bool isMouseLeftPressed = false;
         bool isMouseRightPressed = false;
         int lastRow = -1;
@@ -79,6 +112,18 @@ private:
         int WINDOW_HEIGHT = 0;
     };
 
+    // измеренные скорость поколений и время кадра для панели информации
+    struct Stats {
+        sf::Clock frameClock;
+        float frameTimeMs = 0;
+        sf::Clock rateClock;
+        int rateGeneration = 0;
+        float generationsPerSecond = 0;
+        Profiler::Summary profileBase; // сводка на начало интервала: оверлей показывает разницу
+        std::string profileText;
+        std::string traceStatus;       // результат последней записи трассы
+    };
+
     struct Resources {
         sf::Font font;
         sf::Texture menuBackgroundTexture;
@@ -93,8 +138,66 @@ private:
         sf::Sprite exitButtonSprite;
     };
 
+    // Камера: координаты поля (в клетках) левого верхнего угла окна и масштаб
+    struct Camera {
+        double left = 0;
+        double top = 0;
+        double zoom = CELL_SIZE; // пикселей на клетку
+    };
+
+    // Поле рисуется одним спрайтом: клетка — тексель текстуры, растянутый до CELL_SIZE,
+    // а промежутки между клетками — повторяющаяся текстура сетки поверх него. Кадр стоит
+    // постоянное число вызовов draw() при любом размере поля. Текстура покрывает не все
+    // поле, а окно из tilesX x tilesY плиток вокруг видимой части — размером с экран плюс
+    // плитка с каждой стороны, так что ее память не зависит от размера поля. Текстура живет
+    // между кадрами, в нее заново загружаются только видимые плитки, изменившиеся с прошлого
+    // нарисованного снимка; когда камера уходит за окно, оно сдвигается и загружается целиком.
+    struct FieldView {
+        int width = 0;                         // поля, для которого создана текстура
+        int height = 0;
+        int tilesX = 0;                        // окно текстуры в плитках
+        int tilesY = 0;
+        int originTileX = 0;                   // левая верхняя плитка окна
+        int originTileY = 0;
+        bool failed = false;                   // текстуру такого размера создать не удалось
+        bool uploadAll = true;                 // текстура только что создана или окно сдвинулось
+        std::uint32_t drawnVersion = 0;        // Snapshot::version того, что сейчас в текстуре
+        std::vector<std::uint32_t> drawnTiles; // Snapshot::tileVersions того же снимка
+        std::vector<sf::Uint32> pixels;        // RGBA одной строки плиток перед загрузкой
+        sf::Texture cellsTexture;
+        sf::Sprite cellsSprite;
+        sf::Texture gridLinesTexture;
+        sf::Sprite gridLinesSprite;
+    };
+
+    // Уменьшенное поле (меньше пикселя на клетку) или окно, для которого не создалась текстура:
+    // окно рисует текстуру размером с экран, где тексель — блок 2^level клеток,
+    // а его яркость — доля живых клеток блока из DensityPyramid.
+    struct OverviewView {
+        DensityPyramid pyramid;
+        std::uint32_t pyramidVersion = 0;
+        std::vector<std::uint32_t> pyramidTiles; // Snapshot::tileVersions, учтенные в пирамиде
+        std::vector<int> dirtyTiles;
+        std::vector<sf::Uint32> pixels;
+        sf::Texture texture;
+        sf::Sprite sprite;
+        bool valid = false; // pixels соответствуют полям ниже
+        std::uint32_t version = 0;
+        int level = 0;
+        int firstRow = 0;
+        int firstCol = 0;
+        int rows = 0;
+        int cols = 0;
+    };
+
     sf::RenderWindow window;
-    GameOfLifeCore& game;
+    GameOfLifeCore& game; // пока идет run(), поле меняет только simulation
+    SimulationThread simulation;
     AppState state;
+    Stats stats;
     Resources resources;
+    Camera camera;
+    FieldView field;
+    OverviewView overview;
+    int drawCalls = 0; // вызовов draw() в текущем кадре
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "ActivityTracker.hpp"
+#include "BitGrid.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// История состояний поля для отмены правок и перемотки поколений. Запись — поле после
+// поколения или после группы правок, хранится как XOR с предыдущей записью, сжатый по
+// группам из 64 слов: пустые группы пропускаются, у остальных хранятся маска и ненулевые
+// слова. Поколение сжимается только по плиткам, изменившимся за шаг (ActivityTracker), так
+// что запись стоит порядка самого изменения, а не прохода по полю. XOR симметричен, так что шаг назад и шаг
+// вперед — одно и то же наложение изменения на текущее поле. Когда изменения с последнего
+// ключевого кадра набирают KEYFRAME_SPAN размеров поля, запись хранит еще и само поле
+// (сжатое так же) с его хэшем, и дальняя перемотка начинается с ближайшего кадра. Самые
+// старые записи вытесняются, как только история превышает бюджет памяти.
+class GenerationHistory {
+public:
+    // поле, которое перематывается: ядро обновляет хэш и плитки по изменившимся словам
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+        // index — номер слова в поле без выравнивания строк: строка * getWordsPerRow() + слово
+        virtual void xorWord(std::size_t index, std::uint64_t bits) = 0;
+        // поле целиком из ключевого кадра вместе с его хэшем и числом живых клеток
+        virtual void load(const BitGrid& state, std::uint64_t hash, std::size_t population) = 0;
+    };
+
+    static const std::size_t DEFAULT_BUDGET = std::size_t(64) << 20;
+    static const int KEYFRAME_SPAN = 1; // размеров поля в изменениях между ключевыми кадрами
+
+    explicit GenerationHistory(std::size_t budgetBytes = DEFAULT_BUDGET);
+
+    // лишние старые записи вытесняются сразу; буферы размером с поле в бюджет не входят
+    void setBudget(std::size_t budgetBytes);
+    std::size_t getBudget() const { return budget; }
+    std::size_t getBytes() const { return bytes; }
+
+    void clear(const BitGrid& grid, int generation); // единственная запись — текущее поле
+
+    // Новое поколение after, before — поле текущей записи. Отличаться они могут только в
+    // плитках changed->getChangedTiles(); без changed сравнивается все поле. hash и
+    // population хранятся с ключевым кадром. Отмененные записи после текущей стираются,
+    // как в любом редакторе.
+    void push(const BitGrid& before, const BitGrid& after, const ActivityTracker* changed, int generation,
+              std::uint64_t hash, std::size_t population);
+    // Открывает группу изменений (штрих мышью, новое случайное поле, несколько поколений
+    // за раз), если она еще не открыта: запоминает поле до нее.
+    void begin(const BitGrid& grid);
+    // закрывает группу записью от запомненного поля до grid; если поле не изменилось, записи нет
+    void commit(const BitGrid& grid, int generation, std::uint64_t hash, std::size_t population);
+    bool isOpen() const { return open; }
+
+    int size() const { return static_cast<int>(entries.size()); }
+    int getPosition() const { return position; } // текущая запись, 0 — самая старая
+    int getGeneration(int entry) const { return entries[entry].generation; }
+    // запись с поколением, ближайшим к generation; из равных — ближайшая к текущей
+    int find(int generation) const;
+
+    // Приводит поле sink от текущей записи к записи entry более дешевым путем: цепочкой
+    // изменений от текущей записи или от ключевого кадра. Группа не должна быть открыта.
+    void seek(int entry, Sink& sink);
+
+private:
+    struct Entry {
+        int generation = 0;
+        std::vector<std::uint8_t> delta;    // XOR с предыдущей записью; у самой старой пуст
+        bool hasKeyframe = false;
+        std::vector<std::uint8_t> keyframe; // поле целиком
+        std::uint64_t hash = 0;             // поля кадра, чтобы загрузка не пересчитывала хэш
+        std::size_t population = 0;
+    };
+
+    void append(const BitGrid& before, const BitGrid& after, const ActivityTracker* changed, int generation,
+                std::uint64_t hash, std::size_t population);
+    void evict();
+    static std::size_t entryBytes(const Entry& entry);
+
+    std::deque<Entry> entries;
+    int position = 0;
+    std::size_t budget;
+    std::size_t bytes = 0;
+    std::size_t sinceKeyframe = 0;     // байтов изменений в записях после последнего кадра
+    std::vector<std::uint8_t> encoded; // буфер сжатия, память переиспользуется
+    std::vector<int> tiles;            // изменившиеся плитки по порядку
+    BitGrid base;                      // поле до открытой группы
+    bool open = false;
+    BitGrid scratch;                   // распакованный ключевой кадр
+    int width = 0;                     // поля, для которого ведется история
+    int height = 0;
+};
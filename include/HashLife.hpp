@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include "LifeRule.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+class GameOfLifeCore;
+
+// HashLife: поле хранится как квадродерево, одинаковые поддеревья — это один и тот же
+// узел (hash consing), а результат эволюции каждого узла запоминается в нем самом.
+// Поэтому шаг на 2^k поколений стоит столько же, сколько число различных узлов, а не клеток.
+//
+// Тор GameOfLifeCore раскладывается на бесконечную плоскость периодически: за 2^k поколений
+// до клеток тора доходит информация только с расстояния 2^k, а периодическая раскладка
+// дает ровно то же, что и замыкание краев, так что результат совпадает с update().
+class HashLife {
+public:
+    static const std::size_t DEFAULT_MAX_NODES = std::size_t(1) << 21;
+
+    explicit HashLife(std::size_t maxNodes = DEFAULT_MAX_NODES);
+
+    // берет текущее поле, номер поколения и правило; false, если правило не поддерживается
+    bool load(const GameOfLifeCore& game);
+    void stepPow2(int k); // продвигает поле на 2^k поколений, 0 <= k <= MAX_STEP
+    // Записывает поле и номер поколения обратно; false, если номер не помещается в int
+    // поколения GameOfLifeCore, тогда game не меняется.
+    bool store(GameOfLifeCore& game) const;
+    // load + stepPow2 + store; false (game не меняется), если правило не поддерживается или
+    // номер поколения после шага не помещается в int
+    bool advance(GameOfLifeCore& game, int k);
+
+    static const int MAX_STEP = 62;
+
+    // Жизнеподобные правила без B0: у остальных в узле не хватает состояний или
+    // пустота не остается пустой. Смена правила сбрасывает кэш узлов.
+    static bool isRuleSupported(const LifeRule& rule);
+    bool setRule(const LifeRule& newRule);
+    const LifeRule& getRule() const;
+
+    const BitGrid& getGrid() const;
+    std::uint64_t getGeneration() const;
+
+    // Память кэша узлов ограничена: после шага сверх maxNodes запускается сборка мусора.
+    // Внутри шага узлов бывает не больше 2 * maxNodes: если шаг упирается в этот потолок,
+    // кэш очищается и шаг делится на два вдвое короче. Шаг на одно поколение идет без
+    // потолка — ему нужно хотя бы дерево самого поля.
+    void setMaxNodes(std::size_t maxNodes);
+    std::size_t getNodeCount() const;
+    std::size_t getPeakNodeCount() const; // больше всего узлов за все время
+    std::size_t getCollectionCount() const;
+
+private:
+    using NodeId = std::uint32_t;
+    static const NodeId NO_NODE = 0xFFFFFFFFu;
+    static const NodeId DEAD_CELL = 0; // узлы уровня 0 — отдельные клетки
+    static const NodeId LIVE_CELL = 1;
+
+    struct NodeLimitReached {}; // из join() наверх до stepPow2(), узлы и результаты остаются согласованы
+
+    struct Node {
+        NodeId nw, ne, sw, se; // четверти узла
+        NodeId result;         // центр узла через 2^resultStep поколений
+        NodeId next;           // следующий узел в цепочке хэш-таблицы
+        std::int8_t level;     // сторона узла — 2^level клеток
+        std::int8_t resultStep;
+    };
+
+    void clearNodes();
+    NodeId join(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+    NodeId emptyNode(int level);
+    NodeId successor(NodeId id, int step);
+    NodeId leafSuccessor(const Node& node);
+    NodeId buildPeriodic(int level, std::int64_t x0, std::int64_t y0);
+    void extract(NodeId id, int level, std::int64_t x0, std::int64_t y0);
+    void rehash(std::size_t bucketCount);
+    void collectGarbage();
+
+    std::vector<Node> nodes;
+    std::vector<NodeId> buckets;
+    std::vector<NodeId> emptyNodes;                    // пустой узел для каждого уровня
+    std::unordered_map<std::uint64_t, NodeId> tileMemo; // узлы периодической раскладки тора
+    std::array<std::uint8_t, 1 << 16> leafTable;       // 4x4 клетки -> центр 2x2 через поколение
+    LifeRule rule;
+
+    BitGrid tile;
+    std::uint64_t generation;
+    NodeId lastRoot;
+    NodeId lastResult;
+    std::size_t maxNodes;
+    std::size_t nodeLimit = std::numeric_limits<std::size_t>::max(); // потолок внутри шага
+    std::size_t peakNodes = 0;
+    std::size_t collections;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+
+// Побитово-параллельные (SWAR) ядра: следующее поколение считается сразу для 64 клеток
+// одного слова. Восемь соседей каждой клетки складываются сумматорами над целыми словами.
+namespace LifeKernels {
+
+// полный сумматор трех битовых плоскостей
+inline void fullAdd(std::uint64_t a, std::uint64_t b, std::uint64_t c,
+                    std::uint64_t& sum, std::uint64_t& carry) {
+    std::uint64_t ab = a ^ b;
+    sum = ab ^ c;
+    carry = (a & b) | (ab & c);
+}
+
+// соседи слева: бит клетки col-1 попадает на позицию col
+inline std::uint64_t westNeighbors(std::uint64_t word, std::uint64_t prevWord) {
+    return (word << 1) | (prevWord >> 63);
+}
+
+// соседи справа: бит клетки col+1 попадает на позицию col
+inline std::uint64_t eastNeighbors(std::uint64_t word, std::uint64_t nextWord) {
+    return (word >> 1) | (nextWord << 63);
+}
+
+// число соседей 64 клеток в двоичной записи по битовым плоскостям; 8 соседей — это eights
+struct NeighborCounts {
+    std::uint64_t ones;
+    std::uint64_t twos;
+    std::uint64_t fours;
+    std::uint64_t eights;
+};
+
+// складывает восемь соседей по трем строкам (west, center, east для каждой)
+inline NeighborCounts countNeighbors(std::uint64_t aboveW, std::uint64_t above, std::uint64_t aboveE,
+                                     std::uint64_t west, std::uint64_t east,
+                                     std::uint64_t belowW, std::uint64_t below, std::uint64_t belowE) {
+    std::uint64_t aboveSum, aboveCarry, belowSum, belowCarry;
+    fullAdd(aboveW, above, aboveE, aboveSum, aboveCarry);
+    fullAdd(belowW, below, belowE, belowSum, belowCarry);
+    std::uint64_t midSum = west ^ east;
+    std::uint64_t midCarry = west & east;
+
+    NeighborCounts counts;
+    std::uint64_t onesCarry, twosPart, foursA;
+    fullAdd(aboveSum, belowSum, midSum, counts.ones, onesCarry);
+    fullAdd(aboveCarry, belowCarry, midCarry, twosPart, foursA);
+    counts.twos = twosPart ^ onesCarry;
+    std::uint64_t foursB = twosPart & onesCarry;
+    counts.fours = foursA ^ foursB;
+    counts.eights = foursA & foursB; // разряд 4 переполнился: все восемь соседей живы
+    return counts;
+}
+
+// Правило для побитовых ядер задается типом с оператором (counts, center) -> следующее слово,
+// так что для частых правил формула подставляется на этапе компиляции.
+
+// B3/S23: ровно 3 соседа, или 2 соседа у живой клетки; 8 соседей дают 000 и отсекаются fours
+struct ConwayRule {
+    std::uint64_t operator()(const NeighborCounts& counts, std::uint64_t center) const {
+        return counts.twos & ~counts.fours & (counts.ones | center);
+    }
+};
+
+// Любое правило на окрестности Мура: next[живая][число соседей] — слово из одних единиц
+// или одних нулей. Таблица выбирается деревом мультиплексоров по разрядам числа соседей,
+// без ветвлений: около пятидесяти операций на 64 клетки для любого правила.
+struct RuleMasks {
+    std::uint64_t next[2][9];
+
+    std::uint64_t operator()(const NeighborCounts& counts, std::uint64_t center) const {
+        return select(pick(next[0], counts), pick(next[1], counts), center);
+    }
+
+private:
+    // a там, где бит выбора 0, и b там, где 1
+    static std::uint64_t select(std::uint64_t a, std::uint64_t b, std::uint64_t bit) {
+        return a ^ ((a ^ b) & bit);
+    }
+    static std::uint64_t pick(const std::uint64_t* table, const NeighborCounts& counts) {
+        std::uint64_t low = select(select(select(table[0], table[1], counts.ones),
+                                          select(table[2], table[3], counts.ones), counts.twos),
+                                   select(select(table[4], table[5], counts.ones),
+                                          select(table[6], table[7], counts.ones), counts.twos),
+                                   counts.fours);
+        return select(low, table[8], counts.eights);
+    }
+};
+
+// правило B3/S23 для 64 клеток по трем строкам соседей (west, center, east для каждой)
+inline std::uint64_t nextWord(std::uint64_t aboveW, std::uint64_t above, std::uint64_t aboveE,
+                              std::uint64_t west, std::uint64_t center, std::uint64_t east,
+                              std::uint64_t belowW, std::uint64_t below, std::uint64_t belowE) {
+    return ConwayRule()(countNeighbors(aboveW, above, aboveE, west, east, belowW, below, belowE), center);
+}
+
+// Таблица ядра Lut: следующее состояние блока 2x2 клеток по его окрестности 4x4. Индекс —
+// четыре строки окрестности по 4 бита (строка k в битах 4k..4k+3, младший бит — левый
+// столбец), значение — биты блока: 0 и 1 — верхняя строка, 2 и 3 — нижняя.
+const int LUT_SIZE = 1 << 16;
+
+struct LutTable {
+    std::uint8_t next[LUT_SIZE];
+};
+
+// birth и survive — маски чисел соседей (бит n — n соседей), при которых клетка рождается
+// или выживает. constexpr, так что таблица для B3/S23 строится при компиляции.
+constexpr void fillLutTable(LutTable& table, unsigned birth, unsigned survive) {
+    for (int index = 0; index < LUT_SIZE; ++index) {
+        int result = 0;
+        for (int cell = 0; cell < 4; ++cell) {
+            // окно 3x3 клетки начинается в строке top и столбце left окрестности
+            int shift = (cell >> 1) * 4 + (cell & 1);
+            unsigned center = 1u << (shift + 5);
+            unsigned window = (0x777u << shift) & ~center;
+            int count = __builtin_popcount(static_cast<unsigned>(index) & window);
+            bool alive = (static_cast<unsigned>(index) & center) != 0;
+            if (((alive ? survive : birth) >> count) & 1u) {
+                result |= 1 << cell;
+            }
+        }
+        table.next[index] = static_cast<std::uint8_t>(result);
+    }
+}
+
+constexpr LutTable makeLutTable(unsigned birth, unsigned survive) {
+    LutTable table{};
+    fillLutTable(table, birth, survive);
+    return table;
+}
+
+extern const LutTable CONWAY_LUT; // B3/S23, посчитана при компиляции
+
+// Ядро Lut: строки row и below за один проход, 32 выборки из таблицы на слово вместо подсчета
+// соседей. above, row, below, below2 — четыре строки окрестности подряд; при outBelow ==
+// nullptr считается только строка row, а below2 может быть любой строкой поля.
+void stepWordsLut(const LutTable& table, const std::uint64_t* above, const std::uint64_t* row,
+                  const std::uint64_t* below, const std::uint64_t* below2, std::uint64_t* out,
+                  std::uint64_t* outBelow, int width, int wordBegin, int wordEnd);
+
+// Ядро, считающее слова [wordBegin, wordEnd) одной строки по правилу rule; реализация
+// выбирается при смене ядра или правила. Ядра B3/S23 (conwayStep) правило не читают.
+using RowStep = void (*)(const RuleMasks& rule, const std::uint64_t* above, const std::uint64_t* row,
+                         const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd);
+
+// Считает следующее поколение одной строки шириной width клеток.
+// above/row/below — соседние строки (вертикальное замыкание выбирает вызывающий),
+// горизонтальное замыкание тора обрабатывается на крайних словах, без деления по модулю.
+void stepRow(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+             std::uint64_t* out, int width);
+
+// то же для слов [wordBegin, wordEnd) строки; векторные ядра досчитывают им края и хвосты
+void stepWords(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+               std::uint64_t* out, int width, int wordBegin, int wordEnd);
+
+// stepWords для произвольного правила на окрестности Мура
+void stepWordsRule(const RuleMasks& rule,
+                   const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                   std::uint64_t* out, int width, int wordBegin, int wordEnd);
+
+// Векторные варианты stepWords и stepWordsRule: 256 и 512 клеток за инструкцию. Вызывать
+// их можно только если соответствующая функция *Available() вернула true.
+void stepWordsAvx2(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                   std::uint64_t* out, int width, int wordBegin, int wordEnd);
+void stepWordsRuleAvx2(const RuleMasks& rule,
+                       const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                       std::uint64_t* out, int width, int wordBegin, int wordEnd);
+void stepWordsAvx512(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                     std::uint64_t* out, int width, int wordBegin, int wordEnd);
+void stepWordsRuleAvx512(const RuleMasks& rule,
+                         const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                         std::uint64_t* out, int width, int wordBegin, int wordEnd);
+
+// ядро B3/S23 с сигнатурой RowStep: conwayStep<stepWordsAvx2>
+template <void (*Step)(const std::uint64_t*, const std::uint64_t*, const std::uint64_t*, std::uint64_t*, int, int,
+                       int)>
+void conwayStep(const RuleMasks&, const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    Step(above, row, below, out, width, wordBegin, wordEnd);
+}
+
+// ядро собрано с нужным набором инструкций и процессор (по CPUID) его поддерживает
+bool avx2Available();
+bool avx512Available();
+
+} // namespace LifeKernels
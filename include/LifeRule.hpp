@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Правило клеточного автомата, разобранное из стандартной строки правила:
+//  "B3/S23", "b36/s23", "23/3" (S/B) — жизнеподобные правила на окрестности Мура;
+//  "B2/S/C3", "/2/3" (S/B/C)         — Generations: C состояний; клетка, не выжившая
+//                                       по правилу, проходит состояния 2..C-1, не считается
+//                                       соседом и не может родиться заново, пока не умрет;
+//  "R5,C0,M1,S34..58,B34..45,NM"     — Larger than Life: квадрат радиуса R, число соседей
+//                                       в диапазонах S и B (M1 — центр входит в сумму).
+// Правило хранится таблицей next[живая][число соседей без центра], поэтому ядрам не
+// нужно ветвиться по правилу внутри цикла по клеткам.
+class LifeRule {
+public:
+    static const int MAX_RANGE = 32;
+    static const int MAX_STATES = 256;
+
+    LifeRule(); // B3/S23
+
+    // false, если строка не разобрана; rule при этом не меняется
+    static bool parse(const std::string& text, LifeRule& rule);
+    std::string toString() const;
+
+    int getRange() const { return range; }   // радиус окрестности, 1 — окрестность Мура
+    int getStates() const { return states; } // 2 — обычное двухцветное правило
+    int getMaxNeighbors() const { return maxNeighbors; }
+    bool isConway() const;
+    // радиус 1 и два состояния: такие правила считают побитовые ядра, учет плиток и HashLife
+    bool isLifeLike() const { return range == 1 && states == 2; }
+
+    bool next(bool alive, int neighbors) const { return table[alive ? maxNeighbors + 1 + neighbors : neighbors] != 0; }
+    // таблица next: сначала maxNeighbors + 1 значений для мертвой клетки, затем для живой
+    const std::uint8_t* getTable() const { return table.data(); }
+
+    bool operator==(const LifeRule& other) const;
+    bool operator!=(const LifeRule& other) const { return !(*this == other); }
+
+private:
+    void resize(int newRange);
+
+    int range;
+    int states;
+    int maxNeighbors;
+    bool countCenter; // только для записи Larger than Life: M1 в строке правила
+    std::vector<std::uint8_t> table;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+class GameOfLifeCore;
+
+// Чтение и запись образцов в форматах RLE (.rle) и Golly Macrocell (.mc).
+// Чтение идет за один проход через буфер фиксированного размера и пишет клетки прямо
+// в упакованные слова поля, без промежуточного списка клеток: RLE сразу заполняет поле
+// отрезками, Macrocell хранит только узлы квадродерева (одинаковые поддеревья в файле
+// записаны один раз) и раскладывает их в поле в конце. Поэтому память при загрузке —
+// это само поле плюс узлы, и многогигабайтные файлы читаются без лишних копий.
+namespace PatternIO {
+
+enum class Format { Rle, Macrocell };
+
+const int MARGIN = 16; // пустая рамка вокруг загруженного образца, чтобы он не замыкался сам на себя
+
+// Загружает образец в game: правило и поколение берутся из файла (если указаны). Размер
+// поля — из суффикса тора в правиле (":T300,130", как у Golly), иначе поле становится не
+// меньше текущего и не меньше образца с рамкой MARGIN; образец ставится в центр.
+// width/height больше нуля задают размер поля явно. false и текст ошибки в error при неудаче;
+// тогда game не меняется.
+bool load(std::istream& in, GameOfLifeCore& game, std::string& error, int width = 0, int height = 0);
+bool loadFile(const std::string& path, GameOfLifeCore& game, std::string& error, int width = 0, int height = 0);
+
+// Записывает поле целиком (размер суффиксом тора в правиле, правило, поколение), чтобы
+// загрузка без явного размера вернула то же самое.
+bool save(std::ostream& out, const GameOfLifeCore& game, Format format);
+bool saveFile(const std::string& path, const GameOfLifeCore& game, Format format);
+
+// формат по расширению имени файла: .mc — Macrocell, остальное — RLE
+Format formatFromPath(const std::string& path);
+
+} // namespace PatternIO
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Замеры горячих мест: длительности фаз (шаг, кадр, отрисовка...) и счетчики (вызовы draw(),
+// население, изменившиеся клетки) копятся в гистограммы отдельно для каждого потока. Поток
+// пишет только в свои гистограммы обычными атомарными записями без блокировок, читатель
+// (оверлей окна) складывает их в любой момент. Выключенный профилировщик стоит одной
+// проверки флага на замер. Дополнительно последние события каждого потока хранятся в
+// кольцевом буфере и выгружаются в формате Chrome trace (chrome://tracing, Perfetto).
+namespace Profiler {
+
+enum class Metric {
+    Step,         // GameOfLifeCore::update(), нс
+    Publish,      // копирование поколения в снимок для окна, нс
+    Frame,        // кадр окна целиком, нс
+    Render,       // отрисовка поля и панелей, нс
+    Upload,       // загрузка изменившихся плиток в текстуру, нс
+    DrawCalls,    // вызовов draw() за кадр
+    Population,   // живых клеток после шага
+    CellsChanged, // клеток, изменившихся за шаг
+    Count
+};
+
+const char* metricName(Metric metric);
+bool isDuration(Metric metric); // значения — наносекунды
+
+// Гистограмма с логарифмическими корзинами: до 16 — по корзине на значение, дальше по
+// 8 корзин на каждую степень двойки, так что процентиль верен с точностью до 1/8.
+struct Histogram {
+    static const int LINEAR = 16;
+    static const int SUB_BUCKETS = 8;
+    static const int BUCKETS = LINEAR + (64 - 4) * SUB_BUCKETS;
+
+    std::uint64_t counts[BUCKETS] = {};
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+
+    static int bucketOf(std::uint64_t value);
+    static std::uint64_t bucketValue(int bucket); // середина корзины
+
+    std::uint64_t percentile(double fraction) const; // 0 для пустой гистограммы
+    double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+    void subtract(const Histogram& earlier); // оставляет только замеры после earlier
+};
+
+// сложенные по всем потокам гистограммы с начала работы (или reset())
+struct Summary {
+    Histogram metrics[static_cast<int>(Metric::Count)];
+    std::uint64_t last[static_cast<int>(Metric::Count)] = {}; // последнее значение среди потоков
+
+    const Histogram& operator[](Metric metric) const { return metrics[static_cast<int>(metric)]; }
+    void subtract(const Summary& earlier); // окно между двумя вызовами collect()
+};
+
+extern std::atomic<bool> enabledFlag;
+extern std::atomic<bool> tracingFlag;
+
+inline bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+inline bool isTracing() { return tracingFlag.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+// записывать события для writeTrace(); включает и профилировщик. Новая запись очищает
+// кольцевые буферы, так что в трассу попадают только ее события
+void setTracing(bool tracing);
+
+std::uint64_t now(); // наносекунды монотонных часов от запуска программы
+
+void recordValue(Metric metric, std::uint64_t value, std::uint64_t start);
+inline void record(Metric metric, std::uint64_t value) {
+    if (isEnabled()) {
+        recordValue(metric, value, 0);
+    }
+}
+
+void setThreadName(const char* name); // имя потока в трассе
+
+Summary collect();
+void reset(); // обнуляет гистограммы и трассу; не вызывать, пока другие потоки пишут
+
+// Записывает события из кольцевых буферов (последние TRACE_EVENTS на поток) в JSON
+// Chrome trace. На время записи трасса приостанавливается.
+bool writeTrace(const std::string& path, std::string& error);
+
+const int TRACE_EVENTS = 1 << 14;
+
+// замер длительности области видимости
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Metric metric) : metric(metric), start(isEnabled() ? now() : 0) {}
+    ~ScopedTimer() {
+        if (start != 0 && isEnabled()) {
+            recordValue(metric, now() - start, start);
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Metric metric;
+    std::uint64_t start; // 0 — профилировщик был выключен
+};
+
+} // namespace Profiler
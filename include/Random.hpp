@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+// Быстрый генератор xoshiro256** со своим состоянием: у каждого поля или потока свой
+// экземпляр, так что, в отличие от std::rand(), генераторы не делят общее состояние и
+// последовательность зависит только от зерна. Состояние заполняется через splitmix64,
+// поэтому соседние зерна (номера прогонов) дают независимые последовательности.
+class Random {
+public:
+    explicit Random(std::uint64_t seed = 0) { reseed(seed); }
+
+    // stream разводит последовательности с одним зерном: поле номер stream из серии
+    Random(std::uint64_t seed, std::uint64_t stream) { reseed(seed ^ splitmix(stream + 0x632BE59BD9B4E019ull)); }
+
+    void reseed(std::uint64_t seed) {
+        for (std::uint64_t& word : state) {
+            seed += 0x9E3779B97F4A7C15ull;
+            word = splitmix(seed);
+        }
+    }
+
+    std::uint64_t next() {
+        std::uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+
+    // число в [0, bound) без заметного смещения для малых bound
+    std::uint32_t nextBelow(std::uint32_t bound) {
+        return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+
+    // 64 клетки разом: каждый бит равен 1 с вероятностью fillPercent / 100 (с точностью 1/256).
+    // Двоичные разряды вероятности собираются из случайных слов: единица разряда — OR, ноль — AND,
+    // так что слово стоит не больше восьми вызовов next() вместо 64 сравнений.
+    std::uint64_t nextBits(int fillPercent) {
+        if (fillPercent <= 0) return 0;
+        if (fillPercent >= 100) return ~std::uint64_t(0);
+        unsigned threshold = static_cast<unsigned>((fillPercent * 256 + 50) / 100);
+        int lowest = __builtin_ctz(threshold);
+        std::uint64_t bits = next(); // младший ненулевой разряд: вероятность 1/2
+        for (int bit = lowest + 1; bit < 8; ++bit) {
+            bits = (threshold >> bit) & 1u ? bits | next() : bits & next();
+        }
+        return bits;
+    }
+
+private:
+    static std::uint64_t rotateLeft(std::uint64_t value, int shift) {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+    static std::uint64_t splitmix(std::uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    std::uint64_t state[4];
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+
+// Решает, сколько поколений пора посчитать к заданному моменту времени.
+//  FixedRate — фиксированный шаг по времени: прошедшее время копится в аккумуляторе,
+//              за каждый полный период — одно поколение; если ядро не успевает,
+//              догоняется не больше MAX_BACKLOG поколений, остальное отбрасывается.
+//  FrameSkip — та же целевая скорость, но отставание догоняется целиком одной пачкой.
+//  Uncapped  — без ограничения: поколения считаются подряд.
+// Из каждой пачки окно показывает только последнее поколение: снимок копирует поле целиком.
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Mode { FixedRate, FrameSkip, Uncapped };
+
+    static const int MAX_BACKLOG = 4;              // FixedRate: больше за раз не догоняем
+    static constexpr double MAX_CATCH_UP_SECONDS = 1.0; // FrameSkip: предел накопленного отставания
+    static constexpr double DEFAULT_RATE = 5.0;    // поколений в секунду
+
+    Scheduler();
+
+    void setMode(Mode mode);
+    Mode getMode() const;
+    void setTargetRate(double generationsPerSecond);
+    double getTargetRate() const;
+
+    // начать отсчет заново (после паузы), чтобы простой не превратился в отставание
+    void restart(Clock::time_point now);
+
+    // сколько поколений посчитать сейчас; время этих поколений списывается с аккумулятора
+    int advance(Clock::time_point now);
+    Clock::time_point nextDeadline() const; // когда станет должно следующее поколение
+
+private:
+    Clock::duration period() const;
+
+    Mode mode;
+    double targetRate;
+    Clock::time_point last;
+    Clock::duration accumulator;
+};
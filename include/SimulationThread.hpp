@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include "Checkpoint.hpp"
+#include "GameOfLifeCore.hpp"
+#include "Scheduler.hpp"
+#include "TripleBuffer.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Поколения считаются в отдельном потоке, независимо от частоты кадров. После каждого шага
+// поле копируется в тройной буфер, откуда окно берет последний готовый снимок, не блокируясь.
+// Пока поток запущен, GameOfLifeCore трогает только он: правки поля приходят командами
+// и применяются между поколениями.
+class SimulationThread {
+public:
+    // готовое поколение, которое видит окно
+    struct Snapshot {
+        BitGrid grid;
+        int generation = 0;
+        CycleDetector::State cycleState = CycleDetector::State::Running; // закончилась ли игра
+        int period = 0;
+        // Номер последнего изменения поля и каждой его плитки (ActivityTracker). Окно сравнивает
+        // их с тем, что уже нарисовано, и перерисовывает только плитки с новыми номерами.
+        std::uint32_t version = 0;
+        std::vector<std::uint32_t> tileVersions;
+    };
+
+    struct Command {
+        enum class Type {
+            SetCell,    // установить клетку (row, col) в alive
+            Reset,      // новое случайное поле с нулевого поколения
+            History,    // включить (alive) или выключить историю для отмены и перемотки
+            CommitEdit, // конец штриха: следующие правки отменяются отдельно
+            Undo,       // на запись истории назад
+            Redo,
+            Seek        // к записанному поколению, ближайшему к generation
+        };
+        Type type;
+        int row = 0;
+        int col = 0;
+        bool alive = false;
+        int generation = 0;
+    };
+
+    explicit SimulationThread(GameOfLifeCore& game);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void start();
+    void stop(); // дожидается конца текущего шага
+
+    void setRunning(bool running); // false — стоять на месте, но принимать правки
+    void setMode(Scheduler::Mode mode);
+    void setTargetRate(double generationsPerSecond);
+    void post(const Command& command);
+
+    // Снимок в файл path каждые everyGenerations поколений (0 — выключить). Пишет фоновый
+    // поток, шаги его не ждут. Вызывать до start().
+    void setCheckpointing(const std::string& path, int everyGenerations);
+
+    // true, если с прошлого вызова появилось новое поколение или правка
+    bool acquireSnapshot();
+    const Snapshot& getSnapshot() const; // последний снимок, взятый acquireSnapshot()
+
+private:
+    using Clock = Scheduler::Clock;
+
+    void loop();
+    bool applyCommands();
+    void markChangedTiles();
+    void publish();
+
+    GameOfLifeCore& game;
+    TripleBuffer<Snapshot> snapshots;
+
+    std::thread worker;
+    std::mutex mutex;                 // защищает поля ниже и будит поток
+    std::condition_variable wakeUp;
+    std::vector<Command> pending;     // команды окна, ждущие следующего поколения
+    bool stopping;
+    bool running;
+    Scheduler scheduler;
+
+    std::vector<Command> applying;    // команды, которые применяет поток (память переиспользуется)
+    std::uint32_t version;            // растет с каждым поколением и правкой
+    std::vector<std::uint32_t> tileVersions;
+
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    int checkpointEvery;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "BitGrid.hpp"
+#include "LifeRule.hpp"
+#include "Random.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class GameOfLifeCore;
+
+// Перепись исходов случайных «супов»: много независимых полей считаются параллельно, каждое —
+// до вымирания, устойчивой фигуры или цикла (CycleDetector) либо до предела поколений.
+// Суп номер index заполняется генератором Random(seed, index), так что итог не зависит ни от
+// числа потоков, ни от того, какой поток какой суп досчитал.
+namespace SoupSearch {
+
+struct Options {
+    std::uint64_t seed = 1;
+    std::uint64_t soups = 1000;
+    int soupSize = 16;        // суп — квадрат soupSize x soupSize в центре поля
+    int fillPercent = 50;
+    int fieldWidth = 128;     // тор, на котором суп досчитывается
+    int fieldHeight = 128;
+    int maxGenerations = 20000; // не успевший устояться суп считается неустоявшимся
+    int threads = 1;
+    LifeRule rule;
+};
+
+struct SoupResult {
+    bool settled = false;
+    bool extinct = false;
+    int lifespan = 0;   // поколение, с которого поле только повторяется
+    int period = 0;     // период итогового цикла (1 — устойчивая фигура)
+    std::size_t population = 0;
+    int objects = 0;    // связных групп клеток в последнем поколении
+};
+
+// счетчики объектов по имени формы (см. objectName)
+using Census = std::map<std::string, std::uint64_t>;
+
+struct Report {
+    std::uint64_t soups = 0;
+    std::uint64_t settled = 0;
+    std::uint64_t extinct = 0;
+    std::uint64_t lifespanSum = 0;     // по устоявшимся супам
+    int maxLifespan = 0;
+    std::uint64_t maxLifespanSoup = 0; // номер супа с самой долгой жизнью (наименьший при равенстве)
+    std::uint64_t populationSum = 0;
+    std::size_t maxPopulation = 0;
+    std::uint64_t objectSum = 0;
+    std::map<int, std::uint64_t> periods; // период итогового цикла -> число супов (без вымерших)
+    Census objects;
+    double seconds = 0;
+};
+
+// кладет суп номер index в центр пустого поля grid
+void fillSoup(BitGrid& grid, const Options& options, std::uint64_t index);
+
+// Досчитывает суп номер index на game (размер поля и правило берутся из game) и добавляет
+// объекты последнего поколения в census, если он задан.
+SoupResult runSoup(GameOfLifeCore& game, const Options& options, std::uint64_t index, Census* census);
+
+// Все options.soups супов на options.threads потоках. Каждый поток берет супы из своего
+// диапазона номеров, а опустевший крадет половину самого большого чужого остатка.
+Report run(const Options& options);
+
+// Делит поле на 8-связные группы живых клеток (с учетом тора) и считает их по формам.
+// Возвращает число групп.
+int countObjects(const BitGrid& grid, Census& census);
+
+// Имя формы: известные объекты по названию (block, blinker, glider...), остальные — кодом
+// «xs<клеток>_<строки в hex>» канонического из восьми поворотов и отражений вида.
+std::string objectName(const std::vector<std::pair<int, int>>& cells);
+
+} // namespace SoupSearch
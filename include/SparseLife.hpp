@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Разреженное неограниченное поле: плоскость с 64-битными координатами, разбитая на куски
+// CHUNK_SIZE x CHUNK_SIZE клеток. Кусок существует, только пока в нем есть живые клетки
+// (плюс пустые соседи, в которые может перейти жизнь на текущем шаге), так что память
+// растет с населением, а не с размером занятой области. В отличие от тора GameOfLifeCore
+// фигуры здесь никуда не заворачивают: выпущенный ружьем глайдер просто улетает.
+class SparseLife {
+public:
+    static const int CHUNK_SIZE = 64; // строка куска — одно 64-битное слово
+
+    SparseLife();
+
+    void setCell(std::int64_t row, std::int64_t col, bool alive);
+    bool getCell(std::int64_t row, std::int64_t col) const;
+    void clear();
+
+    void update();
+
+    std::uint64_t getGeneration() const;
+    void setGeneration(std::uint64_t newGeneration);
+    std::size_t getPopulation() const;
+    std::size_t getChunkCount() const; // куски, под которые сейчас выделена память
+
+    // наименьший прямоугольник с живыми клетками; false, если поле пустое
+    bool getBounds(std::int64_t& minRow, std::int64_t& minCol,
+                   std::int64_t& maxRow, std::int64_t& maxCol) const;
+
+private:
+    struct ChunkKey {
+        std::int64_t row; // координаты куска: клетка (row, col) лежит в куске (row >> 6, col >> 6)
+        std::int64_t col;
+        bool operator==(const ChunkKey& other) const { return row == other.row && col == other.col; }
+    };
+
+    struct ChunkKeyHash {
+        std::size_t operator()(const ChunkKey& key) const;
+    };
+
+    struct Chunk {
+        ChunkKey key;
+        std::uint64_t cells[2][CHUNK_SIZE]; // текущее и следующее поколения, меняются по четности
+    };
+
+    static const int NO_CHUNK = -1;
+
+    int findChunk(std::int64_t chunkRow, std::int64_t chunkCol) const;
+    int getOrCreateChunk(std::int64_t chunkRow, std::int64_t chunkCol);
+    void releaseChunk(int index);
+    void growBorders(int index);
+    void stepChunk(int index);
+
+    std::vector<Chunk> pool;        // память кусков; освобожденные куски переиспользуются
+    std::vector<int> freeChunks;
+    std::vector<int> liveChunks;    // куски, под которые сейчас выделена память
+    std::unordered_map<ChunkKey, int, ChunkKeyHash> chunkIndex;
+    int current;                    // какой из буферов cells сейчас текущий
+    std::uint64_t generation;
+};
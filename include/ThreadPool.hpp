@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Постоянный пул потоков: потоки создаются один раз и ждут очередной пачки задач.
+// run() раздает задачи 0..taskCount-1 всем потокам (включая вызывающий) и возвращается,
+// только когда все они выполнены, то есть служит барьером между поколениями.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const; // с учетом вызывающего потока
+
+    // task(index) вызывается для каждого index; задача не копируется и не выделяет память
+    template <typename Task>
+    void run(int taskCount, Task& task) {
+        runTasks(taskCount, [](void* context, int index) { (*static_cast<Task*>(context))(index); }, &task);
+    }
+
+private:
+    using TaskFunction = void (*)(void* context, int index);
+
+    void runTasks(int taskCount, TaskFunction function, void* context);
+    void workerLoop();
+    void executeTasks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    TaskFunction taskFunction = nullptr;
+    void* taskContext = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{0};
+    int activeWorkers = 0;
+    std::uint64_t batch = 0; // номер текущей пачки задач
+    bool stopping = false;
+};
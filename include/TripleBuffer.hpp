@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+
+// Тройной буфер без блокировок для одного писателя и одного читателя. Писатель заполняет
+// свой буфер и публикует его, обменивая с промежуточным; читатель забирает промежуточный,
+// если там есть новые данные. Ни одна из сторон не ждет другую, и обе всегда работают
+// с целым, не изменяющимся под ними буфером.
+template <typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial) : buffers{initial, initial, initial} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // сторона писателя
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+    void publish() {
+        int previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+    // читатель уже забрал последний опубликованный буфер
+    bool wasRead() const { return !(middle.load(std::memory_order_acquire) & FRESH); }
+
+    // сторона читателя: true, если после прошлого вызова опубликован новый буфер
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+    const T& getReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4; // в промежуточном буфере данные, которых читатель еще не видел
+
+    T buffers[3];
+    int writeIndex = 0;
+    std::atomic<int> middle{1};
+    int readIndex = 2;
+};
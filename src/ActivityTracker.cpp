@@ -0,0 +1,114 @@
+#include "ActivityTracker.hpp"
+
+const int ActivityTracker::TILE_WORDS;
+const int ActivityTracker::TILE_WIDTH;
+const int ActivityTracker::TILE_HEIGHT;
+
+ActivityTracker::ActivityTracker()
+    : tilesX(0), tilesY(0) {}
+
+ActivityTracker::ActivityTracker(int width, int height)
+    : tilesX((width + TILE_WIDTH - 1) / TILE_WIDTH),
+      tilesY((height + TILE_HEIGHT - 1) / TILE_HEIGHT) {
+    std::size_t tiles = static_cast<std::size_t>(tilesX) * tilesY;
+    changed.assign(tiles, 0);
+    active.assign(tiles, 0);
+    bandActive.assign(tilesY, 0);
+    // списки заранее занимают максимум, чтобы шаги не выделяли память
+    changedTiles.reserve(tiles);
+    activeTiles.reserve(tiles);
+    activeBands.reserve(tilesY);
+    markAll();
+}
+
+int ActivityTracker::getTilesX() const {
+    return tilesX;
+}
+
+int ActivityTracker::getTilesY() const {
+    return tilesY;
+}
+
+bool ActivityTracker::isChanged(int tileX, int tileY) const {
+    return changed[tileY * tilesX + tileX] != 0;
+}
+
+const std::vector<int>& ActivityTracker::getChangedTiles() const {
+    return changedTiles;
+}
+
+void ActivityTracker::markAll() {
+    changedTiles.clear();
+    for (int tile = 0; tile < tilesX * tilesY; ++tile) {
+        changed[tile] = 1;
+        changedTiles.push_back(tile);
+    }
+}
+
+void ActivityTracker::markCell(int row, int col) {
+    int tile = (row / TILE_HEIGHT) * tilesX + col / TILE_WIDTH;
+    if (!changed[tile]) {
+        changed[tile] = 1;
+        changedTiles.push_back(tile);
+    }
+}
+
+void ActivityTracker::activate(int tileX, int tileY) {
+    int tile = tileY * tilesX + tileX;
+    if (!active[tile]) {
+        active[tile] = 1;
+        activeTiles.push_back(tile);
+        if (!bandActive[tileY]) {
+            bandActive[tileY] = 1;
+            activeBands.push_back(tileY);
+        }
+    }
+}
+
+// работа пропорциональна числу изменившихся плиток, а не размеру поля
+void ActivityTracker::beginStep() {
+    for (int tile : changedTiles) {
+        int tileX = tile % tilesX;
+        int tileY = tile / tilesX;
+        int left = tileX == 0 ? tilesX - 1 : tileX - 1;
+        int right = tileX == tilesX - 1 ? 0 : tileX + 1;
+        int up = tileY == 0 ? tilesY - 1 : tileY - 1;
+        int down = tileY == tilesY - 1 ? 0 : tileY + 1;
+
+        const int columns[3] = {left, tileX, right};
+        const int rows[3] = {up, tileY, down};
+        for (int r : rows) {
+            for (int c : columns) {
+                activate(c, r);
+            }
+        }
+        changed[tile] = 0;
+    }
+    changedTiles.clear();
+}
+
+const std::vector<int>& ActivityTracker::getActiveBands() const {
+    return activeBands;
+}
+
+bool ActivityTracker::isActive(int tileX, int tileY) const {
+    return active[tileY * tilesX + tileX] != 0;
+}
+
+void ActivityTracker::setChanged(int tileX, int tileY, bool tileChanged) {
+    changed[tileY * tilesX + tileX] = tileChanged ? 1 : 0;
+}
+
+void ActivityTracker::endStep() {
+    for (int tile : activeTiles) {
+        if (changed[tile]) {
+            changedTiles.push_back(tile);
+        }
+        active[tile] = 0;
+    }
+    for (int band : activeBands) {
+        bandActive[band] = 0;
+    }
+    activeTiles.clear();
+    activeBands.clear();
+}
@@ -0,0 +1,41 @@
+#include "BitGrid.hpp"
+#include <algorithm>
+#include <cstring>
+
+const int BitGrid::WORD_BITS;
+const int BitGrid::CACHE_LINE_BYTES;
+const int BitGrid::CACHE_LINE_WORDS;
+
+BitGrid::BitGrid()
+    : width(0), height(0), wordsPerRow(0), stride(0), lastWordMask(0) {}
+
+BitGrid::BitGrid(int width, int height)
+    : width(width), height(height) {
+    wordsPerRow = (width + WORD_BITS - 1) / WORD_BITS;
+    // выравниваем длину строки до целого числа кэш-линий
+    stride = (wordsPerRow + CACHE_LINE_WORDS - 1) / CACHE_LINE_WORDS * CACHE_LINE_WORDS;
+    int tailBits = width % WORD_BITS;
+    lastWordMask = tailBits == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << tailBits) - 1;
+    words.assign(static_cast<std::size_t>(stride) * height, 0);
+}
+
+void BitGrid::clear() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+std::size_t BitGrid::population() const {
+    std::size_t count = 0;
+    for (std::uint64_t word : words) {
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+bool BitGrid::operator==(const BitGrid& other) const {
+    return width == other.width && height == other.height &&
+           std::memcmp(words.data(), other.words.data(), words.size() * sizeof(std::uint64_t)) == 0;
+}
+
+std::size_t BitGrid::getAllocationCount() {
+    return Allocator::allocationCounter().load(std::memory_order_relaxed);
+}
@@ -0,0 +1,325 @@
+#include "Checkpoint.hpp"
+#include "GameOfLifeCore.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const char MAGIC[8] = {'G', 'O', 'L', 'C', 'K', 'P', 'T', '\0'};
+const std::size_t RULE_BYTES = 256;
+
+// Заголовок файла; числа в порядке байтов машины, его выдает сигнатура ENDIAN_MARK
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianMark;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t stride; // слов между началами строк
+    std::uint32_t reserved;
+    std::uint64_t generation;
+    std::uint64_t dataBytes;
+    std::uint64_t checksum;
+    char rule[RULE_BYTES];
+};
+
+const std::uint32_t ENDIAN_MARK = 0x01020304u;
+
+static_assert(sizeof(FileHeader) <= Checkpoint::HEADER_BYTES, "заголовок должен помещаться в страницу");
+
+inline std::uint64_t rotateLeft(std::uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// пишет все куски целиком: writev может записать меньше, чем просили
+bool writeAll(int fd, iovec* parts, int count) {
+    while (count > 0) {
+        ssize_t done = ::writev(fd, parts, count);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        std::size_t left = static_cast<std::size_t>(done);
+        while (count > 0 && left >= parts->iov_len) {
+            left -= parts->iov_len;
+            ++parts;
+            --count;
+        }
+        if (count > 0) {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+            parts->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+namespace Checkpoint {
+
+// четыре независимые цепочки, чтобы умножения шли параллельно; скорость порядка пропускной способности памяти
+std::uint64_t checksum(const std::uint64_t* words, std::size_t count) {
+    const std::uint64_t PRIME = 0x9E3779B97F4A7C15ull;
+    std::uint64_t lanes[4] = {0x243F6A8885A308D3ull, 0x13198A2E03707344ull, 0xA4093822299F31D0ull, 0x082EFA98EC4E6C89ull};
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int lane = 0; lane < 4; ++lane) {
+            lanes[lane] = rotateLeft(lanes[lane] ^ words[i + lane], 29) * PRIME;
+        }
+    }
+    for (; i < count; ++i) {
+        lanes[0] = rotateLeft(lanes[0] ^ words[i], 29) * PRIME;
+    }
+    std::uint64_t hash = count;
+    for (std::uint64_t lane : lanes) {
+        hash = rotateLeft(hash ^ lane, 31) * PRIME;
+    }
+    return hash ^ (hash >> 32);
+}
+
+bool save(const std::string& path, const BitGrid& grid, const LifeRule& rule, std::uint64_t generation,
+          std::string& error) {
+    std::string ruleText = rule.toString();
+    if (ruleText.size() >= RULE_BYTES) {
+        error = "rule string too long";
+        return false;
+    }
+    std::size_t words = static_cast<std::size_t>(grid.getStride()) * grid.getHeight();
+
+    static_assert(HEADER_BYTES % alignof(FileHeader) == 0, "");
+    alignas(FileHeader) char page[HEADER_BYTES] = {};
+    FileHeader& header = *reinterpret_cast<FileHeader*>(page);
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.endianMark = ENDIAN_MARK;
+    header.width = static_cast<std::uint32_t>(grid.getWidth());
+    header.height = static_cast<std::uint32_t>(grid.getHeight());
+    header.stride = static_cast<std::uint32_t>(grid.getStride());
+    header.generation = generation;
+    header.dataBytes = words * sizeof(std::uint64_t);
+    header.checksum = checksum(grid.row(0), words);
+    std::memcpy(header.rule, ruleText.c_str(), ruleText.size() + 1);
+
+    // временный файл переименовывается только целиком записанным
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = systemError("cannot create " + temporary);
+        return false;
+    }
+    iovec parts[2] = {{page, HEADER_BYTES}, {const_cast<std::uint64_t*>(grid.row(0)), header.dataBytes}};
+    bool ok = writeAll(fd, parts, header.dataBytes > 0 ? 2 : 1) && ::fsync(fd) == 0;
+    if (!ok) {
+        error = systemError("cannot write " + temporary);
+    }
+    ok = ::close(fd) == 0 && ok;
+    if (ok && std::rename(temporary.c_str(), path.c_str()) != 0) {
+        error = systemError("cannot rename to " + path);
+        ok = false;
+    }
+    if (!ok) {
+        ::unlink(temporary.c_str());
+    }
+    return ok;
+}
+
+bool save(const std::string& path, const GameOfLifeCore& game, std::string& error) {
+    return save(path, game.getGrid(), game.getRule(), static_cast<std::uint64_t>(game.getGeneration()), error);
+}
+
+bool restore(const std::string& path, GameOfLifeCore& game, std::string& error, bool verify) {
+    MappedCheckpoint checkpoint;
+    if (!checkpoint.open(path, error)) {
+        return false;
+    }
+    if (verify && !checkpoint.verify()) {
+        error = "checksum mismatch in " + path;
+        return false;
+    }
+    int side = 2 * checkpoint.getRule().getRange() + 1;
+    if (side > checkpoint.getWidth() || side > checkpoint.getHeight()) {
+        error = "rule neighbourhood does not fit the field";
+        return false;
+    }
+    // снимок хранит 64-битное поколение (его пишет и HashLife), у GameOfLifeCore оно int
+    if (checkpoint.getGeneration() > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        error = "generation " + std::to_string(checkpoint.getGeneration()) + " in " + path + " is out of range";
+        return false;
+    }
+    BitGrid grid(checkpoint.getWidth(), checkpoint.getHeight());
+    checkpoint.copyTo(grid);
+    game.loadGrid(std::move(grid));
+    game.setRule(checkpoint.getRule());
+    game.setGeneration(static_cast<int>(checkpoint.getGeneration()));
+    return true;
+}
+
+bool isCheckpoint(const std::string& path) {
+    char magic[sizeof(MAGIC)];
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool match = ::read(fd, magic, sizeof(magic)) == static_cast<ssize_t>(sizeof(magic)) &&
+                 std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    ::close(fd);
+    return match;
+}
+
+} // namespace Checkpoint
+
+MappedCheckpoint::MappedCheckpoint()
+    : mapping(nullptr), mappingBytes(0), data(nullptr), width(0), height(0), stride(0), generation(0),
+      expectedChecksum(0) {}
+
+MappedCheckpoint::~MappedCheckpoint() {
+    close();
+}
+
+bool MappedCheckpoint::open(const std::string& path, std::string& error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = systemError("cannot open " + path);
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < Checkpoint::HEADER_BYTES) {
+        ::close(fd);
+        error = path + " is not a checkpoint";
+        return false;
+    }
+    std::size_t bytes = static_cast<std::size_t>(info.st_size);
+    void* address = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // отображение живет и без дескриптора
+    if (address == MAP_FAILED) {
+        error = systemError("cannot map " + path);
+        return false;
+    }
+    mapping = address;
+    mappingBytes = bytes;
+
+    const FileHeader& header = *static_cast<const FileHeader*>(address);
+    std::uint64_t rowWords = (static_cast<std::uint64_t>(header.width) + BitGrid::WORD_BITS - 1) / BitGrid::WORD_BITS;
+    LifeRule parsedRule;
+    bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == Checkpoint::VERSION &&
+                 header.endianMark == ENDIAN_MARK && header.width > 0 && header.height > 0 &&
+                 header.width <= 0x7FFFFFFFu && header.height <= 0x7FFFFFFFu && header.stride >= rowWords &&
+                 header.dataBytes == std::uint64_t(header.stride) * header.height * sizeof(std::uint64_t) &&
+                 header.dataBytes <= bytes - Checkpoint::HEADER_BYTES &&
+                 std::memchr(header.rule, '\0', RULE_BYTES) != nullptr && LifeRule::parse(header.rule, parsedRule);
+    if (!valid) {
+        close();
+        error = path + " has a bad or unsupported checkpoint header";
+        return false;
+    }
+    data = reinterpret_cast<const std::uint64_t*>(static_cast<const char*>(address) + Checkpoint::HEADER_BYTES);
+    width = static_cast<int>(header.width);
+    height = static_cast<int>(header.height);
+    stride = static_cast<int>(header.stride);
+    generation = header.generation;
+    expectedChecksum = header.checksum;
+    rule = parsedRule;
+    // данные читаются подряд: ядро заранее подтянет следующие страницы
+    ::madvise(address, bytes, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedCheckpoint::close() {
+    if (mapping) {
+        ::munmap(mapping, mappingBytes);
+    }
+    mapping = nullptr;
+    mappingBytes = 0;
+    data = nullptr;
+    width = height = stride = 0;
+}
+
+bool MappedCheckpoint::verify() const {
+    return data && Checkpoint::checksum(data, static_cast<std::size_t>(stride) * height) == expectedChecksum;
+}
+
+void MappedCheckpoint::copyTo(BitGrid& grid) const {
+    if (grid.getStride() == stride) {
+        // раскладка строк совпадает: одно копирование всего блока
+        std::memcpy(grid.row(0), data, static_cast<std::size_t>(stride) * height * sizeof(std::uint64_t));
+        return;
+    }
+    for (int r = 0; r < height; ++r) {
+        std::memcpy(grid.row(r), row(r), static_cast<std::size_t>(grid.getWordsPerRow()) * sizeof(std::uint64_t));
+    }
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path)
+    : path(path), pendingGeneration(0), hasPending(false), writing(false), stopping(false),
+      written(0), skipped(0), failed(0), worker(&CheckpointWriter::loop, this) {}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    worker.join();
+}
+
+bool CheckpointWriter::request(const BitGrid& grid, const LifeRule& rule, std::uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (hasPending) {
+        skipped++;
+        return false;
+    }
+    // поток записи держит мьютекс только на обмен буферами, так что копирование не ждет диск;
+    // при неизменном размере поля память не выделяется
+    pending = grid;
+    pendingRule = rule;
+    pendingGeneration = generation;
+    hasPending = true;
+    wakeUp.notify_one();
+    return true;
+}
+
+void CheckpointWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !hasPending && !writing; });
+}
+
+void CheckpointWriter::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeUp.wait(lock, [this] { return hasPending || stopping; });
+        if (!hasPending) {
+            break; // stopping и писать нечего
+        }
+        std::swap(current, pending);
+        LifeRule rule = pendingRule;
+        std::uint64_t generation = pendingGeneration;
+        hasPending = false;
+        writing = true;
+        lock.unlock();
+
+        std::string error;
+        if (Checkpoint::save(path, current, rule, generation, error)) {
+            written++;
+        } else {
+            std::fprintf(stderr, "checkpoint: %s\n", error.c_str());
+            failed++;
+        }
+
+        lock.lock();
+        writing = false;
+        done.notify_all();
+    }
+}
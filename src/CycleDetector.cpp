@@ -0,0 +1,63 @@
+#include "CycleDetector.hpp"
+
+const int CycleDetector::HISTORY;
+const int CycleDetector::TABLE_SIZE;
+const int CycleDetector::MAX_PROBES;
+
+CycleDetector::CycleDetector() : table(TABLE_SIZE, Entry{0, 0, 0, 0}) {
+    reset();
+}
+
+void CycleDetector::reset() {
+    ++epoch; // таблицу чистить не нужно: записи прошлой эпохи не свежие
+    state = State::Running;
+    period = 0;
+    detectedAt = 0;
+}
+
+void CycleDetector::record(std::uint64_t hash, std::size_t population, int generation) {
+    if (state != State::Running) {
+        return; // правило детерминировано: раз поле повторилось, дальше оно идет по кругу
+    }
+    if (population == 0) {
+        state = State::Extinct;
+        period = 1;
+        detectedAt = generation;
+        return;
+    }
+
+    // запись свежая, если она сделана после reset() и не раньше HISTORY поколений назад
+    auto isFresh = [this, generation](const Entry& entry) {
+        return entry.epoch == epoch && generation - entry.generation <= HISTORY;
+    };
+    int start = static_cast<int>(hash & (TABLE_SIZE - 1));
+    Entry* slot = nullptr; // куда записать поколение: пустая, устаревшая или самая старая запись
+    for (int probe = 0; probe < MAX_PROBES; ++probe) {
+        Entry& entry = table[(start + probe) & (TABLE_SIZE - 1)];
+        if (isFresh(entry)) {
+            // совпадение численности отсекает большую часть случайных совпадений хэша
+            if (entry.hash == hash && entry.population == population && entry.generation < generation) {
+                period = generation - entry.generation;
+                state = period == 1 ? State::StillLife : State::Oscillating;
+                detectedAt = generation;
+                return;
+            }
+            if (!slot || (isFresh(*slot) && entry.generation < slot->generation)) {
+                slot = &entry;
+            }
+        } else if (!slot || isFresh(*slot)) {
+            slot = &entry;
+        }
+    }
+    slot->hash = hash;
+    slot->population = population;
+    slot->generation = generation;
+    slot->epoch = epoch;
+}
+
+void CycleDetector::setPeriod(int exactPeriod) {
+    if (state == State::StillLife || state == State::Oscillating) {
+        period = exactPeriod;
+        state = period == 1 ? State::StillLife : State::Oscillating;
+    }
+}
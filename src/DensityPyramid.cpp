@@ -0,0 +1,152 @@
+#include "DensityPyramid.hpp"
+#include "ActivityTracker.hpp"
+#include <algorithm>
+#include <utility>
+
+const int DensityPyramid::BASE_LEVEL;
+
+namespace {
+
+const int BASE_BLOCK = 1 << DensityPyramid::BASE_LEVEL;
+const std::uint64_t BASE_MASK = (std::uint64_t(1) << BASE_BLOCK) - 1;
+const int BLOCKS_PER_WORD = BitGrid::WORD_BITS / BASE_BLOCK;
+const int BLOCKS_PER_TILE = ActivityTracker::TILE_WIDTH / BASE_BLOCK;
+
+static_assert(ActivityTracker::TILE_HEIGHT == BASE_BLOCK, "строка плиток должна совпадать со строкой базовых блоков");
+
+} // namespace
+
+DensityPyramid::DensityPyramid() : width(0), height(0) {}
+
+void DensityPyramid::rebuild(const BitGrid& grid) {
+    width = grid.getWidth();
+    height = grid.getHeight();
+    levels.clear();
+
+    Level base;
+    base.blocksX = (width + BASE_BLOCK - 1) / BASE_BLOCK;
+    base.blocksY = (height + BASE_BLOCK - 1) / BASE_BLOCK;
+    base.counts.assign(static_cast<std::size_t>(base.blocksX) * base.blocksY, 0);
+    levels.push_back(std::move(base));
+    while (levels.back().blocksX > 1 || levels.back().blocksY > 1) {
+        Level parent;
+        parent.blocksX = (levels.back().blocksX + 1) / 2;
+        parent.blocksY = (levels.back().blocksY + 1) / 2;
+        parent.counts.assign(static_cast<std::size_t>(parent.blocksX) * parent.blocksY, 0);
+        levels.push_back(std::move(parent));
+    }
+    marked.assign(levels.size() > 1 ? levels[1].counts.size() : 0, 0);
+    dirty.reserve(levels[0].counts.size());
+    dirtyParents.reserve(marked.size());
+
+    for (int r = 0; r < levels[0].blocksY; ++r) {
+        for (int c = 0; c < levels[0].blocksX; ++c) {
+            computeBase(grid, r, c);
+        }
+    }
+    for (std::size_t i = 1; i < levels.size(); ++i) {
+        for (int r = 0; r < levels[i].blocksY; ++r) {
+            for (int c = 0; c < levels[i].blocksX; ++c) {
+                computeParent(static_cast<int>(i), r, c);
+            }
+        }
+    }
+}
+
+// работа пропорциональна числу изменившихся плиток, а не размеру поля
+void DensityPyramid::updateTiles(const BitGrid& grid, const std::vector<int>& tiles) {
+    if (grid.getWidth() != width || grid.getHeight() != height) {
+        rebuild(grid);
+        return;
+    }
+    int tilesX = (width + ActivityTracker::TILE_WIDTH - 1) / ActivityTracker::TILE_WIDTH;
+    const Level& base = levels[0];
+    dirty.clear();
+    for (int tile : tiles) {
+        int blockRow = tile / tilesX;
+        int firstBlock = (tile % tilesX) * BLOCKS_PER_TILE;
+        int lastBlock = std::min(firstBlock + BLOCKS_PER_TILE, base.blocksX);
+        for (int c = firstBlock; c < lastBlock; ++c) {
+            computeBase(grid, blockRow, c);
+            dirty.push_back(blockRow * base.blocksX + c);
+        }
+    }
+
+    for (std::size_t i = 1; i < levels.size(); ++i) {
+        const Level& child = levels[i - 1];
+        const Level& parent = levels[i];
+        dirtyParents.clear();
+        for (int block : dirty) {
+            int index = (block / child.blocksX / 2) * parent.blocksX + (block % child.blocksX) / 2;
+            if (!marked[index]) {
+                marked[index] = 1;
+                dirtyParents.push_back(index);
+            }
+        }
+        for (int index : dirtyParents) {
+            marked[index] = 0;
+            computeParent(static_cast<int>(i), index / parent.blocksX, index % parent.blocksX);
+        }
+        dirty.swap(dirtyParents);
+    }
+}
+
+int DensityPyramid::getWidth() const {
+    return width;
+}
+
+int DensityPyramid::getHeight() const {
+    return height;
+}
+
+int DensityPyramid::getLevelCount() const {
+    return BASE_LEVEL + static_cast<int>(levels.size());
+}
+
+std::uint32_t DensityPyramid::count(const BitGrid& grid, int level, int blockRow, int blockCol) const {
+    if (level >= BASE_LEVEL) {
+        const Level& stored = levels[level - BASE_LEVEL];
+        if (blockRow < 0 || blockCol < 0 || blockRow >= stored.blocksY || blockCol >= stored.blocksX) {
+            return 0;
+        }
+        return stored.counts[static_cast<std::size_t>(blockRow) * stored.blocksX + blockCol];
+    }
+
+    // мелкий блок целиком лежит в одном слове каждой строки
+    int size = 1 << level;
+    int row = blockRow * size;
+    int col = blockCol * size;
+    if (blockRow < 0 || blockCol < 0 || row >= height || col >= width) {
+        return 0;
+    }
+    std::uint64_t mask = ((std::uint64_t(1) << size) - 1) << (col % BitGrid::WORD_BITS);
+    int rowEnd = std::min(row + size, height);
+    std::uint32_t total = 0;
+    for (int r = row; r < rowEnd; ++r) {
+        total += __builtin_popcountll(grid.row(r)[col / BitGrid::WORD_BITS] & mask);
+    }
+    return total;
+}
+
+void DensityPyramid::computeBase(const BitGrid& grid, int blockRow, int blockCol) {
+    int word = blockCol / BLOCKS_PER_WORD;
+    int shift = (blockCol % BLOCKS_PER_WORD) * BASE_BLOCK;
+    int rowBegin = blockRow * BASE_BLOCK;
+    int rowEnd = std::min(rowBegin + BASE_BLOCK, height);
+    std::uint32_t total = 0;
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        total += __builtin_popcountll((grid.row(r)[word] >> shift) & BASE_MASK);
+    }
+    levels[0].counts[static_cast<std::size_t>(blockRow) * levels[0].blocksX + blockCol] = total;
+}
+
+void DensityPyramid::computeParent(int level, int blockRow, int blockCol) {
+    const Level& child = levels[level - 1];
+    std::uint32_t total = 0;
+    for (int r = blockRow * 2; r < std::min(blockRow * 2 + 2, child.blocksY); ++r) {
+        for (int c = blockCol * 2; c < std::min(blockCol * 2 + 2, child.blocksX); ++c) {
+            total += child.counts[static_cast<std::size_t>(r) * child.blocksX + c];
+        }
+    }
+    levels[level].counts[static_cast<std::size_t>(blockRow) * levels[level].blocksX + blockCol] = total;
+}
@@ -0,0 +1,425 @@
+#include "Distributed.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Distributed {
+
+namespace {
+
+// Копирует прямоугольник rows x cols из src (координаты заворачиваются по тору src)
+// в dst с угла (dstRow, dstCol) кусками до слова.
+void copyRect(const BitGrid& src, int srcRow, int srcCol, BitGrid& dst, int dstRow, int dstCol, int rows, int cols) {
+    int width = src.getWidth();
+    int height = src.getHeight();
+    for (int r = 0; r < rows; ++r) {
+        int y = ((srcRow + r) % height + height) % height;
+        for (int c = 0; c < cols;) {
+            int x = ((srcCol + c) % width + width) % width;
+            int count = std::min({BitGrid::WORD_BITS, cols - c, width - x});
+            dst.setBits(dstRow + r, dstCol + c, count, src.getBits(y, x, count));
+            c += count;
+        }
+    }
+}
+
+void pack(const BitGrid& strip, std::vector<std::uint64_t>& words) {
+    int wordsPerRow = strip.getWordsPerRow();
+    for (int r = 0; r < strip.getHeight(); ++r) {
+        std::copy(strip.row(r), strip.row(r) + wordsPerRow, words.begin() + static_cast<std::size_t>(r) * wordsPerRow);
+    }
+}
+
+void unpack(const std::vector<std::uint64_t>& words, BitGrid& strip) {
+    int wordsPerRow = strip.getWordsPerRow();
+    for (int r = 0; r < strip.getHeight(); ++r) {
+        auto begin = words.begin() + static_cast<std::size_t>(r) * wordsPerRow;
+        std::copy(begin, begin + wordsPerRow, strip.row(r));
+    }
+}
+
+std::size_t packedSize(const BitGrid& strip) {
+    return static_cast<std::size_t>(strip.getHeight()) * strip.getWordsPerRow();
+}
+
+bool readAll(int fd, void* data, std::size_t bytes) {
+    char* out = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::recv(fd, out, bytes, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool writeAll(int fd, const void* data, std::size_t bytes) {
+    const char* in = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::send(fd, in, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        in += n;
+        bytes -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// поле по строкам прямо из его памяти, без упаковки в отдельный буфер
+bool sendGrid(int fd, const BitGrid& grid) {
+    std::size_t rowBytes = static_cast<std::size_t>(grid.getWordsPerRow()) * sizeof(std::uint64_t);
+    for (int r = 0; r < grid.getHeight(); ++r) {
+        if (!writeAll(fd, grid.row(r), rowBytes)) return false;
+    }
+    return true;
+}
+
+bool receiveGrid(int fd, BitGrid& grid) {
+    std::size_t rowBytes = static_cast<std::size_t>(grid.getWordsPerRow()) * sizeof(std::uint64_t);
+    for (int r = 0; r < grid.getHeight(); ++r) {
+        if (!readAll(fd, grid.row(r), rowBytes)) return false;
+    }
+    return true;
+}
+
+void closeAll(std::vector<int>& fds) {
+    for (int& fd : fds) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+const char* sideName(Side side) {
+    switch (side) {
+    case Left: return "left";
+    case Right: return "right";
+    case Up: return "up";
+    default: return "down";
+    }
+}
+
+} // namespace
+
+SocketTransport::SocketTransport(const int (&sideFds)[SIDES]) {
+    for (int side = 0; side < SIDES; ++side) {
+        fds[side] = sideFds[side];
+        // обмен сам ждет готовности в poll(), а блокирующая запись в кольце соседей встала бы
+        ::fcntl(fds[side], F_SETFL, ::fcntl(fds[side], F_GETFL) | O_NONBLOCK);
+    }
+}
+
+SocketTransport::~SocketTransport() {
+    for (int fd : fds) {
+        ::close(fd);
+    }
+}
+
+bool SocketTransport::exchange(Message* messages, int count, std::string& error) {
+    std::vector<std::size_t> sent(count, 0);
+    std::vector<std::size_t> received(count, 0);
+    std::vector<pollfd> polls;
+    std::vector<int> owners;
+    while (true) {
+        polls.clear();
+        owners.clear();
+        for (int i = 0; i < count; ++i) {
+            short events = 0;
+            if (sent[i] < messages[i].send->size() * sizeof(std::uint64_t)) events |= POLLOUT;
+            if (received[i] < messages[i].receive->size() * sizeof(std::uint64_t)) events |= POLLIN;
+            if (events != 0) {
+                polls.push_back({fds[messages[i].side], events, 0});
+                owners.push_back(i);
+            }
+        }
+        if (polls.empty()) {
+            return true;
+        }
+        if (::poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("poll: ") + std::strerror(errno);
+            return false;
+        }
+        for (std::size_t p = 0; p < polls.size(); ++p) {
+            Message& message = messages[owners[p]];
+            short ready = polls[p].revents;
+            if ((ready & (POLLOUT | POLLERR)) && (polls[p].events & POLLOUT)) {
+                std::size_t& done = sent[owners[p]];
+                const char* data = reinterpret_cast<const char*>(message.send->data());
+                ssize_t n = ::send(polls[p].fd, data + done, message.send->size() * sizeof(std::uint64_t) - done,
+                                   MSG_NOSIGNAL);
+                if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                    error = std::string("send to ") + sideName(message.side) + " neighbour: " + std::strerror(errno);
+                    return false;
+                }
+                done += n > 0 ? static_cast<std::size_t>(n) : 0;
+            }
+            if ((ready & (POLLIN | POLLHUP | POLLERR)) && (polls[p].events & POLLIN)) {
+                std::size_t& done = received[owners[p]];
+                char* data = reinterpret_cast<char*>(message.receive->data());
+                ssize_t n = ::recv(polls[p].fd, data + done, message.receive->size() * sizeof(std::uint64_t) - done, 0);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                    error = std::string(sideName(message.side)) + " neighbour " +
+                            (n == 0 ? std::string("closed the connection") : std::strerror(errno));
+                    return false;
+                }
+                done += n > 0 ? static_cast<std::size_t>(n) : 0;
+            }
+        }
+    }
+}
+
+TileWorker::TileWorker(const Partition& partition, int tileX, int tileY, const LifeRule& rule, int stepsPerExchange)
+    : partition(partition), tileX(tileX), tileY(tileY), width(partition.tileWidth(tileX)),
+      height(partition.tileHeight(tileY)), steps(std::max(1, stepsPerExchange)), halo(rule.getRange() * steps),
+      core(width + 2 * halo, height + 2 * halo) {
+    core.setRule(rule);
+    strips[Left] = BitGrid(halo, height);
+    strips[Right] = BitGrid(halo, height);
+    strips[Up] = BitGrid(width + 2 * halo, halo);
+    strips[Down] = BitGrid(width + 2 * halo, halo);
+    for (int side = 0; side < SIDES; ++side) {
+        sendWords[side].resize(packedSize(strips[side]));
+        receiveWords[side].resize(packedSize(strips[side]));
+    }
+}
+
+void TileWorker::load(BitGrid&& local) {
+    core.loadGrid(std::move(local));
+}
+
+bool TileWorker::advance(int generations, HaloTransport& transport, std::string& error) {
+    for (int done = 0; done < generations;) {
+        // ореол после load() свежий; дальше его обновляет каждый обмен
+        if (done > 0 && !exchange(transport, error)) {
+            return false;
+        }
+        int count = std::min(steps, generations - done);
+        for (int step = 0; step < count; ++step) {
+            core.update();
+        }
+        done += count;
+    }
+    return true;
+}
+
+bool TileWorker::exchange(HaloTransport& transport, std::string& error) {
+    const BitGrid& local = core.getGrid();
+    // столбцы: соседу слева — свои левые halo столбцов, справа — правые
+    copyRect(local, halo, halo, strips[Left], 0, 0, height, halo);
+    copyRect(local, halo, width, strips[Right], 0, 0, height, halo);
+    pack(strips[Left], sendWords[Left]);
+    pack(strips[Right], sendWords[Right]);
+    HaloTransport::Message columns[] = {{Left, &sendWords[Left], &receiveWords[Left]},
+                                        {Right, &sendWords[Right], &receiveWords[Right]}};
+    if (!transport.exchange(columns, 2, error)) {
+        return false;
+    }
+    unpack(receiveWords[Left], strips[Left]);
+    unpack(receiveWords[Right], strips[Right]);
+    core.setRegion(halo, 0, strips[Left]);
+    core.setRegion(halo, width + halo, strips[Right]);
+
+    // строки во всю ширину, вместе с только что полученными столбцами — так приходят и углы
+    copyRect(local, halo, 0, strips[Up], 0, 0, halo, width + 2 * halo);
+    copyRect(local, height, 0, strips[Down], 0, 0, halo, width + 2 * halo);
+    pack(strips[Up], sendWords[Up]);
+    pack(strips[Down], sendWords[Down]);
+    HaloTransport::Message rows[] = {{Up, &sendWords[Up], &receiveWords[Up]},
+                                     {Down, &sendWords[Down], &receiveWords[Down]}};
+    if (!transport.exchange(rows, 2, error)) {
+        return false;
+    }
+    unpack(receiveWords[Up], strips[Up]);
+    unpack(receiveWords[Down], strips[Down]);
+    core.setRegion(0, 0, strips[Up]);
+    core.setRegion(height + halo, 0, strips[Down]);
+    return true;
+}
+
+BitGrid TileWorker::getInterior() const {
+    BitGrid interior(width, height);
+    copyRect(core.getGrid(), halo, halo, interior, 0, 0, height, width);
+    return interior;
+}
+
+BitGrid cut(const BitGrid& field, const Partition& partition, int tileX, int tileY, int halo) {
+    BitGrid local(partition.tileWidth(tileX) + 2 * halo, partition.tileHeight(tileY) + 2 * halo);
+    copyRect(field, partition.rowBegin(tileY) - halo, partition.colBegin(tileX) - halo, local, 0, 0,
+             local.getHeight(), local.getWidth());
+    return local;
+}
+
+bool validate(const Partition& partition, const LifeRule& rule, int stepsPerExchange, std::string& error) {
+    if (partition.tilesX < 1 || partition.tilesY < 1) {
+        error = "at least one tile is needed";
+        return false;
+    }
+    if (rule.getStates() > 2) {
+        error = "Generations rules are not supported";
+        return false;
+    }
+    // полоса для соседа берется из прямоугольника целиком, так что он не уже ореола
+    int halo = rule.getRange() * std::max(1, stepsPerExchange);
+    if (partition.width / partition.tilesX < halo || partition.height / partition.tilesY < halo) {
+        error = "tiles are smaller than the halo of " + std::to_string(halo) + " cells";
+        return false;
+    }
+    return true;
+}
+
+bool run(GameOfLifeCore& game, int generations, const Options& options, std::string& error) {
+    Partition partition;
+    partition.width = game.getWidth();
+    partition.height = game.getHeight();
+    partition.tilesX = options.tilesX;
+    partition.tilesY = options.tilesY;
+    if (!validate(partition, game.getRule(), options.stepsPerExchange, error)) {
+        return false;
+    }
+    if (generations <= 0) {
+        return true;
+    }
+
+    // концы связей по сторонам каждого прямоугольника, соседи замкнуты по тору
+    int tiles = partition.tilesX * partition.tilesY;
+    std::vector<int> sideFds(static_cast<std::size_t>(tiles) * SIDES, -1);
+    std::vector<int> controlFds(static_cast<std::size_t>(tiles) * 2, -1);
+    auto tileAt = [&](int x, int y) { return y * partition.tilesX + x; };
+    for (int y = 0; y < partition.tilesY; ++y) {
+        for (int x = 0; x < partition.tilesX; ++x) {
+            int tile = tileAt(x, y);
+            int right = tileAt((x + 1) % partition.tilesX, y);
+            int down = tileAt(x, (y + 1) % partition.tilesY);
+            int horizontal[2];
+            int vertical[2];
+            int control[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, horizontal) != 0 ||
+                ::socketpair(AF_UNIX, SOCK_STREAM, 0, vertical) != 0 ||
+                ::socketpair(AF_UNIX, SOCK_STREAM, 0, control) != 0) {
+                error = std::string("socketpair: ") + std::strerror(errno);
+                closeAll(sideFds);
+                closeAll(controlFds);
+                return false;
+            }
+            sideFds[tile * SIDES + Right] = horizontal[0];
+            sideFds[right * SIDES + Left] = horizontal[1];
+            sideFds[tile * SIDES + Down] = vertical[0];
+            sideFds[down * SIDES + Up] = vertical[1];
+            controlFds[tile * 2] = control[0];
+            controlFds[tile * 2 + 1] = control[1];
+        }
+    }
+
+    std::vector<pid_t> workers(tiles, -1);
+    for (int tile = 0; tile < tiles && error.empty(); ++tile) {
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            error = std::string("fork: ") + std::strerror(errno);
+            break;
+        }
+        if (pid > 0) {
+            workers[tile] = pid;
+            continue;
+        }
+        // рабочий процесс: остаются только его связи; остальные закрываются, чтобы смерть
+        // соседа была видна как закрытое соединение
+        int own[SIDES];
+        for (int side = 0; side < SIDES; ++side) {
+            own[side] = sideFds[tile * SIDES + side];
+            sideFds[tile * SIDES + side] = -1;
+        }
+        int control = controlFds[tile * 2 + 1];
+        controlFds[tile * 2 + 1] = -1;
+        closeAll(sideFds);
+        closeAll(controlFds);
+        // Поле родителя видно и здесь после fork(), но рабочий его не трогает: прямоугольник
+        // приходит по связи, как пришел бы на другой компьютер.
+        int status = 1;
+        try {
+            std::string workerError;
+            int x = tile % partition.tilesX;
+            int y = tile / partition.tilesX;
+            TileWorker worker(partition, x, y, game.getRule(), options.stepsPerExchange);
+            BitGrid local(partition.tileWidth(x) + 2 * worker.getHalo(), partition.tileHeight(y) + 2 * worker.getHalo());
+            if (receiveGrid(control, local)) {
+                worker.load(std::move(local));
+                SocketTransport transport(own);
+                bool done = worker.advance(generations, transport, workerError);
+                if (!done) {
+                    std::fprintf(stderr, "tile %d: %s\n", tile, workerError.c_str());
+                }
+                // сначала готовность, затем клетки: родитель собирает поле, только когда готовы все
+                char ready = done ? 1 : 0;
+                if (writeAll(control, &ready, 1) && done && sendGrid(control, worker.getInterior())) {
+                    status = 0;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "tile %d: %s\n", tile, e.what());
+        }
+        ::close(control);
+        ::_exit(status); // без деструкторов и atexit родителя
+    }
+    closeAll(sideFds);
+    for (int tile = 0; tile < tiles; ++tile) {
+        ::close(controlFds[tile * 2 + 1]);
+        controlFds[tile * 2 + 1] = -1;
+    }
+
+    // рабочим — их прямоугольники с ореолом; в памяти родителя одновременно только один
+    int halo = game.getRule().getRange() * std::max(1, options.stepsPerExchange);
+    auto tileName = [&partition](int tile) {
+        return std::to_string(tile % partition.tilesX) + "," + std::to_string(tile / partition.tilesX);
+    };
+    for (int tile = 0; tile < tiles && error.empty(); ++tile) {
+        BitGrid local = cut(game.getGrid(), partition, tile % partition.tilesX, tile / partition.tilesX, halo);
+        if (!sendGrid(controlFds[tile * 2], local)) {
+            error = "worker for tile " + tileName(tile) + " failed";
+        }
+    }
+    for (int tile = 0; tile < tiles && error.empty(); ++tile) {
+        char ready = 0;
+        if (!readAll(controlFds[tile * 2], &ready, 1) || !ready) {
+            error = "worker for tile " + tileName(tile) + " failed";
+        }
+    }
+    // все досчитали: прямоугольники ложатся прямо в game
+    BitGrid interior;
+    for (int tile = 0; tile < tiles && error.empty(); ++tile) {
+        int x = tile % partition.tilesX;
+        int y = tile / partition.tilesX;
+        if (interior.getWidth() != partition.tileWidth(x) || interior.getHeight() != partition.tileHeight(y)) {
+            interior = BitGrid(partition.tileWidth(x), partition.tileHeight(y));
+        }
+        if (!receiveGrid(controlFds[tile * 2], interior)) {
+            error = "worker for tile " + tileName(tile) + " failed";
+            break;
+        }
+        game.setRegion(partition.rowBegin(y), partition.colBegin(x), interior);
+    }
+    closeAll(controlFds); // при ошибке оставшиеся процессы увидят закрытые связи и выйдут
+    for (pid_t pid : workers) {
+        int status = 0;
+        if (pid > 0 && ::waitpid(pid, &status, 0) == pid && !(WIFEXITED(status) && WEXITSTATUS(status) == 0) &&
+            error.empty()) {
+            error = "worker process failed";
+        }
+    }
+    if (!error.empty()) {
+        return false;
+    }
+    game.setGeneration(game.getGeneration() + generations);
+    return true;
+}
+
+} // namespace Distributed
@@ -1,74 +1,956 @@
 #include "GameOfLifeCore.hpp"
-#include <vector>
-#include <cstdlib>
+#include "Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <utility>
 
 const int GameOfLifeCore::FIELD_WIDTH;
 const int GameOfLifeCore::FIELD_HEIGHT;
 const int GameOfLifeCore::CELL_SIZE;
 const int GameOfLifeCore::RANDOM_FILL_PERCENTAGE;
+const std::uint64_t GameOfLifeCore::DEFAULT_SEED;
+const int GameOfLifeCore::TEMPORAL_DEPTH;
+const int GameOfLifeCore::TEMPORAL_BLOCK_BYTES;
+
+namespace {
+
+// Хэш поля — XOR хэшей всех слов с учетом их места, так что изменение слова меняет хэш
+// ровно на wordHash(старое) ^ wordHash(новое). Перемешивание — финализатор splitmix64.
+inline std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+inline std::uint64_t wordHash(std::size_t index, std::uint64_t word) {
+    return mix(word ^ (index * 0x9E3779B97F4A7C15ull));
+}
+
+// умирающая клетка Generations входит в хэш вместе с возрастом
+inline std::uint64_t ageHash(std::size_t cell, int age) {
+    return mix((cell << 8 | static_cast<std::uint64_t>(age)) ^ 0xD6E8FEB86659FD93ull);
+}
+
+} // namespace
 
 GameOfLifeCore::GameOfLifeCore()
-    : generation(0) {
-    grid.resize(FIELD_HEIGHT, std::vector<bool>(FIELD_WIDTH, false)); // создаем двумерный вектор, заполненный мертвые клетки
+    : GameOfLifeCore(FIELD_WIDTH, FIELD_HEIGHT) {}
+
+GameOfLifeCore::GameOfLifeCore(int width, int height, std::uint64_t seed)
+    : width(width), height(height), grid(width, height), nextGrid(width, height), generation(0),
+      activity(width, height), trackActivity(true), conwayRule(true), gridHash(0),
+      population(0), changedCells(0), seeds(seed) { // поле сразу заполнено мертвыми клетками
+    partDeltas.resize(activity.getTilesY());
+    setKernel(bestKernel());
+    setRule(LifeRule());
     randomizeGrid();
 }
 
 void GameOfLifeCore::randomizeGrid() {
-    for (int i = 0; i < FIELD_HEIGHT; ++i) {
-        for (int j = 0; j < FIELD_WIDTH; ++j) {
-            grid[i][j] = (std::rand() % 100 < RANDOM_FILL_PERCENTAGE);
+    randomizeGrid(seeds.next());
+}
+
+void GameOfLifeCore::setSeed(std::uint64_t seed) {
+    seeds.reseed(seed);
+}
+
+void GameOfLifeCore::randomizeGrid(std::uint64_t seed, int fillPercent) {
+    beginEdit();
+    if (rule.getStates() > 2) {
+        dying.clear();
+    }
+    int words = grid.getWordsPerRow();
+    auto fillBand = [this, seed, fillPercent, words](int band) {
+        HashDelta& part = partDeltas[band];
+        part = HashDelta();
+        int rowEnd = std::min((band + 1) * ActivityTracker::TILE_HEIGHT, height);
+        for (int i = band * ActivityTracker::TILE_HEIGHT; i < rowEnd; ++i) {
+            // свой генератор на строку: результат не зависит от того, как строки поделены между потоками
+            Random random(seed, static_cast<std::uint64_t>(i));
+            std::uint64_t* row = grid.row(i);
+            for (int w = 0; w < words; ++w) {
+                row[w] = random.nextBits(fillPercent);
+            }
+            row[words - 1] &= grid.getLastWordMask();
+            addRowHash(i, part); // строка еще в кэше: отдельный проход rehash() не нужен
+        }
+    };
+    int bands = activity.getTilesY();
+    if (pool) {
+        pool->run(bands, fillBand);
+    } else {
+        for (int band = 0; band < bands; ++band) {
+            fillBand(band);
         }
     }
+    activity.markAll();
+    sumBandHashes();
 }
 
 //устанавливаем состояние конкретной клетки
 void GameOfLifeCore::setCell(int row, int col, bool alive) {
-    if (row >= 0 && row < FIELD_HEIGHT && col >= 0 && col < FIELD_WIDTH) {
-        grid[row][col] = alive;
+    if (row >= 0 && row < height && col >= 0 && col < width) {
+        beginEdit();
+        int w = col / BitGrid::WORD_BITS;
+        std::size_t index = static_cast<std::size_t>(row) * grid.getWordsPerRow() + w;
+        std::uint64_t before = grid.row(row)[w];
+        grid.set(row, col, alive);
+        std::uint64_t after = grid.row(row)[w];
+        gridHash ^= wordHash(index, before) ^ wordHash(index, after);
+        population += static_cast<std::size_t>(__builtin_popcountll(after)) - __builtin_popcountll(before);
+        if (rule.getStates() > 2 && dying.get(row, col)) {
+            std::size_t cell = static_cast<std::size_t>(row) * width + col;
+            gridHash ^= ageHash(cell, ages[cell]);
+            dying.set(row, col, false);
+        }
+        activity.markCell(row, col);
+        // правка поля — не шаг: прежние поколения не повторятся
+        cycles.reset();
+        cycles.record(gridHash, population, generation);
     }
 }
 
-// создаем временную копию текущего состояния поля
+bool GameOfLifeCore::setRegion(int row, int col, const BitGrid& region) {
+    if (row < 0 || col < 0 || row + region.getHeight() > height || col + region.getWidth() > width) {
+        return false;
+    }
+    beginEdit();
+    const int bits = BitGrid::WORD_BITS;
+    for (int r = 0; r < region.getHeight(); ++r) {
+        int y = row + r;
+        // куски строки region, попадающие в одно слово поля
+        for (int c = 0; c < region.getWidth();) {
+            int x = col + c;
+            int w = x / bits;
+            int count = std::min(region.getWidth() - c, (w + 1) * bits - x);
+            std::uint64_t before = grid.row(y)[w];
+            grid.setBits(y, x, count, region.getBits(r, c, count));
+            std::uint64_t after = grid.row(y)[w];
+            if (after != before) {
+                std::size_t index = static_cast<std::size_t>(y) * grid.getWordsPerRow() + w;
+                gridHash ^= wordHash(index, before) ^ wordHash(index, after);
+                population += static_cast<std::size_t>(__builtin_popcountll(after)) - __builtin_popcountll(before);
+                activity.markCell(y, x);
+            }
+            if (rule.getStates() > 2) {
+                std::uint64_t dead = dying.getBits(y, x, count);
+                for (; dead != 0; dead &= dead - 1) {
+                    std::size_t cell = static_cast<std::size_t>(y) * width + x + __builtin_ctzll(dead);
+                    gridHash ^= ageHash(cell, ages[cell]);
+                    activity.markCell(y, x);
+                }
+                dying.setBits(y, x, count, 0);
+            }
+            c += count;
+        }
+    }
+    cycles.reset();
+    cycles.record(gridHash, population, generation);
+    return true;
+}
+
+// считаем следующее поколение во второй буфер выбранным ядром и меняем буферы местами,
+// так что шаг не выделяет память и не копирует поле
 void GameOfLifeCore::update() {
-    std::vector<std::vector<bool>> newGrid = grid;
-    for (int i = 0; i < FIELD_HEIGHT; ++i) {
-        for (int j = 0; j < FIELD_WIDTH; ++j) {
-            int neighbors = countNeighbors(i, j);
-            if (grid[i][j]) { // если клетка живая
-                newGrid[i][j] = (neighbors == 2 || neighbors == 3);
-            } else { // мертвая
-                newGrid[i][j] = (neighbors == 3);
+    Profiler::ScopedTimer timer(Profiler::Metric::Step);
+    if (history) {
+        history->commit(grid, generation, gridHash, population); // правки до шага — своя запись
+    }
+    const ActivityTracker* changedTiles = nullptr; // где поле могло измениться, если известно
+    HashDelta total;
+    auto add = [&total](const HashDelta& part) {
+        total.hash ^= part.hash;
+        total.population += part.population;
+        total.changedCells += part.changedCells;
+    };
+    if (rule.getRange() > 1) {
+        stepLargerThanLife();
+        if (rule.getStates() > 2) {
+            total.hash = advanceDying(0, height, 0, grid.getWordsPerRow());
+        }
+        add(diffRows(0, height, 0, grid.getWordsPerRow()));
+    } else if (trackActivity && rule.isLifeLike()) {
+        // Во втором буфере лежит предыдущее поколение. Плитка, которая вместе с соседями
+        // не менялась, не изменится и сейчас, и в буфере для нее уже правильные данные.
+        activity.beginStep();
+        const std::vector<int>& bands = activity.getActiveBands();
+        auto stepActiveBand = [this, &bands](int index) { stepBand(bands[index]); };
+        if (pool) {
+            pool->run(static_cast<int>(bands.size()), stepActiveBand);
+        } else {
+            for (int index = 0; index < static_cast<int>(bands.size()); ++index) {
+                stepActiveBand(index);
             }
         }
+        for (int band : bands) {
+            add(partDeltas[band]);
+        }
+        activity.endStep();
+        changedTiles = &activity;
+    } else {
+        // каждая полоса читает граничные строки соседей из неизменяемого текущего поля,
+        // так что обмен теневыми строками сводится к чтению общей памяти. Умирающие клетки
+        // и изменение хэша считаются в том же проходе, пока строки полосы в кэше.
+        int stripes = getThreadCount();
+        auto stepStripe = [this, stripes](int stripe) {
+            int rowBegin = height * stripe / stripes;
+            int rowEnd = height * (stripe + 1) / stripes;
+            int words = grid.getWordsPerRow();
+            stepRows(rowBegin, rowEnd, 0, words);
+            std::uint64_t dyingHash = rule.getStates() > 2 ? advanceDying(rowBegin, rowEnd, 0, words) : 0;
+            partDeltas[stripe] = diffRows(rowBegin, rowEnd, 0, words);
+            partDeltas[stripe].hash ^= dyingHash;
+        };
+        if (pool) {
+            pool->run(stripes, stepStripe);
+        } else {
+            stepStripe(0);
+        }
+        for (int stripe = 0; stripe < stripes; ++stripe) {
+            add(partDeltas[stripe]);
+        }
     }
-    grid = newGrid;
+    std::swap(grid, nextGrid); // обмен указателями на буферы
     generation++;
+    gridHash ^= total.hash;
+    population += static_cast<std::size_t>(total.population);
+    changedCells = static_cast<std::size_t>(total.changedCells);
+    if (history) {
+        // во втором буфере теперь все прежнее поколение
+        history->push(nextGrid, grid, changedTiles, generation, gridHash, population);
+    }
+    cycles.record(gridHash, population, generation);
+    Profiler::record(Profiler::Metric::Population, population);
+    Profiler::record(Profiler::Metric::CellsChanged, changedCells);
+}
+
+void GameOfLifeCore::step(int generations, int depth) {
+    if (depth <= 1 || !rule.isLifeLike() || kernel == Kernel::Reference) {
+        for (int i = 0; i < generations; ++i) {
+            update();
+        }
+        return;
+    }
+    Profiler::ScopedTimer timer(Profiler::Metric::Step);
+    if (history) {
+        // промежуточных поколений нет, так что все generations — одна запись
+        history->commit(grid, generation, gridHash, population);
+        history->begin(grid);
+    }
+    // полоса с ореолом в двух буферах занимает TEMPORAL_BLOCK_BYTES, но ореол не больше половины полосы
+    std::size_t rowBytes = static_cast<std::size_t>(grid.getStride()) * sizeof(std::uint64_t);
+    int blockRows = std::max(4 * depth, static_cast<int>(TEMPORAL_BLOCK_BYTES / (2 * rowBytes)));
+    int slots = getThreadCount();
+    if (blockBuffers.size() != static_cast<std::size_t>(2 * slots) || blockBuffers[0].getWidth() != width ||
+        blockBuffers[0].getHeight() != blockRows) {
+        blockBuffers.assign(2 * slots, BitGrid(width, blockRows));
+    }
+
+    std::int64_t changed = 0;
+    bool finished = cycles.isFinished();
+    while (generations > 0) {
+        int blockDepth = std::min(depth, generations);
+        HashDelta part = stepBlocks(blockRows, blockDepth);
+        gridHash ^= part.hash;
+        population += static_cast<std::size_t>(part.population);
+        changed += part.changedCells;
+        generation += blockDepth;
+        generations -= blockDepth;
+        // детектор видит только концы проходов: повтор заметен, но период кратен настоящему
+        cycles.record(gridHash, population, generation);
+    }
+    changedCells = static_cast<std::size_t>(changed);
+    activity.markAll(); // второй буфер отстал больше чем на поколение
+    if (!finished && cycles.getPeriod() > 1) {
+        refinePeriod(blockRows, depth);
+    }
+    if (history) {
+        history->commit(grid, generation, gridHash, population);
+    }
+    Profiler::record(Profiler::Metric::Population, population);
+    Profiler::record(Profiler::Metric::CellsChanged, changedCells);
+}
+
+// Все полосы поля на depth поколений вперед: новое поле — в grid, возвращает изменение
+// хэша и числа клеток. Буферы blockBuffers уже под blockRows строк.
+GameOfLifeCore::HashDelta GameOfLifeCore::stepBlocks(int blockRows, int depth) {
+    int bandRows = std::min(blockRows - 2 * depth, height);
+    int bands = (height + bandRows - 1) / bandRows;
+    blockDeltas.resize(bands);
+    std::atomic<int> nextBand{0};
+    auto stepBands = [&](int slot) {
+        for (int band; (band = nextBand.fetch_add(1, std::memory_order_relaxed)) < bands;) {
+            int rowBegin = band * bandRows;
+            int rowEnd = std::min(rowBegin + bandRows, height);
+            stepBlock(blockBuffers[2 * slot], blockBuffers[2 * slot + 1], rowBegin, rowEnd, depth);
+            // полоса нового поля еще в кэше
+            blockDeltas[band] = diffRows(rowBegin, rowEnd, 0, grid.getWordsPerRow());
+        }
+    };
+    if (pool) {
+        pool->run(getThreadCount(), stepBands);
+    } else {
+        stepBands(0);
+    }
+    HashDelta total;
+    for (const HashDelta& part : blockDeltas) {
+        total.hash ^= part.hash;
+        total.population += part.population;
+        total.changedCells += part.changedCells;
+    }
+    std::swap(grid, nextGrid);
+    return total;
+}
+
+// Повтор найден по концам проходов step() через getPeriod() поколений, так что настоящий
+// период — делитель найденного. Само поле проходит вперед теми же блоками и сверяется с
+// хэшем на делителях по возрастанию: на настоящем периоде оно снова исходное, так что
+// копия не нужна. Это не больше найденного периода поколений и один раз за игру.
+void GameOfLifeCore::refinePeriod(int blockRows, int depth) {
+    int found = cycles.getPeriod();
+    std::uint64_t hash = gridHash;
+    std::int64_t alive = static_cast<std::int64_t>(population);
+    for (int period = 1, done = 0; period <= found; ++period) {
+        if (found % period != 0) {
+            continue;
+        }
+        while (done < period) {
+            int blockDepth = std::min(depth, period - done);
+            HashDelta part = stepBlocks(blockRows, blockDepth);
+            hash ^= part.hash;
+            alive += part.population;
+            done += blockDepth;
+        }
+        if (hash == gridHash && alive == static_cast<std::int64_t>(population)) {
+            cycles.setPeriod(period);
+            return;
+        }
+    }
+}
+
+// Строки полосы [rowBegin, rowEnd) с ореолом в depth строк копируются в from и считаются
+// depth поколений попеременно в from и to. Каждое поколение верных строк на одну меньше
+// с каждой стороны, так что после последнего остаются ровно строки полосы: их последнее
+// поколение пишется сразу в nextGrid.
+void GameOfLifeCore::stepBlock(BitGrid& from, BitGrid& to, int rowBegin, int rowEnd, int depth) {
+    int words = grid.getWordsPerRow();
+    int rows = rowEnd - rowBegin + 2 * depth;
+    for (int r = 0; r < rows; ++r) {
+        int source = ((rowBegin - depth + r) % height + height) % height;
+        std::copy(grid.row(source), grid.row(source) + words, from.row(r));
+    }
+    BitGrid* current = &from;
+    BitGrid* next = &to;
+    for (int t = 1; t <= depth; ++t) {
+        for (int r = t; r < rows - t; ++r) {
+            std::uint64_t* out = t == depth ? nextGrid.row(rowBegin + r - depth) : next->row(r);
+            rowStep(ruleMasks, current->row(r - 1), current->row(r), current->row(r + 1), out, width, 0, words);
+        }
+        std::swap(current, next);
+    }
+}
+
+// пересчитывает активные плитки одной строки плиток и отмечает, какие из них изменились
+void GameOfLifeCore::stepBand(int tileY) {
+    int rowBegin = tileY * ActivityTracker::TILE_HEIGHT;
+    int rowEnd = std::min(rowBegin + ActivityTracker::TILE_HEIGHT, height);
+    int words = grid.getWordsPerRow();
+    HashDelta& bandDelta = partDeltas[tileY];
+    bandDelta = HashDelta();
+
+    int tileX = 0;
+    while (tileX < activity.getTilesX()) {
+        if (!activity.isActive(tileX, tileY)) {
+            ++tileX;
+            continue;
+        }
+        // соседние активные плитки считаются одним куском, чтобы векторным ядрам было где развернуться
+        int runEnd = tileX + 1;
+        while (runEnd < activity.getTilesX() && activity.isActive(runEnd, tileY)) {
+            ++runEnd;
+        }
+        int wordBegin = tileX * ActivityTracker::TILE_WORDS;
+        int wordEnd = std::min(runEnd * ActivityTracker::TILE_WORDS, words);
+        stepRows(rowBegin, rowEnd, wordBegin, wordEnd);
+
+        for (int tile = tileX; tile < runEnd; ++tile) {
+            int tileWordEnd = std::min((tile + 1) * ActivityTracker::TILE_WORDS, words);
+            HashDelta delta = diffRows(rowBegin, rowEnd, tile * ActivityTracker::TILE_WORDS, tileWordEnd);
+            activity.setChanged(tile, tileY, delta.changedCells != 0);
+            bandDelta.hash ^= delta.hash;
+            bandDelta.population += delta.population;
+            bandDelta.changedCells += delta.changedCells;
+        }
+        tileX = runEnd;
+    }
+}
+
+// сравнивает кусок поля с nextGrid: изменившиеся слова дают изменение хэша и числа живых клеток
+GameOfLifeCore::HashDelta GameOfLifeCore::diffRows(int rowBegin, int rowEnd, int wordBegin, int wordEnd) const {
+    HashDelta delta;
+    std::size_t words = static_cast<std::size_t>(grid.getWordsPerRow());
+    for (int i = rowBegin; i < rowEnd; ++i) {
+        const std::uint64_t* before = grid.row(i);
+        const std::uint64_t* after = nextGrid.row(i);
+        for (int w = wordBegin; w < wordEnd; ++w) {
+            if (before[w] != after[w]) {
+                std::size_t index = static_cast<std::size_t>(i) * words + w;
+                delta.hash ^= wordHash(index, before[w]) ^ wordHash(index, after[w]);
+                // рождения и смерти отдельно: два подсчета дают и население, и число изменившихся клеток
+                int born = __builtin_popcountll(after[w] & ~before[w]);
+                int died = __builtin_popcountll(before[w] & ~after[w]);
+                delta.population += born - died;
+                delta.changedCells += born + died;
+            }
+        }
+    }
+    return delta;
+}
+
+// считает строки [rowBegin, rowEnd) и слова [wordBegin, wordEnd) следующего поколения в nextGrid
+void GameOfLifeCore::stepRows(int rowBegin, int rowEnd, int wordBegin, int wordEnd) {
+    if (kernel == Kernel::Lut) {
+        // строки парами: одна выборка дает по две клетки в каждой
+        for (int i = rowBegin; i < rowEnd; i += 2) {
+            const std::uint64_t* above = grid.row(i == 0 ? height - 1 : i - 1);
+            const std::uint64_t* below = grid.row((i + 1) % height);
+            const std::uint64_t* below2 = grid.row((i + 2) % height);
+            std::uint64_t* outBelow = i + 1 < rowEnd ? nextGrid.row(i + 1) : nullptr;
+            LifeKernels::stepWordsLut(*lut, above, grid.row(i), below, below2, nextGrid.row(i), outBelow, width,
+                                      wordBegin, wordEnd);
+        }
+        return;
+    }
+    if (kernel == Kernel::Reference) {
+        // эталонный поклеточный шаг
+        int colEnd = std::min(wordEnd * BitGrid::WORD_BITS, width);
+        for (int i = rowBegin; i < rowEnd; ++i) {
+            for (int j = wordBegin * BitGrid::WORD_BITS; j < colEnd; ++j) {
+                nextGrid.set(i, j, rule.next(grid.get(i, j), countNeighbors(i, j)));
+            }
+        }
+        return;
+    }
+
+    for (int i = rowBegin; i < rowEnd; ++i) {
+        // вертикальное замыкание тора выбирается один раз на строку
+        const std::uint64_t* above = grid.row(i == 0 ? height - 1 : i - 1);
+        const std::uint64_t* below = grid.row(i == height - 1 ? 0 : i + 1);
+        rowStep(ruleMasks, above, grid.row(i), below, nextGrid.row(i), width, wordBegin, wordEnd);
+    }
+}
+
+// Larger than Life: сумма по квадрату (2R+1)x(2R+1) считается скользящими окнами —
+// суммы столбцов по окну строк обновляются при переходе к следующей строке, а сумма
+// квадрата — при сдвиге по строке, так что клетка стоит O(1) при любом радиусе.
+void GameOfLifeCore::stepLargerThanLife() {
+    int range = rule.getRange();
+    int stride = rule.getMaxNeighbors() + 1;
+    const std::uint8_t* table = rule.getTable();
+
+    std::fill(columnSums.begin(), columnSums.end(), 0);
+    for (int d = -range; d <= range; ++d) {
+        addRowToColumns((d + height) % height, 1);
+    }
+    for (int i = 0; i < height; ++i) {
+        // columnSums[j + range] — столбец j; по краям копии столбцов с другой стороны тора,
+        // последний элемент — запас для сдвига окна после последней клетки строки
+        for (int d = 0; d < range; ++d) {
+            columnSums[d] = columnSums[width + d];
+            columnSums[width + range + d] = columnSums[range + d];
+        }
+        int sum = 0;
+        for (int d = 0; d <= 2 * range; ++d) {
+            sum += columnSums[d];
+        }
+
+        const std::uint64_t* row = grid.row(i);
+        std::uint64_t* out = nextGrid.row(i);
+        for (int w = 0; w < grid.getWordsPerRow(); ++w) {
+            std::uint64_t word = row[w];
+            std::uint64_t next = 0;
+            int colEnd = std::min(BitGrid::WORD_BITS, width - w * BitGrid::WORD_BITS);
+            for (int b = 0; b < colEnd; ++b) {
+                int j = w * BitGrid::WORD_BITS + b;
+                int alive = static_cast<int>((word >> b) & 1u);
+                next |= std::uint64_t(table[alive * stride + sum - alive]) << b;
+                sum += columnSums[j + 2 * range + 1] - columnSums[j];
+            }
+            out[w] = next;
+        }
+
+        if (i + 1 < height) {
+            addRowToColumns((i + range + 1) % height, 1);
+            addRowToColumns((i - range + height) % height, -1);
+        }
+    }
+}
+
+// добавляет строку row к суммам столбцов (delta = 1) или вычитает ее (delta = -1)
+void GameOfLifeCore::addRowToColumns(int row, int delta) {
+    const std::uint64_t* words = grid.row(row);
+    int* sums = columnSums.data() + rule.getRange();
+    for (int j = 0; j < width; ++j) {
+        sums[j] += delta * static_cast<int>((words[j / BitGrid::WORD_BITS] >> (j % BitGrid::WORD_BITS)) & 1u);
+    }
+}
+
+// Generations: не выжившая клетка не умирает сразу, а проходит состояния 2..states-1.
+// Такие клетки не считаются соседями (в grid их нет) и не дают родиться новой клетке на своем месте.
+// Возвращает изменение хэша от возрастов умирающих клеток.
+std::uint64_t GameOfLifeCore::advanceDying(int rowBegin, int rowEnd, int wordBegin, int wordEnd) {
+    int states = rule.getStates();
+    std::uint64_t hash = 0;
+    for (int i = rowBegin; i < rowEnd; ++i) {
+        const std::uint64_t* before = grid.row(i);
+        std::uint64_t* after = nextGrid.row(i);
+        std::uint64_t* dyingRow = dying.row(i);
+        std::size_t rowCell = static_cast<std::size_t>(i) * width;
+        std::uint8_t* rowAges = ages.data() + rowCell;
+        for (int w = wordBegin; w < wordEnd; ++w) {
+            std::uint64_t old = dyingRow[w];
+            after[w] &= ~old;
+            std::uint64_t fresh = before[w] & ~after[w];
+            std::uint64_t next = old | fresh;
+            // перебираются только умирающие клетки, которых обычно немного
+            for (std::uint64_t bits = old; bits != 0; bits &= bits - 1) {
+                int col = w * BitGrid::WORD_BITS + __builtin_ctzll(bits);
+                std::uint8_t& age = rowAges[col];
+                hash ^= ageHash(rowCell + col, age);
+                if (++age == states) {
+                    age = 0;
+                    next &= ~(std::uint64_t(1) << (col % BitGrid::WORD_BITS));
+                } else {
+                    hash ^= ageHash(rowCell + col, age);
+                }
+            }
+            for (std::uint64_t bits = fresh; bits != 0; bits &= bits - 1) {
+                int col = w * BitGrid::WORD_BITS + __builtin_ctzll(bits);
+                rowAges[col] = 2;
+                hash ^= ageHash(rowCell + col, 2);
+            }
+            dyingRow[w] = next;
+        }
+    }
+    return hash;
+}
+
+// добавляет к part хэш и живые клетки строки row (и возрасты ее умирающих клеток)
+void GameOfLifeCore::addRowHash(int row, HashDelta& part) const {
+    std::size_t words = static_cast<std::size_t>(grid.getWordsPerRow());
+    std::size_t first = static_cast<std::size_t>(row) * words;
+    const std::uint64_t* cells = grid.row(row);
+    for (std::size_t w = 0; w < words; ++w) {
+        part.hash ^= wordHash(first + w, cells[w]);
+        part.population += __builtin_popcountll(cells[w]);
+    }
+    if (rule.getStates() > 2) {
+        const std::uint64_t* dyingRow = dying.row(row);
+        for (std::size_t w = 0; w < words; ++w) {
+            for (std::uint64_t bits = dyingRow[w]; bits != 0; bits &= bits - 1) {
+                std::size_t cell = static_cast<std::size_t>(row) * width + w * BitGrid::WORD_BITS + __builtin_ctzll(bits);
+                part.hash ^= ageHash(cell, ages[cell]);
+            }
+        }
+    }
+}
+
+// полосы строк плиток считаются параллельно, как шаг: на больших полях это заметная часть сброса
+void GameOfLifeCore::rehash() {
+    auto hashBand = [this](int band) {
+        HashDelta& part = partDeltas[band];
+        part = HashDelta();
+        int rowEnd = std::min((band + 1) * ActivityTracker::TILE_HEIGHT, height);
+        for (int i = band * ActivityTracker::TILE_HEIGHT; i < rowEnd; ++i) {
+            addRowHash(i, part);
+        }
+    };
+    int bands = activity.getTilesY();
+    if (pool) {
+        pool->run(bands, hashBand);
+    } else {
+        for (int band = 0; band < bands; ++band) {
+            hashBand(band);
+        }
+    }
+    sumBandHashes();
+}
+
+// собирает хэш поля из partDeltas всех полос; история повторов начинается заново
+void GameOfLifeCore::sumBandHashes() {
+    gridHash = 0;
+    population = 0;
+    for (int band = 0; band < activity.getTilesY(); ++band) {
+        gridHash ^= partDeltas[band].hash;
+        population += static_cast<std::size_t>(partDeltas[band].population);
+    }
+    cycles.reset();
+    cycles.record(gridHash, population, generation);
+}
+
+bool GameOfLifeCore::isKernelSupported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Avx2:
+        return LifeKernels::avx2Available();
+    case Kernel::Avx512:
+        return LifeKernels::avx512Available();
+    default:
+        return true;
+    }
+}
+
+GameOfLifeCore::Kernel GameOfLifeCore::bestKernel() {
+    // CPUID проверяется один раз за время работы программы
+    static const Kernel best = isKernelSupported(Kernel::Avx512) ? Kernel::Avx512
+                             : isKernelSupported(Kernel::Avx2)   ? Kernel::Avx2
+                                                                 : Kernel::Swar;
+    return best;
+}
+
+bool GameOfLifeCore::setKernel(Kernel newKernel) {
+    if (!isKernelSupported(newKernel)) {
+        return false;
+    }
+    kernel = newKernel;
+    updateRowStep();
+    updateLut();
+    return true;
+}
+
+void GameOfLifeCore::updateRowStep() {
+    // для B3/S23 формула зашита в ядро, для остальных правил ядро выбирает по ruleMasks
+    switch (kernel) {
+    case Kernel::Avx2:
+        rowStep = conwayRule ? LifeKernels::conwayStep<LifeKernels::stepWordsAvx2> : LifeKernels::stepWordsRuleAvx2;
+        break;
+    case Kernel::Avx512:
+        rowStep = conwayRule ? LifeKernels::conwayStep<LifeKernels::stepWordsAvx512>
+                             : LifeKernels::stepWordsRuleAvx512;
+        break;
+    default:
+        rowStep = conwayRule ? LifeKernels::conwayStep<LifeKernels::stepWords> : LifeKernels::stepWordsRule;
+        break;
+    }
+}
+
+void GameOfLifeCore::updateLut() {
+    if (kernel != Kernel::Lut || rule.getRange() != 1) {
+        return; // таблица строится, только когда ей пользуются
+    }
+    if (conwayRule) {
+        lut = &LifeKernels::CONWAY_LUT;
+        return;
+    }
+    unsigned birth = 0;
+    unsigned survive = 0;
+    for (int neighbors = 0; neighbors <= 8; ++neighbors) {
+        birth |= rule.next(false, neighbors) ? 1u << neighbors : 0;
+        survive |= rule.next(true, neighbors) ? 1u << neighbors : 0;
+    }
+    if (!ruleLut) {
+        ruleLut = std::make_unique<LifeKernels::LutTable>();
+    }
+    LifeKernels::fillLutTable(*ruleLut, birth, survive);
+    lut = ruleLut.get();
+}
+
+GameOfLifeCore::Kernel GameOfLifeCore::getKernel() const {
+    return kernel;
+}
+
+void GameOfLifeCore::setThreadCount(int threads) {
+    threads = std::max(1, threads);
+    if (threads == getThreadCount()) {
+        return;
+    }
+    // потоки создаются здесь один раз и живут до следующей смены числа потоков
+    pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+    partDeltas.resize(std::max<std::size_t>(partDeltas.size(), static_cast<std::size_t>(threads)));
+}
+
+int GameOfLifeCore::getThreadCount() const {
+    return pool ? pool->getThreadCount() : 1;
+}
+
+void GameOfLifeCore::setActivityTracking(bool enabled) {
+    trackActivity = enabled;
+    // без учета плиток шаг пересчитывает все поле, так что изменившимся считается все
+    activity.markAll();
+}
+
+bool GameOfLifeCore::setRule(const LifeRule& newRule) {
+    int side = 2 * newRule.getRange() + 1;
+    if (side > width || side > height) {
+        return false; // на таком торе окрестность накрыла бы клетку дважды
+    }
+    rule = newRule;
+    conwayRule = rule.isConway();
+    if (rule.getRange() == 1) {
+        for (int alive = 0; alive < 2; ++alive) {
+            for (int neighbors = 0; neighbors <= 8; ++neighbors) {
+                ruleMasks.next[alive][neighbors] = rule.next(alive != 0, neighbors) ? ~std::uint64_t(0) : 0;
+            }
+        }
+    }
+    updateRowStep();
+    updateLut();
+    // дополнительная память нужна только правилам, которые ей пользуются
+    columnSums.assign(rule.getRange() > 1 ? width + 2 * rule.getRange() + 1 : 0, 0);
+    if (rule.getStates() > 2) {
+        dying = BitGrid(width, height);
+        ages.assign(static_cast<std::size_t>(width) * height, 0);
+    } else {
+        dying = BitGrid();
+        ages.clear();
+    }
+    // плитки предыдущего шага посчитаны по старому правилу, а прежняя история — по старой динамике
+    activity.markAll();
+    rehash();
+    return true;
+}
+
+bool GameOfLifeCore::setRule(const std::string& rulestring) {
+    LifeRule parsed;
+    return LifeRule::parse(rulestring, parsed) && setRule(parsed);
+}
+
+const LifeRule& GameOfLifeCore::getRule() const {
+    return rule;
+}
+
+bool GameOfLifeCore::getActivityTracking() const {
+    return trackActivity;
+}
+
+const ActivityTracker& GameOfLifeCore::getActivity() const {
+    return activity;
 }
 
 // подсчитывает количество живых соседей для указанной клетки
-int GameOfLifeCore::countNeighbors(int x, int y) {
+int GameOfLifeCore::countNeighbors(int x, int y) const {
+    // соседние строки и столбцы с учетом тороидального замыкания, без деления по модулю
+    const int rows[3] = {x == 0 ? height - 1 : x - 1, x, x == height - 1 ? 0 : x + 1};
+    const int cols[3] = {y == 0 ? width - 1 : y - 1, y, y == width - 1 ? 0 : y + 1};
+
     int count = 0;
     // проверяем все 8 соседних клеток
-    for (int i = -1; i <= 1; ++i) {
-        for (int j = -1; j <= 1; ++j) {
-            if (i == 0 && j == 0) continue;
-            int nx = (x + i + FIELD_HEIGHT) % FIELD_HEIGHT;
-            int ny = (y + j + FIELD_WIDTH) % FIELD_WIDTH;
-            if (grid[nx][ny]) count++;
+    for (int i = 0; i < 3; ++i) {
+        const std::uint64_t* row = grid.row(rows[i]);
+        for (int j = 0; j < 3; ++j) {
+            if (i == 1 && j == 1) continue;
+            count += (row[cols[j] / BitGrid::WORD_BITS] >> (cols[j] % BitGrid::WORD_BITS)) & 1u;
         }
     }
     return count;
 }
 
-const std::vector<std::vector<bool>>& GameOfLifeCore::getGrid() const {
+const BitGrid& GameOfLifeCore::getGrid() const {
     return grid;
 }
 
+bool GameOfLifeCore::setGrid(const BitGrid& newGrid) {
+    if (newGrid.getWidth() != width || newGrid.getHeight() != height) {
+        return false;
+    }
+    beginEdit();
+    grid = newGrid; // размеры совпадают, так что память не выделяется
+    if (rule.getStates() > 2) {
+        dying.clear();
+    }
+    activity.markAll();
+    rehash();
+    return true;
+}
+
+void GameOfLifeCore::loadGrid(BitGrid&& newGrid) {
+    bool resized = newGrid.getWidth() != width || newGrid.getHeight() != height;
+    if (resized) {
+        width = newGrid.getWidth();
+        height = newGrid.getHeight();
+        // старые буферы освобождаются до выделения новых, чтобы большое поле не занимало память трижды
+        nextGrid = BitGrid();
+        grid = std::move(newGrid);
+        nextGrid = BitGrid(width, height);
+        activity = ActivityTracker(width, height);
+        partDeltas.resize(std::max(activity.getTilesY(), getThreadCount()));
+        if (!setRule(rule)) {
+            setRule(LifeRule()); // окрестность правила не помещается на новом поле
+        }
+    } else {
+        beginEdit();
+        grid = std::move(newGrid);
+    }
+    if (rule.getStates() > 2) {
+        dying.clear();
+    }
+    activity.markAll();
+    rehash();
+    if (resized && history) {
+        history->clear(grid, generation); // изменения прежнего размера к новому полю не применить
+    }
+}
+
+int GameOfLifeCore::getCellState(int row, int col) const {
+    if (grid.get(row, col)) {
+        return 1;
+    }
+    if (rule.getStates() > 2 && dying.get(row, col)) {
+        return ages[static_cast<std::size_t>(row) * width + col];
+    }
+    return 0;
+}
+
 int GameOfLifeCore::getGeneration() const {
     return generation;
 }
 
+void GameOfLifeCore::setGeneration(int newGeneration) {
+    beginEdit(); // новый номер отменяется вместе с правками поля
+    generation = newGeneration;
+    cycles.reset(); // история хранит номера поколений
+    cycles.record(gridHash, population, generation);
+}
+
+std::uint64_t GameOfLifeCore::getHash() const {
+    return gridHash;
+}
+
+std::size_t GameOfLifeCore::getPopulation() const {
+    return population;
+}
+
+std::size_t GameOfLifeCore::getChangedCells() const {
+    return changedCells;
+}
+
+const CycleDetector& GameOfLifeCore::getCycles() const {
+    return cycles;
+}
+
+bool GameOfLifeCore::isFinished() const {
+    return cycles.isFinished();
+}
+
+int GameOfLifeCore::getWidth() const {
+    return width;
+}
+
+int GameOfLifeCore::getHeight() const {
+    return height;
+}
+
 void GameOfLifeCore::reset() {
     generation = 0;
     randomizeGrid();
+}
+
+void GameOfLifeCore::beginEdit() {
+    if (history) {
+        history->begin(grid);
+    }
+}
+
+// Перемотка меняет поле по словам: хэш, число живых клеток и плитки обновляются по каждому
+// изменившемуся слову, так что шаг назад стоит столько, сколько слов изменилось за поколение.
+class GameOfLifeCore::HistorySink : public GenerationHistory::Sink {
+public:
+    explicit HistorySink(GameOfLifeCore& core) : core(core) {}
+
+    void xorWord(std::size_t index, std::uint64_t bits) override {
+        int words = core.grid.getWordsPerRow();
+        int row = static_cast<int>(index / words);
+        int w = static_cast<int>(index % words);
+        std::uint64_t before = core.grid.row(row)[w];
+        std::uint64_t after = before ^ bits;
+        core.grid.row(row)[w] = after;
+        core.gridHash ^= wordHash(index, before) ^ wordHash(index, after);
+        core.population += static_cast<std::size_t>(__builtin_popcountll(after)) - __builtin_popcountll(before);
+        core.activity.markCell(row, w * BitGrid::WORD_BITS);
+    }
+
+    // Хэш и население берутся из кадра; слова сравниваются без хэширования, и отмечаются
+    // только плитки, где поле отличается от кадра.
+    void load(const BitGrid& state, std::uint64_t hash, std::size_t population) override {
+        int words = core.grid.getWordsPerRow();
+        for (int row = 0; row < core.height; ++row) {
+            std::uint64_t* current = core.grid.row(row);
+            const std::uint64_t* target = state.row(row);
+            for (int w = 0; w < words; ++w) {
+                if (current[w] != target[w]) {
+                    current[w] = target[w];
+                    core.activity.markCell(row, w * BitGrid::WORD_BITS);
+                }
+            }
+        }
+        core.gridHash = hash;
+        core.population = population;
+    }
+
+private:
+    GameOfLifeCore& core;
+};
+
+void GameOfLifeCore::seekHistory(int entry) {
+    HistorySink sink(*this);
+    history->seek(entry, sink);
+    generation = history->getGeneration(entry);
+    changedCells = 0;
+    if (rule.getStates() > 2) {
+        dying.clear(); // возраст умирающих клеток в истории не хранится
+        rehash();
+    } else {
+        // прежние поколения снова впереди, так что история повторов начинается заново
+        cycles.reset();
+        cycles.record(gridHash, population, generation);
+    }
+}
+
+void GameOfLifeCore::setHistoryBudget(std::size_t bytes) {
+    if (bytes == 0) {
+        history.reset();
+    } else if (history) {
+        history->setBudget(bytes);
+    } else {
+        history = std::make_unique<GenerationHistory>(bytes);
+        history->clear(grid, generation);
+    }
+}
+
+const GenerationHistory* GameOfLifeCore::getHistory() const {
+    return history.get();
+}
+
+void GameOfLifeCore::commitEdit() {
+    if (history) {
+        history->commit(grid, generation, gridHash, population);
+    }
+}
+
+bool GameOfLifeCore::undo() {
+    commitEdit();
+    if (!history || history->getPosition() == 0) {
+        return false;
+    }
+    seekHistory(history->getPosition() - 1);
+    return true;
+}
+
+bool GameOfLifeCore::redo() {
+    commitEdit();
+    if (!history || history->getPosition() + 1 >= history->size()) {
+        return false;
+    }
+    seekHistory(history->getPosition() + 1);
+    return true;
+}
+
+bool GameOfLifeCore::seekGeneration(int target) {
+    commitEdit();
+    if (!history) {
+        return false;
+    }
+    seekHistory(history->find(target));
+    return true;
 }
\ No newline at end of file
@@ -1,18 +1,69 @@
 #include "GameOfLifeRenderer.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <thread>
+
+namespace {
+
+// цвет в порядке байтов RGBA, как его ждет sf::Texture::update()
+sf::Uint32 packColor(const sf::Color& color) {
+    sf::Uint32 packed;
+    const sf::Uint8 bytes[4] = {color.r, color.g, color.b, color.a};
+    std::memcpy(&packed, bytes, sizeof(packed));
+    return packed;
+}
+
+std::string formatNumber(double value, int digits) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return buffer;
+}
+
+// одна строка оверлея профилировщика: процентили за последний интервал
+std::string profileLine(const Profiler::Summary& interval, const Profiler::Summary& total, Profiler::Metric metric,
+                        float seconds) {
+    const Profiler::Histogram& histogram = interval[metric];
+    std::string line = std::string(Profiler::metricName(metric)) + ": ";
+    if (Profiler::isDuration(metric)) {
+        line += "p50 " + formatNumber(histogram.percentile(0.5) / 1e6, 3) + " ms, p99 " +
+                formatNumber(histogram.percentile(0.99) / 1e6, 3) + " ms, " +
+                formatNumber(histogram.count / seconds, 0) + "/s";
+    } else if (metric == Profiler::Metric::Population) {
+        line += std::to_string(total.last[static_cast<int>(metric)]);
+    } else {
+        line += "p50 " + std::to_string(histogram.percentile(0.5)) + ", p99 " + std::to_string(histogram.percentile(0.99));
+    }
+    return line;
+}
+
+const char* schedulerModeName(Scheduler::Mode mode) {
+    switch (mode) {
+    case Scheduler::Mode::FixedRate: return "fixed";
+    case Scheduler::Mode::FrameSkip: return "frame skip";
+    case Scheduler::Mode::Uncapped: return "uncapped";
+    }
+    return "";
+}
+
+} // namespace
 
 GameOfLifeRenderer::GameOfLifeRenderer(GameOfLifeCore& g)
-    : game(g),
-      window(sf::VideoMode::getDesktopMode(), "Game of Life", sf::Style::Fullscreen),
+    : window(sf::VideoMode::getDesktopMode(), "Game of Life", sf::Style::Fullscreen),
+      game(g),
+      simulation(g),
       state{},
       resources{} {
     
     window.setVerticalSyncEnabled(false);
+    window.setFramerateLimit(UIConstants::FRAME_RATE_LIMIT);
 
     sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
     state.WINDOW_WIDTH = desktop.width;
     state.WINDOW_HEIGHT = desktop.height;
+    resetCamera();
 
     if (!resources.font.loadFromFile("/mnt/c/project1/PROJECT/resources/OpenSans-Regular.ttf")) {
         std::cerr << "Error: Could not load font 'OpenSans-Regular.ttf'\n";
@@ -58,113 +109,440 @@ GameOfLifeRenderer::GameOfLifeRenderer(GameOfLifeCore& g)
 }
 
 void GameOfLifeRenderer::run() {
+    Profiler::setThreadName("render");
+    simulation.setMode(state.schedulerMode);
+    simulation.setTargetRate(state.targetRate);
+    simulation.start();
+
     while (window.isOpen()) {
+        Profiler::ScopedTimer frameTimer(Profiler::Metric::Frame);
         handleEvents();
-        
-        if (state.showMainMenu || state.showRules || state.showControl) {
+
+        bool inMenu = state.showMainMenu || state.showRules || state.showControl;
+        simulation.setRunning(!inMenu && !state.isPaused);
+
+        if (inMenu) {
             renderMenu();
         } else {
-            if (!state.isPaused) {
-                game.update();
-            }
-
             if (state.isMouseLeftPressed || state.isMouseRightPressed) {
                 handleMouseDrawing();
             }
 
+            simulation.acquireSnapshot(); // берем последнее готовое поколение, если оно есть
+            updateStats();
             renderGame();
-            std::this_thread::sleep_for(std::chrono::milliseconds(state.delay));
         }
     }
+
+    simulation.stop();
 }
 
 void GameOfLifeRenderer::handleMouseDrawing() {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    int playableWidth = FIELD_WIDTH * CELL_SIZE;
-    int playableHeight = FIELD_HEIGHT * CELL_SIZE;
-    int offsetX = (state.WINDOW_WIDTH - playableWidth) / 2;
-    int offsetY = (state.WINDOW_HEIGHT - playableHeight) / UIConstants::FIELD_OFFSET_Y_RATIO;
-
-    if (mousePos.x >= offsetX && mousePos.x <= offsetX + playableWidth &&
-        mousePos.y >= offsetY && mousePos.y <= offsetY + playableHeight) {
-        
-        int col = (mousePos.x - offsetX) / CELL_SIZE;
-        int row = (mousePos.y - offsetY) / CELL_SIZE;
-
-        if (row >= 0 && row < FIELD_HEIGHT && col >= 0 && col < FIELD_WIDTH) {
-            auto& grid = const_cast<std::vector<std::vector<bool>>&>(game.getGrid());
-
-            if (row != state.lastRow || col != state.lastCol) {
-                if (state.isMouseLeftPressed) {
-                    grid[row][col] = state.drawMode;
-                } else if (state.isMouseRightPressed) {
-                    grid[row][col] = false;
-                }
-                state.lastRow = row;
-                state.lastCol = col;
+    int row;
+    int col;
+    if (screenToCell(sf::Mouse::getPosition(window), row, col)) {
+        if (row != state.lastRow || col != state.lastCol) {
+            if (state.isMouseLeftPressed) {
+                editCell(row, col, state.drawMode);
+            } else if (state.isMouseRightPressed) {
+                editCell(row, col, false);
             }
+            state.lastRow = row;
+            state.lastCol = col;
         }
     }
 }
 
+// клетка под точкой окна с учетом камеры; false, если точка вне поля
+bool GameOfLifeRenderer::screenToCell(sf::Vector2i pos, int& row, int& col) const {
+    double x = std::floor(camera.left + pos.x / camera.zoom);
+    double y = std::floor(camera.top + pos.y / camera.zoom);
+    if (x < 0 || y < 0 || x >= game.getWidth() || y >= game.getHeight()) {
+        return false;
+    }
+    row = static_cast<int>(y);
+    col = static_cast<int>(x);
+    return true;
+}
+
+// поле целиком в окне: по умолчанию CELL_SIZE пикселей на клетку, как раньше
+void GameOfLifeRenderer::resetCamera() {
+    double width = game.getWidth();
+    double height = game.getHeight();
+    camera.zoom = CELL_SIZE;
+    if (width * camera.zoom > state.WINDOW_WIDTH || height * camera.zoom > state.WINDOW_HEIGHT) {
+        camera.zoom = std::max(std::min(state.WINDOW_WIDTH / width, state.WINDOW_HEIGHT / height),
+                               UIConstants::MIN_ZOOM);
+    }
+    double offsetX = (state.WINDOW_WIDTH - width * camera.zoom) / 2;
+    double offsetY = (state.WINDOW_HEIGHT - height * camera.zoom) / UIConstants::FIELD_OFFSET_Y_RATIO;
+    camera.left = -offsetX / camera.zoom;
+    camera.top = -offsetY / camera.zoom;
+}
+
+// масштабирует вокруг точки окна anchor: клетка под ней остается на месте
+void GameOfLifeRenderer::zoomCamera(double factor, sf::Vector2i anchor) {
+    double zoom = std::min(std::max(camera.zoom * factor, UIConstants::MIN_ZOOM), UIConstants::MAX_ZOOM);
+    double anchorX = camera.left + anchor.x / camera.zoom;
+    double anchorY = camera.top + anchor.y / camera.zoom;
+    camera.zoom = zoom;
+    camera.left = anchorX - anchor.x / zoom;
+    camera.top = anchorY - anchor.y / zoom;
+}
+
+void GameOfLifeRenderer::panCamera(double dx, double dy) {
+    camera.left += dx / camera.zoom;
+    camera.top += dy / camera.zoom;
+}
+
 bool GameOfLifeRenderer::isInside(sf::Vector2i pos, float x, float y, float w, float h) {
     return pos.x >= x && pos.x <= x + w && pos.y >= y && pos.y <= y + h;
 }
 
 void GameOfLifeRenderer::renderGame() {
-    window.clear();
-    window.draw(resources.menuBackgroundSprite);
-
-    int playableWidth = FIELD_WIDTH * CELL_SIZE;
-    int playableHeight = FIELD_HEIGHT * CELL_SIZE;
-    int offsetX = (state.WINDOW_WIDTH - playableWidth) / 2;
-    int offsetY = (state.WINDOW_HEIGHT - playableHeight) / UIConstants::FIELD_OFFSET_Y_RATIO;
-
-    sf::RectangleShape border(sf::Vector2f(playableWidth, playableHeight));
-    border.setPosition(offsetX, offsetY);
-    border.setFillColor(sf::Color::Transparent);
-    border.setOutlineColor(sf::Color::Black);
-    border.setOutlineThickness(UIConstants::FIELD_BORDER_THICKNESS);
-    window.draw(border);
-
-    const auto& grid = game.getGrid();
-    for (int i = 0; i < FIELD_HEIGHT; ++i) {
-        for (int j = 0; j < FIELD_WIDTH; ++j) {
-            sf::RectangleShape cell(sf::Vector2f(CELL_SIZE - 1, CELL_SIZE - 1));
-            cell.setPosition(offsetX + j * CELL_SIZE, offsetY + i * CELL_SIZE);
-            cell.setFillColor(grid[i][j] ? sf::Color::Green : sf::Color::Black);
-            window.draw(cell);
+    {
+        // без ожидания display(): оно показывает ограничение частоты кадров, а не работу
+        Profiler::ScopedTimer renderTimer(Profiler::Metric::Render);
+        drawCalls = 0;
+        window.clear();
+        draw(resources.menuBackgroundSprite);
+
+        sf::RectangleShape border(sf::Vector2f(game.getWidth() * camera.zoom, game.getHeight() * camera.zoom));
+        border.setPosition(-camera.left * camera.zoom, -camera.top * camera.zoom);
+        border.setFillColor(sf::Color::Transparent);
+        border.setOutlineColor(sf::Color::Black);
+        border.setOutlineThickness(UIConstants::FIELD_BORDER_THICKNESS);
+        draw(border);
+
+        renderField();
+
+        if (state.isPaused && !state.showMainMenu && !state.showRules && !state.showControl) {
+            renderCellHighlight();
         }
+
+        renderInfoPanel();
+        Profiler::record(Profiler::Metric::DrawCalls, drawCalls);
     }
+    window.display();
+}
+
+void GameOfLifeRenderer::draw(const sf::Drawable& drawable) {
+    ++drawCalls;
+    window.draw(drawable);
+}
 
-    if (state.isPaused && !state.showMainMenu && !state.showRules && !state.showControl) {
-        renderCellHighlight(offsetX, offsetY);
+// Крупный масштаб рисуется из текстуры окна вокруг видимой части, мелкий — из текстуры
+// размером с экран. В обоих случаях работа и память за кадр ограничены пикселями экрана.
+void GameOfLifeRenderer::renderField() {
+    if (camera.zoom < 1 || !renderFieldTexture()) {
+        renderFieldOverview();
     }
+}
 
-    renderInfoPanel();
-    window.display();
+// Текстуры окна создаются заново только при смене размера поля или окна. false, если
+// видеокарта не дала текстуру такого размера.
+bool GameOfLifeRenderer::createFieldTextures(int width, int height, int tilesX, int tilesY) {
+    field.width = width;
+    field.height = height;
+    field.tilesX = tilesX;
+    field.tilesY = tilesY;
+    field.originTileX = 0;
+    field.originTileY = 0;
+    field.uploadAll = true;
+    int textureWidth = std::min(tilesX * ActivityTracker::TILE_WIDTH, width);
+    int textureHeight = std::min(tilesY * ActivityTracker::TILE_HEIGHT, height);
+    field.failed = !field.cellsTexture.create(textureWidth, textureHeight);
+    if (field.failed) {
+        return false;
+    }
+    int fieldTiles = ((width + ActivityTracker::TILE_WIDTH - 1) / ActivityTracker::TILE_WIDTH) *
+                     ((height + ActivityTracker::TILE_HEIGHT - 1) / ActivityTracker::TILE_HEIGHT);
+    field.drawnTiles.assign(fieldTiles, 0);
+    field.pixels.assign(static_cast<std::size_t>(textureWidth) * ActivityTracker::TILE_HEIGHT, 0);
+    field.cellsTexture.setSmooth(false);
+    field.cellsSprite.setTexture(field.cellsTexture, true);
+
+    // одна клетка сетки: прозрачная внутри, с линией в правом столбце и нижней строке
+    if (field.gridLinesTexture.getSize().x == 0) {
+        std::vector<sf::Uint32> line(CELL_SIZE * CELL_SIZE, packColor(sf::Color::Transparent));
+        for (int k = 0; k < CELL_SIZE; ++k) {
+            line[(CELL_SIZE - 1) * CELL_SIZE + k] = packColor(sf::Color::Black);
+            line[k * CELL_SIZE + CELL_SIZE - 1] = packColor(sf::Color::Black);
+        }
+        if (field.gridLinesTexture.create(CELL_SIZE, CELL_SIZE)) {
+            field.gridLinesTexture.update(reinterpret_cast<const sf::Uint8*>(line.data()));
+            field.gridLinesTexture.setRepeated(true);
+            field.gridLinesSprite.setTexture(field.gridLinesTexture);
+        }
+    }
+    return true;
 }
 
-void GameOfLifeRenderer::renderCellHighlight(int offsetX, int offsetY) {
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    int playableWidth = FIELD_WIDTH * CELL_SIZE;
-    int playableHeight = FIELD_HEIGHT * CELL_SIZE;
-
-    if (mousePos.x >= offsetX && mousePos.x <= offsetX + playableWidth &&
-        mousePos.y >= offsetY && mousePos.y <= offsetY + playableHeight) {
-
-        int col = (mousePos.x - offsetX) / CELL_SIZE;
-        int row = (mousePos.y - offsetY) / CELL_SIZE;
-
-        if (row >= 0 && row < FIELD_HEIGHT && col >= 0 && col < FIELD_WIDTH) {
-            sf::RectangleShape highlight(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-            highlight.setPosition(offsetX + col * CELL_SIZE, offsetY + row * CELL_SIZE);
-            highlight.setFillColor(state.drawMode ?
-                sf::Color(255, 255, 255, UIConstants::HIGHLIGHT_ALPHA_ADD) :
-                sf::Color(255, 0, 0, UIConstants::HIGHLIGHT_ALPHA_REMOVE));
-            window.draw(highlight);
+// Загружает в текстуру видимые плитки, изменившиеся с прошлого кадра, и рисует поле двумя
+// вызовами draw(). На паузе и на устоявшемся поле загружать нечего, и кадр стоит только
+// композиции. false, если текстуры нет: тогда поле рисует обзор.
+bool GameOfLifeRenderer::renderFieldTexture() {
+    const SimulationThread::Snapshot& snapshot = simulation.getSnapshot();
+    const BitGrid& grid = snapshot.grid;
+    const int tileWidth = ActivityTracker::TILE_WIDTH;
+    const int tileHeight = ActivityTracker::TILE_HEIGHT;
+    int fieldTilesX = (grid.getWidth() + tileWidth - 1) / tileWidth;
+    int fieldTilesY = (grid.getHeight() + tileHeight - 1) / tileHeight;
+    // при масштабе от 1 видно не больше клеток, чем пикселей окна: плитки экрана и по одной с краев
+    int tilesX = std::min(fieldTilesX, (state.WINDOW_WIDTH + tileWidth - 1) / tileWidth + 2);
+    int tilesY = std::min(fieldTilesY, (state.WINDOW_HEIGHT + tileHeight - 1) / tileHeight + 2);
+    if (field.width != grid.getWidth() || field.height != grid.getHeight() || field.tilesX != tilesX ||
+        field.tilesY != tilesY) {
+        createFieldTextures(grid.getWidth(), grid.getHeight(), tilesX, tilesY);
+    }
+    if (field.failed) {
+        return false;
+    }
+
+    // видимые плитки; окно сдвигается, только когда они из него выходят
+    auto visible = [](double first, double count, int tileSize, int tiles, int& begin, int& end) {
+        begin = std::min(std::max(static_cast<int>(std::floor(first / tileSize)), 0), tiles);
+        end = std::min(std::max(static_cast<int>(std::ceil((first + count) / tileSize)), 0), tiles);
+    };
+    int visibleX0, visibleX1, visibleY0, visibleY1;
+    visible(camera.left, state.WINDOW_WIDTH / camera.zoom, tileWidth, fieldTilesX, visibleX0, visibleX1);
+    visible(camera.top, state.WINDOW_HEIGHT / camera.zoom, tileHeight, fieldTilesY, visibleY0, visibleY1);
+    if (visibleX0 >= visibleX1 || visibleY0 >= visibleY1) {
+        return true; // поле за пределами окна
+    }
+    auto recenter = [](int begin, int end, int window, int tiles, int& origin) {
+        if (begin >= origin && end <= origin + window) {
+            return false;
+        }
+        origin = std::min(std::max(begin - (window - (end - begin)) / 2, 0), tiles - window);
+        return true;
+    };
+    bool movedX = recenter(visibleX0, visibleX1, field.tilesX, fieldTilesX, field.originTileX);
+    bool movedY = recenter(visibleY0, visibleY1, field.tilesY, fieldTilesY, field.originTileY);
+    if (movedX || movedY) {
+        field.uploadAll = true;
+    }
+
+    if (field.uploadAll || field.drawnVersion != snapshot.version) {
+        Profiler::ScopedTimer uploadTimer(Profiler::Metric::Upload);
+        int tileXEnd = field.originTileX + field.tilesX;
+        for (int tileY = field.originTileY; tileY < field.originTileY + field.tilesY; ++tileY) {
+            const std::uint32_t* versions = snapshot.tileVersions.data() + tileY * fieldTilesX;
+            std::uint32_t* drawn = field.drawnTiles.data() + tileY * fieldTilesX;
+            int tileX = field.originTileX;
+            while (tileX < tileXEnd) {
+                if (!field.uploadAll && versions[tileX] == drawn[tileX]) {
+                    ++tileX;
+                    continue;
+                }
+                // соседние изменившиеся плитки загружаются одним куском
+                int runEnd = tileX + 1;
+                while (runEnd < tileXEnd && (field.uploadAll || versions[runEnd] != drawn[runEnd])) {
+                    ++runEnd;
+                }
+                uploadTiles(grid, tileY, tileX, runEnd);
+                std::copy(versions + tileX, versions + runEnd, drawn + tileX);
+                tileX = runEnd;
+            }
+        }
+        field.drawnVersion = snapshot.version;
+        field.uploadAll = false;
+    }
+
+    // в окне у правого и нижнего края поля плитки бывают неполными
+    int originX = field.originTileX * tileWidth;
+    int originY = field.originTileY * tileHeight;
+    int cols = std::min(field.tilesX * tileWidth, field.width - originX);
+    int rows = std::min(field.tilesY * tileHeight, field.height - originY);
+    float x = static_cast<float>((originX - camera.left) * camera.zoom);
+    float y = static_cast<float>((originY - camera.top) * camera.zoom);
+    field.cellsSprite.setTextureRect(sf::IntRect(0, 0, cols, rows));
+    field.cellsSprite.setPosition(x, y);
+    field.cellsSprite.setScale(camera.zoom, camera.zoom);
+    draw(field.cellsSprite);
+    if (camera.zoom >= UIConstants::GRID_LINES_MIN_ZOOM && field.gridLinesTexture.getSize().x != 0) {
+        field.gridLinesSprite.setTextureRect(sf::IntRect(0, 0, cols * CELL_SIZE, rows * CELL_SIZE));
+        field.gridLinesSprite.setPosition(x, y);
+        field.gridLinesSprite.setScale(camera.zoom / CELL_SIZE, camera.zoom / CELL_SIZE);
+        draw(field.gridLinesSprite);
+    }
+    return true;
+}
+
+// переводит плитки [tileBegin, tileEnd) строки плиток tileY в пиксели и загружает их в окно текстуры
+void GameOfLifeRenderer::uploadTiles(const BitGrid& grid, int tileY, int tileBegin, int tileEnd) {
+    const sf::Uint32 live = packColor(sf::Color::Green);
+    const sf::Uint32 dead = packColor(sf::Color::Black);
+    int x0 = tileBegin * ActivityTracker::TILE_WIDTH;
+    int x1 = std::min(tileEnd * ActivityTracker::TILE_WIDTH, field.width);
+    int y0 = tileY * ActivityTracker::TILE_HEIGHT;
+    int y1 = std::min(y0 + ActivityTracker::TILE_HEIGHT, field.height);
+
+    sf::Uint32* out = field.pixels.data();
+    for (int i = y0; i < y1; ++i) {
+        const std::uint64_t* words = grid.row(i);
+        for (int j = x0; j < x1; ++j) {
+            *out++ = (words[j / BitGrid::WORD_BITS] >> (j % BitGrid::WORD_BITS)) & 1u ? live : dead;
+        }
+    }
+    field.cellsTexture.update(reinterpret_cast<const sf::Uint8*>(field.pixels.data()), x1 - x0, y1 - y0,
+                              x0 - field.originTileX * ActivityTracker::TILE_WIDTH,
+                              y0 - field.originTileY * ActivityTracker::TILE_HEIGHT);
+}
+
+// обновляет пирамиду плотности по плиткам, изменившимся с прошлого обновления
+void GameOfLifeRenderer::updatePyramid() {
+    const SimulationThread::Snapshot& snapshot = simulation.getSnapshot();
+    DensityPyramid& pyramid = overview.pyramid;
+    if (pyramid.getWidth() != snapshot.grid.getWidth() || pyramid.getHeight() != snapshot.grid.getHeight()) {
+        pyramid.rebuild(snapshot.grid);
+        overview.pyramidTiles = snapshot.tileVersions;
+        overview.pyramidVersion = snapshot.version;
+        return;
+    }
+    if (overview.pyramidVersion == snapshot.version) {
+        return;
+    }
+    overview.dirtyTiles.clear();
+    for (std::size_t tile = 0; tile < snapshot.tileVersions.size(); ++tile) {
+        if (snapshot.tileVersions[tile] != overview.pyramidTiles[tile]) {
+            overview.dirtyTiles.push_back(static_cast<int>(tile));
+        }
+    }
+    pyramid.updateTiles(snapshot.grid, overview.dirtyTiles);
+    overview.pyramidTiles = snapshot.tileVersions;
+    overview.pyramidVersion = snapshot.version;
+}
+
+// рисует видимую часть поля блоками 2^level клеток: не меньше пикселя на блок
+void GameOfLifeRenderer::renderFieldOverview() {
+    const SimulationThread::Snapshot& snapshot = simulation.getSnapshot();
+    const BitGrid& grid = snapshot.grid;
+    updatePyramid();
+
+    int level = 0;
+    while (camera.zoom * (1 << level) < 1 && level + 1 < overview.pyramid.getLevelCount()) {
+        ++level;
+    }
+    int blockSize = 1 << level;
+    double blockPixels = camera.zoom * blockSize;
+    int blocksX = (grid.getWidth() + blockSize - 1) / blockSize;
+    int blocksY = (grid.getHeight() + blockSize - 1) / blockSize;
+    int firstCol = std::max(0, static_cast<int>(std::floor(camera.left / blockSize)));
+    int firstRow = std::max(0, static_cast<int>(std::floor(camera.top / blockSize)));
+    int lastCol = std::min(blocksX, static_cast<int>(std::ceil((camera.left + state.WINDOW_WIDTH / camera.zoom) / blockSize)));
+    int lastRow = std::min(blocksY, static_cast<int>(std::ceil((camera.top + state.WINDOW_HEIGHT / camera.zoom) / blockSize)));
+    if (firstCol >= lastCol || firstRow >= lastRow) {
+        return; // поле за пределами окна
+    }
+    int cols = lastCol - firstCol;
+    int rows = lastRow - firstRow;
+
+    // видимых блоков не больше, чем пикселей окна (плюс неполные блоки по краям)
+    if (overview.texture.getSize().x == 0) {
+        if (!overview.texture.create(state.WINDOW_WIDTH + 2, state.WINDOW_HEIGHT + 2)) {
+            return; // без текстуры размером с экран поле не нарисовать
         }
+        overview.texture.setSmooth(false);
+        overview.sprite.setTexture(overview.texture);
+        overview.pixels.resize(static_cast<std::size_t>(state.WINDOW_WIDTH + 2) * (state.WINDOW_HEIGHT + 2));
     }
+
+    if (!overview.valid || overview.version != snapshot.version || overview.level != level ||
+        overview.firstRow != firstRow || overview.firstCol != firstCol ||
+        overview.rows != rows || overview.cols != cols) {
+        Profiler::ScopedTimer uploadTimer(Profiler::Metric::Upload);
+        const float cellsPerBlock = static_cast<float>(blockSize) * blockSize;
+        sf::Uint32* out = overview.pixels.data();
+        for (int r = firstRow; r < lastRow; ++r) {
+            for (int c = firstCol; c < lastCol; ++c) {
+                std::uint32_t live = overview.pyramid.count(grid, level, r, c);
+                // даже одна живая клетка в большом блоке должна быть видна
+                sf::Uint8 green = live == 0 ? 0 : static_cast<sf::Uint8>(64 + 191 * std::min(1.0f, live / cellsPerBlock));
+                *out++ = packColor(sf::Color(0, green, 0));
+            }
+        }
+        overview.texture.update(reinterpret_cast<const sf::Uint8*>(overview.pixels.data()), cols, rows, 0, 0);
+        overview.valid = true;
+        overview.version = snapshot.version;
+        overview.level = level;
+        overview.firstRow = firstRow;
+        overview.firstCol = firstCol;
+        overview.rows = rows;
+        overview.cols = cols;
+    }
+
+    overview.sprite.setTextureRect(sf::IntRect(0, 0, cols, rows));
+    overview.sprite.setScale(blockPixels, blockPixels);
+    overview.sprite.setPosition((firstCol * blockSize - camera.left) * camera.zoom,
+                                (firstRow * blockSize - camera.top) * camera.zoom);
+    draw(overview.sprite);
+}
+
+void GameOfLifeRenderer::renderCellHighlight() {
+    int row;
+    int col;
+    if (screenToCell(sf::Mouse::getPosition(window), row, col)) {
+        sf::RectangleShape highlight(sf::Vector2f(camera.zoom, camera.zoom));
+        highlight.setPosition((col - camera.left) * camera.zoom, (row - camera.top) * camera.zoom);
+        highlight.setFillColor(state.drawMode ?
+            sf::Color(255, 255, 255, UIConstants::HIGHLIGHT_ALPHA_ADD) :
+            sf::Color(255, 0, 0, UIConstants::HIGHLIGHT_ALPHA_REMOVE));
+        draw(highlight);
+    }
+}
+
+void GameOfLifeRenderer::updateStats() {
+    float frameTime = stats.frameClock.restart().asSeconds() * 1000.0f;
+    stats.frameTimeMs += (frameTime - stats.frameTimeMs) * UIConstants::FRAME_TIME_SMOOTHING;
+
+    float elapsed = stats.rateClock.getElapsedTime().asSeconds();
+    if (elapsed >= UIConstants::STATS_INTERVAL) {
+        int generation = simulation.getSnapshot().generation;
+        stats.generationsPerSecond = (generation - stats.rateGeneration) / elapsed;
+        stats.rateGeneration = generation;
+        stats.rateClock.restart();
+
+        if (Profiler::isEnabled()) {
+            Profiler::Summary total = Profiler::collect();
+            Profiler::Summary interval = total;
+            interval.subtract(stats.profileBase);
+            stats.profileBase = total;
+            const Profiler::Metric shown[] = {
+                Profiler::Metric::Step, Profiler::Metric::Publish, Profiler::Metric::Frame,
+                Profiler::Metric::Render, Profiler::Metric::Upload, Profiler::Metric::DrawCalls,
+                Profiler::Metric::CellsChanged, Profiler::Metric::Population};
+            stats.profileText.clear();
+            for (Profiler::Metric metric : shown) {
+                stats.profileText += profileLine(interval, total, metric, elapsed) + "\n";
+            }
+            stats.profileText += Profiler::isTracing() ? "trace: recording, F - save" : "F - record trace";
+            if (!stats.traceStatus.empty()) {
+                stats.profileText += " (" + stats.traceStatus + ")";
+            }
+        }
+    }
+}
+
+// процентили замеров за последний интервал статистики — над строкой состояния panel, с ее левого края
+void GameOfLifeRenderer::renderProfilerOverlay(const sf::FloatRect& panel) {
+    sf::Text text;
+    text.setFont(resources.font);
+    text.setCharacterSize(UIConstants::PROFILER_FONT_SIZE);
+    text.setFillColor(sf::Color::White);
+    text.setString(stats.profileText.empty() ? std::string("collecting...") : stats.profileText);
+
+    sf::FloatRect bounds = text.getLocalBounds();
+    sf::Vector2f size(bounds.left + bounds.width + UIConstants::PROFILER_MARGIN * 2,
+                      bounds.top + bounds.height + UIConstants::PROFILER_MARGIN * 2);
+    float left = panel.left - UIConstants::PROFILER_MARGIN;
+    float top = panel.top - UIConstants::PROFILER_MARGIN - size.y;
+    text.setPosition(left + UIConstants::PROFILER_MARGIN, top + UIConstants::PROFILER_MARGIN);
+    sf::RectangleShape background(size);
+    background.setPosition(left, top);
+    background.setFillColor(sf::Color(0, 0, 0, UIConstants::PROFILER_BACKGROUND_ALPHA));
+    draw(background);
+    draw(text);
 }
 
 void GameOfLifeRenderer::renderInfoPanel() {
@@ -175,18 +553,41 @@ void GameOfLifeRenderer::renderInfoPanel() {
     info.setPosition(UIConstants::INFO_TEXT_X, state.WINDOW_HEIGHT - UIConstants::INFO_TEXT_Y_OFFSET);
     
     std::string modeStr = state.drawMode ? "Add" : "Remove";
+    const SimulationThread::Snapshot& snapshot = simulation.getSnapshot();
+    std::string cycleStr;
+    switch (snapshot.cycleState) {
+    case CycleDetector::State::Extinct:
+        cycleStr = " (extinct)";
+        break;
+    case CycleDetector::State::StillLife:
+        cycleStr = " (stable)";
+        break;
+    case CycleDetector::State::Oscillating:
+        cycleStr = " (period " + std::to_string(snapshot.period) + ")";
+        break;
+    default:
+        break;
+    }
     info.setString(
-        "Generation: " + std::to_string(game.getGeneration()) +
-        " | Speed: " + std::to_string(state.delay) + "ms" +
-        " | Controls: W/S - speed, Space - pause, R - reset, M - menu, Q - exit" +
+        "Generation: " + std::to_string(snapshot.generation) + cycleStr +
+        " | Speed: " + (state.schedulerMode == Scheduler::Mode::Uncapped ?
+                            std::string("max") : formatNumber(state.targetRate, 1) + " gen/s") +
+        " (" + schedulerModeName(state.schedulerMode) + ")" +
+        " | Actual: " + formatNumber(stats.generationsPerSecond, 1) + " gen/s, " +
+        formatNumber(stats.frameTimeMs, 1) + " ms/frame" +
+        " | Controls: W/S - speed, U - speed mode, Space - pause, R - reset, H - history (" +
+        std::string(state.historyEnabled ? "on" : "off") + "), Z/Y - undo/redo, P - profiler, M - menu, Q - exit" +
         ", T - Switch Mode (" + modeStr + ")"
     );
-    window.draw(info);
+    draw(info);
+    if (Profiler::isEnabled()) {
+        renderProfilerOverlay(info.getGlobalBounds());
+    }
 }
 
 void GameOfLifeRenderer::renderRulesWindow() {
     window.clear();
-    window.draw(resources.menuBackgroundSprite);
+    draw(resources.menuBackgroundSprite);
 
     std::string rulesText =
         "The universe is a 2D grid of square cells\n"
@@ -209,7 +610,7 @@ void GameOfLifeRenderer::renderRulesWindow() {
     rules.setString(rulesText);
     rules.setPosition(UIConstants::RULES_TEXT_X, UIConstants::RULES_TEXT_Y);
     rules.setLineSpacing(UIConstants::LINE_SPACING);
-    window.draw(rules);
+    draw(rules);
 
     sf::Text hint;
     hint.setFont(resources.font);
@@ -218,7 +619,7 @@ void GameOfLifeRenderer::renderRulesWindow() {
     hint.setString("Press M or click outside text to return to menu");
     hint.setPosition(state.WINDOW_WIDTH / 2 - hint.getLocalBounds().width / 2, 
                     state.WINDOW_HEIGHT - UIConstants::HINT_TEXT_Y_OFFSET);
-    window.draw(hint);
+    draw(hint);
 
     window.display();
 }
@@ -232,15 +633,15 @@ void GameOfLifeRenderer::renderMainMenuButtons() {
     resources.controlButtonSprite.setPosition(buttonX, startY + UIConstants::BUTTON_SPACING * 2);
     resources.exitButtonSprite.setPosition(buttonX, startY + UIConstants::BUTTON_SPACING * 3);
 
-    window.draw(resources.playButtonSprite);
-    window.draw(resources.rulesButtonSprite);
-    window.draw(resources.controlButtonSprite);
-    window.draw(resources.exitButtonSprite);
+    draw(resources.playButtonSprite);
+    draw(resources.rulesButtonSprite);
+    draw(resources.controlButtonSprite);
+    draw(resources.exitButtonSprite);
 }
 
 void GameOfLifeRenderer::renderMenu() {
     window.clear();
-    window.draw(resources.menuBackgroundSprite);
+    draw(resources.menuBackgroundSprite);
 
     if (state.showRules) {
         renderRulesWindow();
@@ -255,7 +656,7 @@ void GameOfLifeRenderer::renderMenu() {
 
 void GameOfLifeRenderer::renderControl() {
     window.clear();
-    window.draw(resources.menuBackgroundSprite);
+    draw(resources.menuBackgroundSprite);
     
     std::string controlText =
         "LMB - Add/remove cells (mode toggled with T)\n"
@@ -263,8 +664,14 @@ void GameOfLifeRenderer::renderControl() {
         "T - Toggle add/remove mode\n"
         "SPACE - Pause simulation\n"
         "R - Reset field\n"
+        "H - Record history for undo and rewind (off by default)\n"
+        "Z / Y - Undo / redo a generation or an edit\n"
+        "PgUp / PgDn - Rewind / replay 50 generations\n"
         "W/S - Adjust speed\n"
-        "M - Return to menu\n\n\n\n\n"
+        "U - Switch speed mode (fixed / frame skip / uncapped)\n"
+        "P / F - Profiler overlay / record and save a trace\n"
+        "Wheel / arrows / Home - Zoom / move / fit the view\n"
+        "M - Return to menu\n\n\n"
         "Click anywhere to return";
 
     sf::Text controls;
@@ -279,7 +686,7 @@ void GameOfLifeRenderer::renderControl() {
     controls.setPosition(UIConstants::CONTROL_TEXT_X, 
                         state.WINDOW_HEIGHT / UIConstants::CONTROL_TEXT_Y_RATIO); 
 
-    window.draw(controls);
+    draw(controls);
     window.display();
 }
 
@@ -301,6 +708,13 @@ void GameOfLifeRenderer::handleEvents() {
         if (event.type == sf::Event::MouseButtonReleased) {
             handleMouseRelease(event.mouseButton.button);
         }
+
+        // горизонтальная прокрутка тачпада приходит тем же событием и масштаб не меняет
+        if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel &&
+            !state.showMainMenu && !state.showRules && !state.showControl) {
+            zoomCamera(std::pow(UIConstants::ZOOM_FACTOR, event.mouseWheelScroll.delta),
+                       sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y));
+        }
     }
 }
 
@@ -310,19 +724,62 @@ void GameOfLifeRenderer::handleKeyPress(sf::Keyboard::Key key) {
     } else if (key == sf::Keyboard::Space) {
         state.isPaused = !state.isPaused;
     } else if (key == sf::Keyboard::R) {
-        game.reset();
+        simulation.post({SimulationThread::Command::Type::Reset});
+    } else if (key == sf::Keyboard::H) {
+        state.historyEnabled = !state.historyEnabled;
+        simulation.post({SimulationThread::Command::Type::History, 0, 0, state.historyEnabled});
+    } else if (state.historyEnabled && (key == sf::Keyboard::Z || key == sf::Keyboard::Y)) {
+        state.isPaused = true; // иначе следующее поколение сразу затрет отмену
+        simulation.post({key == sf::Keyboard::Z ? SimulationThread::Command::Type::Undo
+                                                : SimulationThread::Command::Type::Redo});
+    } else if (state.historyEnabled && (key == sf::Keyboard::PageUp || key == sf::Keyboard::PageDown)) {
+        state.isPaused = true;
+        SimulationThread::Command seek{SimulationThread::Command::Type::Seek};
+        seek.generation = simulation.getSnapshot().generation +
+                          (key == sf::Keyboard::PageUp ? -UIConstants::SCRUB_GENERATIONS
+                                                       : UIConstants::SCRUB_GENERATIONS);
+        simulation.post(seek);
     } else if (key == sf::Keyboard::M) {
         state.showMainMenu = true;
         state.showRules = false;
         state.showControl = false;
     } else if (key == sf::Keyboard::W) {
-        if (state.delay > UIConstants::MIN_DELAY) {
-            state.delay -= UIConstants::DELAY_STEP;
-        }
+        state.targetRate = std::min(state.targetRate * UIConstants::RATE_FACTOR, UIConstants::MAX_RATE);
+        simulation.setTargetRate(state.targetRate);
     } else if (key == sf::Keyboard::S) {
-        state.delay += UIConstants::DELAY_STEP;
+        state.targetRate = std::max(state.targetRate / UIConstants::RATE_FACTOR, UIConstants::MIN_RATE);
+        simulation.setTargetRate(state.targetRate);
+    } else if (key == sf::Keyboard::U) {
+        state.schedulerMode = state.schedulerMode == Scheduler::Mode::FixedRate ? Scheduler::Mode::FrameSkip :
+                              state.schedulerMode == Scheduler::Mode::FrameSkip ? Scheduler::Mode::Uncapped :
+                                                                                  Scheduler::Mode::FixedRate;
+        simulation.setMode(state.schedulerMode);
     } else if (key == sf::Keyboard::T) {
         state.drawMode = !state.drawMode;
+    } else if (key == sf::Keyboard::P) {
+        Profiler::setEnabled(!Profiler::isEnabled());
+        stats.profileBase = Profiler::collect(); // первое окно — с момента включения
+        stats.profileText.clear();
+    } else if (key == sf::Keyboard::F) {
+        if (!Profiler::isTracing()) {
+            Profiler::setTracing(true);
+            stats.traceStatus.clear();
+        } else {
+            std::string error;
+            stats.traceStatus = Profiler::writeTrace(UIConstants::TRACE_FILE, error)
+                                    ? std::string("saved ") + UIConstants::TRACE_FILE : error;
+            Profiler::setTracing(false);
+        }
+    } else if (key == sf::Keyboard::Left) {
+        panCamera(-state.WINDOW_WIDTH * UIConstants::PAN_FRACTION, 0);
+    } else if (key == sf::Keyboard::Right) {
+        panCamera(state.WINDOW_WIDTH * UIConstants::PAN_FRACTION, 0);
+    } else if (key == sf::Keyboard::Up) {
+        panCamera(0, -state.WINDOW_HEIGHT * UIConstants::PAN_FRACTION);
+    } else if (key == sf::Keyboard::Down) {
+        panCamera(0, state.WINDOW_HEIGHT * UIConstants::PAN_FRACTION);
+    } else if (key == sf::Keyboard::Home) {
+        resetCamera();
     }
 }
 
@@ -373,31 +830,26 @@ void GameOfLifeRenderer::handleMenuClick(const sf::Vector2i& mousePos) {
 }
 
 void GameOfLifeRenderer::handleGameFieldClick(const sf::Vector2i& mousePos, sf::Mouse::Button button) {
-    int playableWidth = FIELD_WIDTH * CELL_SIZE;
-    int playableHeight = FIELD_HEIGHT * CELL_SIZE;
-    int offsetX = (state.WINDOW_WIDTH - playableWidth) / 2;
-    int offsetY = (state.WINDOW_HEIGHT - playableHeight) / UIConstants::FIELD_OFFSET_Y_RATIO;
-
-    if (mousePos.x >= offsetX && mousePos.x <= offsetX + playableWidth &&
-        mousePos.y >= offsetY && mousePos.y <= offsetY + playableHeight) {
-
-        int col = (mousePos.x - offsetX) / CELL_SIZE;
-        int row = (mousePos.y - offsetY) / CELL_SIZE;
-
-        if (row >= 0 && row < FIELD_HEIGHT && col >= 0 && col < FIELD_WIDTH) {
-            auto& grid = const_cast<std::vector<std::vector<bool>>&>(game.getGrid());
-            if (button == sf::Mouse::Left) {
-                grid[row][col] = state.drawMode;
-            } else if (button == sf::Mouse::Right) {
-                grid[row][col] = false;
-            }
+    int row;
+    int col;
+    if (screenToCell(mousePos, row, col)) {
+        if (button == sf::Mouse::Left) {
+            editCell(row, col, state.drawMode);
+        } else if (button == sf::Mouse::Right) {
+            editCell(row, col, false);
         }
     }
 }
 
+// правки уходят в поток симуляции и применяются между поколениями
+void GameOfLifeRenderer::editCell(int row, int col, bool alive) {
+    simulation.post({SimulationThread::Command::Type::SetCell, row, col, alive});
+}
+
 void GameOfLifeRenderer::handleMouseRelease(sf::Mouse::Button button) {
     if (button == sf::Mouse::Left) state.isMouseLeftPressed = false;
     if (button == sf::Mouse::Right) state.isMouseRightPressed = false;
     state.lastRow = -1;
     state.lastCol = -1;
+    simulation.post({SimulationThread::Command::Type::CommitEdit}); // штрих отменяется целиком
 }
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "GenerationHistory.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+const std::size_t GenerationHistory::DEFAULT_BUDGET;
+const int GenerationHistory::KEYFRAME_SPAN;
+
+namespace {
+
+// пишет value с out[at] по 7 бит в байт, младшие первыми; возвращает позицию за ним
+std::size_t putVarint(std::uint8_t* out, std::size_t at, std::size_t value) {
+    for (; value >= 0x80; value >>= 7) {
+        out[at++] = static_cast<std::uint8_t>(value | 0x80);
+    }
+    out[at++] = static_cast<std::uint8_t>(value);
+    return at;
+}
+
+std::size_t getVarint(const std::uint8_t*& p) {
+    std::size_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        std::uint8_t byte = *p++;
+        value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+}
+
+// Сжимает слова, поданные по возрастанию номеров. Номера делятся на группы по 64 слова;
+// группа с изменениями пишется как число пропущенных перед ней пустых групп, маска
+// ненулевых слов и сами ненулевые слова. Внутри группы запись без ветвлений: слово пишется
+// всегда, а позиция сдвигается, только если оно не нулевое, так что хаотичное поле не
+// платит за неугаданные переходы. Буфер только растет; сжатые данные — первые finish() байт.
+class Encoder {
+public:
+    explicit Encoder(std::vector<std::uint8_t>& out) : out(out) {}
+
+    void add(std::size_t index, std::uint64_t bits) {
+        std::size_t group = index / GROUP_WORDS;
+        if (group != current) {
+            open(group);
+        }
+        std::memcpy(out.data() + at, &bits, sizeof(bits));
+        at += bits != 0 ? sizeof(bits) : 0;
+        mask |= static_cast<std::uint64_t>(bits != 0) << (index % GROUP_WORDS);
+    }
+
+    std::size_t finish() {
+        close();
+        return at;
+    }
+
+private:
+    static const std::size_t GROUP_WORDS = 64;
+    static const std::size_t NO_GROUP = ~std::size_t(0);
+    // заголовок (varint и маска) и все слова группы
+    static const std::size_t MAX_GROUP_BYTES = 10 + sizeof(std::uint64_t) * (1 + GROUP_WORDS);
+
+    void open(std::size_t group) {
+        close();
+        if (at + MAX_GROUP_BYTES > out.size()) {
+            out.resize(std::max(2 * out.size(), at + MAX_GROUP_BYTES));
+        }
+        groupStart = at;
+        at = putVarint(out.data(), at, group - nextGroup);
+        maskAt = at;
+        at += sizeof(mask);
+        current = group;
+        mask = 0;
+    }
+
+    void close() {
+        if (current == NO_GROUP) {
+            return;
+        }
+        if (mask == 0) {
+            at = groupStart; // в группе одни нули: заголовок не нужен
+        } else {
+            std::memcpy(out.data() + maskAt, &mask, sizeof(mask));
+            nextGroup = current + 1;
+        }
+        current = NO_GROUP;
+    }
+
+    std::vector<std::uint8_t>& out;
+    std::size_t at = 0;
+    std::size_t current = NO_GROUP; // открытая группа
+    std::size_t nextGroup = 0;      // группа за последней записанной
+    std::uint64_t mask = 0;
+    std::size_t groupStart = 0;
+    std::size_t maskAt = 0;
+};
+
+// after XOR before (или само after без before) по всему полю
+void encodeField(const BitGrid* before, const BitGrid& after, Encoder& encoder) {
+    std::size_t words = static_cast<std::size_t>(after.getWordsPerRow());
+    for (int r = 0; r < after.getHeight(); ++r) {
+        const std::uint64_t* a = after.row(r);
+        const std::uint64_t* b = before ? before->row(r) : nullptr;
+        for (std::size_t w = 0; w < words; ++w) {
+            encoder.add(r * words + w, b ? a[w] ^ b[w] : a[w]);
+        }
+    }
+}
+
+// after XOR before только в плитках tiles, отсортированных по номеру: номера слов тогда
+// идут по возрастанию — строки полосы плиток по порядку, в строке плитки слева направо
+void encodeTiles(const BitGrid& before, const BitGrid& after, const std::vector<int>& tiles, int tilesX,
+                 Encoder& encoder) {
+    int words = after.getWordsPerRow();
+    for (std::size_t first = 0; first < tiles.size();) {
+        int tileY = tiles[first] / tilesX;
+        std::size_t last = first;
+        while (last < tiles.size() && tiles[last] / tilesX == tileY) {
+            ++last;
+        }
+        int rowEnd = std::min((tileY + 1) * ActivityTracker::TILE_HEIGHT, after.getHeight());
+        for (int r = tileY * ActivityTracker::TILE_HEIGHT; r < rowEnd; ++r) {
+            const std::uint64_t* a = after.row(r);
+            const std::uint64_t* b = before.row(r);
+            for (std::size_t i = first; i < last; ++i) {
+                int wordBegin = tiles[i] % tilesX * ActivityTracker::TILE_WORDS;
+                int wordEnd = std::min(wordBegin + ActivityTracker::TILE_WORDS, words);
+                for (int w = wordBegin; w < wordEnd; ++w) {
+                    encoder.add(static_cast<std::size_t>(r) * words + w, a[w] ^ b[w]);
+                }
+            }
+        }
+        first = last;
+    }
+}
+
+// вызывает visit(index, bits) для каждого ненулевого слова по порядку
+template <typename Visit>
+void decode(const std::vector<std::uint8_t>& data, Visit visit) {
+    const std::uint8_t* p = data.data();
+    const std::uint8_t* end = p + data.size();
+    std::size_t group = 0;
+    while (p < end) {
+        group += getVarint(p);
+        std::uint64_t mask;
+        std::memcpy(&mask, p, sizeof(mask));
+        p += sizeof(mask);
+        for (; mask != 0; mask &= mask - 1, p += sizeof(std::uint64_t)) {
+            std::uint64_t bits;
+            std::memcpy(&bits, p, sizeof(bits));
+            visit(group * 64 + __builtin_ctzll(mask), bits);
+        }
+        ++group;
+    }
+}
+
+} // namespace
+
+GenerationHistory::GenerationHistory(std::size_t budgetBytes) : budget(budgetBytes) {}
+
+void GenerationHistory::setBudget(std::size_t budgetBytes) {
+    budget = budgetBytes;
+    evict();
+}
+
+void GenerationHistory::clear(const BitGrid& grid, int generation) {
+    entries.clear();
+    entries.emplace_back();
+    entries.back().generation = generation;
+    position = 0;
+    bytes = entryBytes(entries.back());
+    sinceKeyframe = 0;
+    open = false;
+    width = grid.getWidth();
+    height = grid.getHeight();
+}
+
+void GenerationHistory::push(const BitGrid& before, const BitGrid& after, const ActivityTracker* changed,
+                             int generation, std::uint64_t hash, std::size_t population) {
+    append(before, after, changed, generation, hash, population);
+}
+
+void GenerationHistory::begin(const BitGrid& grid) {
+    if (!open) {
+        base = grid; // размеры обычно совпадают, так что память не выделяется
+        open = true;
+    }
+}
+
+void GenerationHistory::commit(const BitGrid& grid, int generation, std::uint64_t hash, std::size_t population) {
+    if (open) {
+        open = false;
+        append(base, grid, nullptr, generation, hash, population);
+    }
+}
+
+void GenerationHistory::append(const BitGrid& before, const BitGrid& after, const ActivityTracker* changed,
+                               int generation, std::uint64_t hash, std::size_t population) {
+    if (entries.empty() || after.getWidth() != width || after.getHeight() != height) {
+        clear(after, generation);
+        return;
+    }
+    Encoder encoder(encoded);
+    if (changed) {
+        tiles = changed->getChangedTiles();
+        std::sort(tiles.begin(), tiles.end());
+        encodeTiles(before, after, tiles, changed->getTilesX(), encoder);
+    } else {
+        encodeField(&before, after, encoder);
+    }
+    std::size_t deltaBytes = encoder.finish();
+    if (deltaBytes == 0 && generation == entries[position].generation) {
+        return; // правка ничего не изменила
+    }
+    if (position + 1 < size()) {
+        // отмененные записи больше не достижимы
+        for (int i = position + 1; i < size(); ++i) {
+            bytes -= entryBytes(entries[i]);
+        }
+        entries.erase(entries.begin() + position + 1, entries.end());
+        sinceKeyframe = 0;
+        for (int i = position; i > 0 && !entries[i].hasKeyframe; --i) {
+            sinceKeyframe += entries[i].delta.size();
+        }
+    }
+
+    Entry entry;
+    entry.generation = generation;
+    entry.delta.assign(encoded.begin(), encoded.begin() + deltaBytes);
+    sinceKeyframe += entry.delta.size();
+    // Между кадрами изменений не больше KEYFRAME_SPAN полей, так что дальняя перемотка
+    // накладывает кадр и цепочку не длиннее поля — порядка одного шага. На хаотичном поле
+    // кадр получается почти у каждой записи: память меняется на скорость перемотки.
+    std::size_t gridBytes = static_cast<std::size_t>(after.getWordsPerRow()) * height * sizeof(std::uint64_t);
+    if (sinceKeyframe >= KEYFRAME_SPAN * gridBytes) {
+        Encoder keyframe(encoded);
+        encodeField(nullptr, after, keyframe);
+        entry.hasKeyframe = true;
+        entry.keyframe.assign(encoded.begin(), encoded.begin() + keyframe.finish());
+        entry.hash = hash;
+        entry.population = population;
+        sinceKeyframe = 0;
+    }
+    bytes += entryBytes(entry);
+    entries.push_back(std::move(entry));
+    position = size() - 1;
+    evict();
+}
+
+void GenerationHistory::evict() {
+    // текущая запись остается при любом бюджете
+    while (bytes > budget && position > 0) {
+        bytes -= entryBytes(entries.front());
+        entries.pop_front();
+        --position;
+        // изменение новой самой старой записи вело от вытесненной и больше не нужно
+        Entry& oldest = entries.front();
+        bytes -= oldest.delta.size();
+        std::vector<std::uint8_t>().swap(oldest.delta);
+    }
+}
+
+std::size_t GenerationHistory::entryBytes(const Entry& entry) {
+    return sizeof(Entry) + entry.delta.size() + entry.keyframe.size();
+}
+
+int GenerationHistory::find(int generation) const {
+    int best = position;
+    for (int i = 0; i < size(); ++i) {
+        int distance = std::abs(entries[i].generation - generation);
+        int bestDistance = std::abs(entries[best].generation - generation);
+        if (distance < bestDistance ||
+            (distance == bestDistance && std::abs(i - position) < std::abs(best - position))) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void GenerationHistory::seek(int entry, Sink& sink) {
+    if (entry < 0 || entry >= size() || entry == position) {
+        return;
+    }
+    // цена пути — байты изменений, которые придется наложить; prefix[i] — сумма по записям до i
+    std::vector<std::size_t> prefix(entries.size() + 1, 0);
+    for (int i = 0; i < size(); ++i) {
+        prefix[i + 1] = prefix[i] + entries[i].delta.size();
+    }
+    auto chain = [&prefix](int from, int to) { // изменения записей (min, max]
+        return prefix[std::max(from, to) + 1] - prefix[std::min(from, to) + 1];
+    };
+    int start = position;
+    std::size_t best = chain(position, entry);
+    for (int i = 0; i < size(); ++i) {
+        if (entries[i].hasKeyframe && entries[i].keyframe.size() + chain(i, entry) < best) {
+            best = entries[i].keyframe.size() + chain(i, entry);
+            start = i;
+        }
+    }
+
+    if (start != position) {
+        if (scratch.getWidth() != width || scratch.getHeight() != height) {
+            scratch = BitGrid(width, height);
+        } else {
+            scratch.clear();
+        }
+        int words = scratch.getWordsPerRow();
+        decode(entries[start].keyframe, [this, words](std::size_t index, std::uint64_t bits) {
+            scratch.row(static_cast<int>(index / words))[index % words] = bits;
+        });
+        sink.load(scratch, entries[start].hash, entries[start].population);
+    }
+    auto apply = [&sink](std::size_t index, std::uint64_t bits) { sink.xorWord(index, bits); };
+    if (entry < start) {
+        for (int i = start; i > entry; --i) {
+            decode(entries[i].delta, apply);
+        }
+    } else {
+        for (int i = start + 1; i <= entry; ++i) {
+            decode(entries[i].delta, apply);
+        }
+    }
+    position = entry;
+}
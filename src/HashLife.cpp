@@ -0,0 +1,408 @@
+#include "HashLife.hpp"
+#include "GameOfLifeCore.hpp"
+#include <algorithm>
+
+const std::size_t HashLife::DEFAULT_MAX_NODES;
+const HashLife::NodeId HashLife::NO_NODE;
+const HashLife::NodeId HashLife::DEAD_CELL;
+const HashLife::NodeId HashLife::LIVE_CELL;
+const int HashLife::MAX_STEP;
+
+namespace {
+
+std::int64_t positiveMod(std::int64_t value, std::int64_t mod) {
+    std::int64_t result = value % mod;
+    return result < 0 ? result + mod : result;
+}
+
+std::uint64_t nodeHash(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se) {
+    std::uint64_t hash = (std::uint64_t(nw) * 0x9E3779B97F4A7C15ull) ^ (std::uint64_t(ne) * 0xC2B2AE3D27D4EB4Full) ^
+                         (std::uint64_t(sw) * 0x165667B19E3779F9ull) ^ (std::uint64_t(se) * 0xD6E8FEB86659FD93ull);
+    return hash ^ (hash >> 29);
+}
+
+} // namespace
+
+HashLife::HashLife(std::size_t maxNodes)
+    : generation(0), lastRoot(NO_NODE), lastResult(NO_NODE), maxNodes(maxNodes), collections(0) {
+    setRule(LifeRule());
+}
+
+bool HashLife::isRuleSupported(const LifeRule& rule) {
+    return rule.isLifeLike() && !rule.next(false, 0);
+}
+
+bool HashLife::setRule(const LifeRule& newRule) {
+    if (!isRuleSupported(newRule)) {
+        return false;
+    }
+    rule = newRule;
+    // бит r * 4 + c индекса — клетка (r, c) блока 4x4; в ответе биты центра: (1,1) (1,2) (2,1) (2,2)
+    for (int index = 0; index < (1 << 16); ++index) {
+        std::uint8_t result = 0;
+        for (int r = 1; r <= 2; ++r) {
+            for (int c = 1; c <= 2; ++c) {
+                int neighbors = 0;
+                for (int dr = -1; dr <= 1; ++dr) {
+                    for (int dc = -1; dc <= 1; ++dc) {
+                        if (dr == 0 && dc == 0) continue;
+                        neighbors += (index >> ((r + dr) * 4 + c + dc)) & 1;
+                    }
+                }
+                bool alive = (index >> (r * 4 + c)) & 1;
+                if (rule.next(alive, neighbors)) {
+                    result |= 1 << ((r - 1) * 2 + (c - 1));
+                }
+            }
+        }
+        leafTable[index] = result;
+    }
+    clearNodes(); // результаты узлов посчитаны по старому правилу
+    return true;
+}
+
+const LifeRule& HashLife::getRule() const {
+    return rule;
+}
+
+void HashLife::clearNodes() {
+    nodes.clear();
+    emptyNodes.clear();
+    Node cell = {NO_NODE, NO_NODE, NO_NODE, NO_NODE, NO_NODE, NO_NODE, 0, -1};
+    nodes.push_back(cell); // DEAD_CELL
+    nodes.push_back(cell); // LIVE_CELL
+    emptyNodes.push_back(DEAD_CELL);
+    buckets.assign(1 << 16, NO_NODE);
+    lastRoot = NO_NODE;
+    lastResult = NO_NODE;
+}
+
+bool HashLife::load(const GameOfLifeCore& game) {
+    if (game.getRule() != rule && !setRule(game.getRule())) {
+        return false;
+    }
+    tile = game.getGrid();
+    generation = static_cast<std::uint64_t>(game.getGeneration());
+    return true;
+}
+
+bool HashLife::store(GameOfLifeCore& game) const {
+    if (generation > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        return false;
+    }
+    game.setGrid(tile);
+    game.setGeneration(static_cast<int>(generation));
+    return true;
+}
+
+bool HashLife::advance(GameOfLifeCore& game, int k) {
+    if (k < 0 || k > MAX_STEP) {
+        return false;
+    }
+    std::uint64_t end = static_cast<std::uint64_t>(game.getGeneration()) + (std::uint64_t(1) << k);
+    if (end > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) || !load(game)) {
+        return false;
+    }
+    stepPow2(k);
+    return store(game);
+}
+
+const BitGrid& HashLife::getGrid() const {
+    return tile;
+}
+
+std::uint64_t HashLife::getGeneration() const {
+    return generation;
+}
+
+void HashLife::setMaxNodes(std::size_t newMaxNodes) {
+    maxNodes = newMaxNodes;
+}
+
+std::size_t HashLife::getNodeCount() const {
+    return nodes.size();
+}
+
+std::size_t HashLife::getPeakNodeCount() const {
+    return peakNodes;
+}
+
+std::size_t HashLife::getCollectionCount() const {
+    return collections;
+}
+
+void HashLife::stepPow2(int k) {
+    int width = tile.getWidth();
+    int height = tile.getHeight();
+    if (width == 0 || height == 0) return;
+
+    // корень уровня n за 2^(n-2) поколений дает свой центр размером 2^(n-1),
+    // центр должен накрыть весь тор, а шаг не может быть больше 2^(n-2)
+    int level = std::max(k + 2, 3);
+    while ((std::int64_t(1) << (level - 1)) < std::max(width, height)) {
+        ++level;
+    }
+    std::int64_t origin = -(std::int64_t(1) << (level - 2));
+
+    nodeLimit = k > 0 ? 2 * maxNodes : std::numeric_limits<std::size_t>::max();
+    try {
+        tileMemo.clear();
+        lastRoot = buildPeriodic(level, origin, origin);
+        tileMemo.clear();
+        lastResult = successor(lastRoot, k);
+    } catch (const NodeLimitReached&) {
+        // поле еще не тронуто: то же самое двумя шагами вдвое короче с пустым кэшем
+        nodeLimit = std::numeric_limits<std::size_t>::max();
+        tileMemo.clear();
+        clearNodes();
+        ++collections;
+        stepPow2(k - 1);
+        stepPow2(k - 1);
+        return;
+    }
+    nodeLimit = std::numeric_limits<std::size_t>::max();
+    tile.clear();
+    extract(lastResult, level - 1, 0, 0);
+    generation += std::uint64_t(1) << k;
+
+    if (nodes.size() > maxNodes) {
+        collectGarbage();
+    }
+}
+
+HashLife::NodeId HashLife::join(NodeId nw, NodeId ne, NodeId sw, NodeId se) {
+    std::size_t bucket = nodeHash(nw, ne, sw, se) & (buckets.size() - 1);
+
+    for (NodeId id = buckets[bucket]; id != NO_NODE; id = nodes[id].next) {
+        const Node& node = nodes[id];
+        if (node.nw == nw && node.ne == ne && node.sw == sw && node.se == se) {
+            return id;
+        }
+    }
+
+    NodeId id = static_cast<NodeId>(nodes.size());
+    Node node = {nw, ne, sw, se, NO_NODE, buckets[bucket], static_cast<std::int8_t>(nodes[nw].level + 1), -1};
+    if (nodes.size() >= nodeLimit) {
+        throw NodeLimitReached();
+    }
+    nodes.push_back(node);
+    peakNodes = std::max(peakNodes, nodes.size());
+    buckets[bucket] = id;
+    if (nodes.size() > buckets.size()) {
+        rehash(buckets.size() * 2);
+    }
+    return id;
+}
+
+void HashLife::rehash(std::size_t bucketCount) {
+    buckets.assign(bucketCount, NO_NODE);
+    for (NodeId id = 0; id < nodes.size(); ++id) {
+        Node& node = nodes[id];
+        if (node.level == 0) continue; // клетки не лежат в таблице
+        std::size_t bucket = nodeHash(node.nw, node.ne, node.sw, node.se) & (bucketCount - 1);
+        node.next = buckets[bucket];
+        buckets[bucket] = id;
+    }
+}
+
+HashLife::NodeId HashLife::emptyNode(int level) {
+    while (static_cast<int>(emptyNodes.size()) <= level) {
+        NodeId child = emptyNodes.back();
+        emptyNodes.push_back(join(child, child, child, child));
+    }
+    return emptyNodes[level];
+}
+
+// центр узла уровня 2 (4x4 клетки) через одно поколение — по таблице
+HashLife::NodeId HashLife::leafSuccessor(const Node& node) {
+    const Node quarters[4] = {nodes[node.nw], nodes[node.ne], nodes[node.sw], nodes[node.se]};
+    auto bit = [](NodeId cell, int position) { return static_cast<unsigned>(cell == LIVE_CELL) << position; };
+
+    unsigned index = 0;
+    for (int q = 0; q < 4; ++q) {
+        int r = (q / 2) * 2;
+        int c = (q % 2) * 2;
+        index |= bit(quarters[q].nw, r * 4 + c) | bit(quarters[q].ne, r * 4 + c + 1) |
+                 bit(quarters[q].sw, (r + 1) * 4 + c) | bit(quarters[q].se, (r + 1) * 4 + c + 1);
+    }
+
+    std::uint8_t result = leafTable[index];
+    auto cell = [result](int position) { return (result >> position) & 1 ? LIVE_CELL : DEAD_CELL; };
+    return join(cell(0), cell(1), cell(2), cell(3));
+}
+
+// центр узла уровня level через 2^step поколений, step <= level - 2
+HashLife::NodeId HashLife::successor(NodeId id, int step) {
+    Node node = nodes[id]; // копия: вектор узлов может переехать во время рекурсии
+    if (node.result != NO_NODE && node.resultStep == step) {
+        return node.result;
+    }
+
+    int level = node.level;
+    NodeId result;
+    if (id == emptyNode(level)) {
+        result = emptyNode(level - 1);
+    } else if (level == 2) {
+        result = leafSuccessor(node);
+    } else {
+        Node a = nodes[node.nw], b = nodes[node.ne], c = nodes[node.sw], d = nodes[node.se];
+
+        // девять перекрывающихся подузлов уровня level - 1
+        NodeId n00 = node.nw;
+        NodeId n01 = join(a.ne, b.nw, a.se, b.sw);
+        NodeId n02 = node.ne;
+        NodeId n10 = join(a.sw, a.se, c.nw, c.ne);
+        NodeId n11 = join(a.se, b.sw, c.ne, d.nw);
+        NodeId n12 = join(b.sw, b.se, d.nw, d.ne);
+        NodeId n20 = node.sw;
+        NodeId n21 = join(c.ne, d.nw, c.se, d.sw);
+        NodeId n22 = node.se;
+
+        if (step == level - 2) {
+            // полный шаг: две половины по 2^(level-3) поколений
+            int half = level - 3;
+            NodeId r00 = successor(n00, half), r01 = successor(n01, half), r02 = successor(n02, half);
+            NodeId r10 = successor(n10, half), r11 = successor(n11, half), r12 = successor(n12, half);
+            NodeId r20 = successor(n20, half), r21 = successor(n21, half), r22 = successor(n22, half);
+
+            NodeId nw = successor(join(r00, r01, r10, r11), half);
+            NodeId ne = successor(join(r01, r02, r11, r12), half);
+            NodeId sw = successor(join(r10, r11, r20, r21), half);
+            NodeId se = successor(join(r11, r12, r21, r22), half);
+            result = join(nw, ne, sw, se);
+        } else {
+            // короткий шаг: 2^step поколений в первой половине, вторая только берет центры
+            NodeId r00 = successor(n00, step), r01 = successor(n01, step), r02 = successor(n02, step);
+            NodeId r10 = successor(n10, step), r11 = successor(n11, step), r12 = successor(n12, step);
+            NodeId r20 = successor(n20, step), r21 = successor(n21, step), r22 = successor(n22, step);
+
+            Node s00 = nodes[r00], s01 = nodes[r01], s02 = nodes[r02];
+            Node s10 = nodes[r10], s11 = nodes[r11], s12 = nodes[r12];
+            Node s20 = nodes[r20], s21 = nodes[r21], s22 = nodes[r22];
+
+            NodeId nw = join(s00.se, s01.sw, s10.ne, s11.nw);
+            NodeId ne = join(s01.se, s02.sw, s11.ne, s12.nw);
+            NodeId sw = join(s10.se, s11.sw, s20.ne, s21.nw);
+            NodeId se = join(s11.se, s12.sw, s21.ne, s22.nw);
+            result = join(nw, ne, sw, se);
+        }
+    }
+
+    nodes[id].result = result;
+    nodes[id].resultStep = static_cast<std::int8_t>(step);
+    return result;
+}
+
+// узел периодической раскладки тора с левым верхним углом (x0, y0);
+// одинаковые по модулю размеров тора позиции дают один и тот же узел
+HashLife::NodeId HashLife::buildPeriodic(int level, std::int64_t x0, std::int64_t y0) {
+    if (level == 0) {
+        int row = static_cast<int>(positiveMod(y0, tile.getHeight()));
+        int col = static_cast<int>(positiveMod(x0, tile.getWidth()));
+        return tile.get(row, col) ? LIVE_CELL : DEAD_CELL;
+    }
+
+    std::uint64_t key = 0;
+    if (level >= 3) {
+        key = (std::uint64_t(level) << 58) | (std::uint64_t(positiveMod(x0, tile.getWidth())) << 29) |
+              std::uint64_t(positiveMod(y0, tile.getHeight()));
+        auto found = tileMemo.find(key);
+        if (found != tileMemo.end()) {
+            return found->second;
+        }
+    }
+
+    std::int64_t half = std::int64_t(1) << (level - 1);
+    NodeId nw = buildPeriodic(level - 1, x0, y0);
+    NodeId ne = buildPeriodic(level - 1, x0 + half, y0);
+    NodeId sw = buildPeriodic(level - 1, x0, y0 + half);
+    NodeId se = buildPeriodic(level - 1, x0 + half, y0 + half);
+    NodeId id = join(nw, ne, sw, se);
+
+    if (level >= 3) {
+        tileMemo.emplace(key, id);
+    }
+    return id;
+}
+
+// переносит живые клетки узла с левым верхним углом (x0, y0) в тор
+void HashLife::extract(NodeId id, int level, std::int64_t x0, std::int64_t y0) {
+    if (x0 >= tile.getWidth() || y0 >= tile.getHeight() || id == emptyNode(level)) {
+        return;
+    }
+    if (level == 0) {
+        tile.set(static_cast<int>(y0), static_cast<int>(x0), true);
+        return;
+    }
+    Node node = nodes[id];
+    std::int64_t half = std::int64_t(1) << (level - 1);
+    extract(node.nw, level - 1, x0, y0);
+    extract(node.ne, level - 1, x0 + half, y0);
+    extract(node.sw, level - 1, x0, y0 + half);
+    extract(node.se, level - 1, x0 + half, y0 + half);
+}
+
+// Оставляет только дерево последнего шага вместе с запомненными результатами
+// (они нужнее всего на следующем шаге), остальное выбрасывает и уплотняет нумерацию.
+// Если и этого слишком много, кэш очищается целиком.
+void HashLife::collectGarbage() {
+    ++collections;
+
+    std::vector<std::uint8_t> marked(nodes.size(), 0);
+    std::vector<NodeId> stack(emptyNodes.begin(), emptyNodes.end());
+    stack.push_back(LIVE_CELL);
+    stack.push_back(lastRoot);
+    stack.push_back(lastResult);
+    while (!stack.empty()) {
+        NodeId id = stack.back();
+        stack.pop_back();
+        if (id == NO_NODE || marked[id]) continue;
+        marked[id] = 1;
+        const Node& node = nodes[id];
+        if (node.level > 0) {
+            stack.push_back(node.nw);
+            stack.push_back(node.ne);
+            stack.push_back(node.sw);
+            stack.push_back(node.se);
+        }
+        stack.push_back(node.result);
+    }
+
+    // дети всегда создаются раньше родителей, поэтому порядок номеров сохраняется
+    std::vector<NodeId> remap(nodes.size(), NO_NODE);
+    std::size_t kept = 0;
+    for (NodeId id = 0; id < nodes.size(); ++id) {
+        if (!marked[id]) continue;
+        Node node = nodes[id];
+        if (node.level > 0) {
+            node.nw = remap[node.nw];
+            node.ne = remap[node.ne];
+            node.sw = remap[node.sw];
+            node.se = remap[node.se];
+        }
+        remap[id] = static_cast<NodeId>(kept);
+        nodes[kept++] = node;
+    }
+    for (std::size_t i = 0; i < kept; ++i) {
+        Node& node = nodes[i];
+        if (node.result != NO_NODE) {
+            node.result = remap[node.result];
+        }
+    }
+    nodes.resize(kept);
+    for (NodeId& id : emptyNodes) {
+        id = remap[id];
+    }
+    lastRoot = remap[lastRoot];
+    lastResult = remap[lastResult];
+
+    std::size_t bucketCount = 1 << 16;
+    while (bucketCount < nodes.size()) {
+        bucketCount *= 2;
+    }
+    rehash(bucketCount);
+
+    if (nodes.size() > maxNodes / 2) {
+        clearNodes();
+    }
+}
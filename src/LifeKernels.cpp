@@ -0,0 +1,153 @@
+#include "LifeKernels.hpp"
+
+namespace LifeKernels {
+
+namespace {
+
+// соседи крайнего слова строки: на краях бит берется с противоположной стороны тора
+struct EdgeNeighbors {
+    std::uint64_t west;
+    std::uint64_t east;
+};
+
+inline EdgeNeighbors edgeNeighbors(const std::uint64_t* r, int word, int words, int width) {
+    int lastBit = (width - 1) % 64;
+    std::uint64_t prev = word > 0 ? r[word - 1]
+                                  : ((r[words - 1] >> lastBit) & 1u) << 63; // клетка width-1
+    EdgeNeighbors result;
+    result.west = westNeighbors(r[word], prev);
+    if (word < words - 1) {
+        result.east = eastNeighbors(r[word], r[word + 1]);
+    } else {
+        // в последнем слове справа от клетки width-1 стоит клетка 0
+        result.east = (r[word] >> 1) | ((r[0] & 1u) << lastBit);
+    }
+    return result;
+}
+
+template <typename Rule>
+inline std::uint64_t edgeWord(const Rule& rule, const std::uint64_t* above, const std::uint64_t* row,
+                              const std::uint64_t* below, int word, int words, int width) {
+    EdgeNeighbors a = edgeNeighbors(above, word, words, width);
+    EdgeNeighbors m = edgeNeighbors(row, word, words, width);
+    EdgeNeighbors b = edgeNeighbors(below, word, words, width);
+    return rule(countNeighbors(a.west, above[word], a.east, m.west, m.east, b.west, below[word], b.east), row[word]);
+}
+
+// общий цикл по словам строки; правило подставляется на этапе компиляции
+template <typename Rule>
+void stepWordsWith(const Rule& rule, const std::uint64_t* above, const std::uint64_t* row,
+                   const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    int words = (width + 63) / 64;
+    if (wordBegin >= wordEnd) return;
+
+    if (wordBegin == 0) {
+        out[0] = edgeWord(rule, above, row, below, 0, words, width);
+    }
+    int middleEnd = wordEnd < words - 1 ? wordEnd : words - 1;
+    for (int w = wordBegin > 1 ? wordBegin : 1; w < middleEnd; ++w) {
+        NeighborCounts counts = countNeighbors(
+            westNeighbors(above[w], above[w - 1]), above[w], eastNeighbors(above[w], above[w + 1]),
+            westNeighbors(row[w], row[w - 1]), eastNeighbors(row[w], row[w + 1]),
+            westNeighbors(below[w], below[w - 1]), below[w], eastNeighbors(below[w], below[w + 1]));
+        out[w] = rule(counts, row[w]);
+    }
+    if (wordEnd == words && words > 1) {
+        out[words - 1] = edgeWord(rule, above, row, below, words - 1, words, width);
+    }
+
+    // биты за пределами ширины поля должны оставаться нулевыми
+    int tailBits = width % 64;
+    if (wordEnd == words && tailBits != 0) {
+        out[words - 1] &= (std::uint64_t(1) << tailBits) - 1;
+    }
+}
+
+// Окно строки для блоков слова word: клетки -1..62 от начала слова в low и 63, 64 в high.
+// На краях строки соседи берутся с другой стороны тора, как в edgeNeighbors().
+struct LutWindow {
+    std::uint64_t low;
+    std::uint64_t high;
+};
+
+inline LutWindow lutWindow(const std::uint64_t* r, int word, int words, int width) {
+    int lastBit = (width - 1) % 64;
+    std::uint64_t west = word > 0 ? r[word - 1] >> 63 : (r[words - 1] >> lastBit) & 1u;
+    std::uint64_t value = r[word];
+    std::uint64_t east = 0;
+    if (word < words - 1) {
+        east = r[word + 1] & 1u;
+    } else if (lastBit < 63) {
+        value |= (r[0] & 1u) << (lastBit + 1); // клетка 0 сразу за клеткой width-1
+    } else {
+        east = r[0] & 1u;
+    }
+    return {(value << 1) | west, (value >> 63) | (east << 1)};
+}
+
+// индекс таблицы для блока со столбцами bit, bit+1 слова; окна строк уже сдвинуты на bit
+inline unsigned lutIndex(std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t d) {
+    return static_cast<unsigned>((a & 0xF) | (b & 0xF) << 4 | (c & 0xF) << 8 | (d & 0xF) << 12);
+}
+
+} // namespace
+
+constexpr LutTable CONWAY_LUT = makeLutTable(1u << 3, (1u << 2) | (1u << 3));
+
+// блок в середине мигалки (столбцы 1, 2 окрестности, строки 1, 2): вертикальная палка
+// становится горизонтальной, а клетка с четырьмя соседями умирает
+static_assert(CONWAY_LUT.next[0x2 | 0x2 << 4 | 0x2 << 8] == 0x3, "blinker turns");
+static_assert(CONWAY_LUT.next[0x6 | 0x6 << 4] == 0x3, "block top half stays");
+static_assert(CONWAY_LUT.next[0xF | 0xF << 4 | 0xF << 8 | 0xF << 12] == 0, "overcrowded block dies");
+
+void stepWordsLut(const LutTable& table, const std::uint64_t* above, const std::uint64_t* row,
+                  const std::uint64_t* below, const std::uint64_t* below2, std::uint64_t* out,
+                  std::uint64_t* outBelow, int width, int wordBegin, int wordEnd) {
+    int words = (width + 63) / 64;
+    int tailBits = width % 64;
+    for (int w = wordBegin; w < wordEnd; ++w) {
+        LutWindow a = lutWindow(above, w, words, width);
+        LutWindow b = lutWindow(row, w, words, width);
+        LutWindow c = lutWindow(below, w, words, width);
+        LutWindow d = lutWindow(below2, w, words, width);
+        std::uint64_t top = 0;
+        std::uint64_t bottom = 0;
+        for (int bit = 0; bit < 62; bit += 2) {
+            unsigned next = table.next[lutIndex(a.low >> bit, b.low >> bit, c.low >> bit, d.low >> bit)];
+            top |= static_cast<std::uint64_t>(next & 3u) << bit;
+            bottom |= static_cast<std::uint64_t>(next >> 2) << bit;
+        }
+        // последний блок захватывает клетки 63 и 64 из high
+        unsigned next = table.next[lutIndex(a.low >> 62 | a.high << 2, b.low >> 62 | b.high << 2,
+                                            c.low >> 62 | c.high << 2, d.low >> 62 | d.high << 2)];
+        top |= static_cast<std::uint64_t>(next & 3u) << 62;
+        bottom |= static_cast<std::uint64_t>(next >> 2) << 62;
+        // биты за пределами ширины поля должны оставаться нулевыми
+        if (w == words - 1 && tailBits != 0) {
+            top &= (std::uint64_t(1) << tailBits) - 1;
+            bottom &= (std::uint64_t(1) << tailBits) - 1;
+        }
+        out[w] = top;
+        if (outBelow) {
+            outBelow[w] = bottom;
+        }
+    }
+}
+
+void stepRow(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+             std::uint64_t* out, int width) {
+    stepWords(above, row, below, out, width, 0, (width + 63) / 64);
+}
+
+void stepWords(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+               std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsWith(ConwayRule(), above, row, below, out, width, wordBegin, wordEnd);
+}
+
+void stepWordsRule(const RuleMasks& rule,
+                   const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                   std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsWith(rule, above, row, below, out, width, wordBegin, wordEnd);
+}
+
+} // namespace LifeKernels
@@ -0,0 +1,165 @@
+#include "LifeKernels.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace LifeKernels {
+
+#if defined(__AVX2__)
+
+namespace {
+
+inline void fullAdd(__m256i a, __m256i b, __m256i c, __m256i& sum, __m256i& carry) {
+    __m256i ab = _mm256_xor_si256(a, b);
+    sum = _mm256_xor_si256(ab, c);
+    carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(ab, c));
+}
+
+// соседи слева и справа для четырех слов, начиная с ptr (нужны ptr[-1] и ptr[4])
+inline __m256i westNeighbors(const std::uint64_t* ptr, __m256i words) {
+    __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr - 1));
+    return _mm256_or_si256(_mm256_slli_epi64(words, 1), _mm256_srli_epi64(prev, 63));
+}
+
+inline __m256i eastNeighbors(const std::uint64_t* ptr, __m256i words) {
+    __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 1));
+    return _mm256_or_si256(_mm256_srli_epi64(words, 1), _mm256_slli_epi64(next, 63));
+}
+
+// NeighborCounts для четырех слов
+struct Counts {
+    __m256i ones;
+    __m256i twos;
+    __m256i fours;
+    __m256i eights;
+};
+
+inline Counts countNeighbors(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                             __m256i a, __m256i m, __m256i b) {
+    __m256i aboveSum, aboveCarry, belowSum, belowCarry;
+    fullAdd(westNeighbors(above, a), a, eastNeighbors(above, a), aboveSum, aboveCarry);
+    fullAdd(westNeighbors(below, b), b, eastNeighbors(below, b), belowSum, belowCarry);
+    __m256i west = westNeighbors(row, m);
+    __m256i east = eastNeighbors(row, m);
+    __m256i midSum = _mm256_xor_si256(west, east);
+    __m256i midCarry = _mm256_and_si256(west, east);
+
+    Counts counts;
+    __m256i onesCarry, twosPart, foursA;
+    fullAdd(aboveSum, belowSum, midSum, counts.ones, onesCarry);
+    fullAdd(aboveCarry, belowCarry, midCarry, twosPart, foursA);
+    counts.twos = _mm256_xor_si256(twosPart, onesCarry);
+    __m256i foursB = _mm256_and_si256(twosPart, onesCarry);
+    counts.fours = _mm256_xor_si256(foursA, foursB);
+    counts.eights = _mm256_and_si256(foursA, foursB);
+    return counts;
+}
+
+// Правила для векторного цикла: scalar считает края и хвосты строки тем же правилом.
+struct ConwayVector {
+    ConwayRule scalar;
+
+    __m256i operator()(const Counts& counts, __m256i center) const {
+        return _mm256_and_si256(_mm256_andnot_si256(counts.fours, counts.twos), _mm256_or_si256(counts.ones, center));
+    }
+};
+
+// RuleMasks: то же дерево мультиплексоров, таблица размножена на все слова вектора
+struct MasksVector {
+    const RuleMasks& scalar;
+    __m256i next[2][9];
+
+    explicit MasksVector(const RuleMasks& rule) : scalar(rule) {
+        for (int alive = 0; alive < 2; ++alive) {
+            for (int n = 0; n <= 8; ++n) {
+                next[alive][n] = _mm256_set1_epi64x(static_cast<long long>(rule.next[alive][n]));
+            }
+        }
+    }
+
+    __m256i operator()(const Counts& counts, __m256i center) const {
+        return select(pick(next[0], counts), pick(next[1], counts), center);
+    }
+
+private:
+    static __m256i select(__m256i a, __m256i b, __m256i bit) {
+        return _mm256_xor_si256(a, _mm256_and_si256(_mm256_xor_si256(a, b), bit));
+    }
+    static __m256i pick(const __m256i* table, const Counts& counts) {
+        __m256i low = select(select(select(table[0], table[1], counts.ones), select(table[2], table[3], counts.ones),
+                                    counts.twos),
+                             select(select(table[4], table[5], counts.ones), select(table[6], table[7], counts.ones),
+                                    counts.twos),
+                             counts.fours);
+        return select(low, table[8], counts.eights);
+    }
+};
+
+inline void stepScalar(const ConwayRule&, const std::uint64_t* above, const std::uint64_t* row,
+                       const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWords(above, row, below, out, width, wordBegin, wordEnd);
+}
+
+inline void stepScalar(const RuleMasks& rule, const std::uint64_t* above, const std::uint64_t* row,
+                       const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsRule(rule, above, row, below, out, width, wordBegin, wordEnd);
+}
+
+template <typename VectorRule>
+void stepWordsWith(const VectorRule& rule, const std::uint64_t* above, const std::uint64_t* row,
+                   const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    if (wordBegin >= wordEnd) return;
+    int words = (width + 63) / 64;
+    // первое и последнее слово замыкают тор, их считает скалярное ядро
+    int w = wordBegin > 1 ? wordBegin : 1;
+    stepScalar(rule.scalar, above, row, below, out, width, wordBegin, w);
+
+    for (; w + 4 < words && w + 4 <= wordEnd; w += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + w));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + w));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + w));
+        __m256i next = rule(countNeighbors(above + w, row + w, below + w, a, m, b), m);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), next);
+    }
+
+    stepScalar(rule.scalar, above, row, below, out, width, w, wordEnd);
+}
+
+} // namespace
+
+void stepWordsAvx2(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                   std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsWith(ConwayVector(), above, row, below, out, width, wordBegin, wordEnd);
+}
+
+void stepWordsRuleAvx2(const RuleMasks& rule,
+                       const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                       std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsWith(MasksVector(rule), above, row, below, out, width, wordBegin, wordEnd);
+}
+
+bool avx2Available() {
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+void stepWordsAvx2(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                   std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWords(above, row, below, out, width, wordBegin, wordEnd);
+}
+
+void stepWordsRuleAvx2(const RuleMasks& rule,
+                       const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                       std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsRule(rule, above, row, below, out, width, wordBegin, wordEnd);
+}
+
+bool avx2Available() {
+    return false;
+}
+
+#endif
+
+} // namespace LifeKernels
@@ -0,0 +1,180 @@
+#include "LifeKernels.hpp"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace LifeKernels {
+
+#if defined(__AVX512F__)
+
+namespace {
+
+// сумма и перенос трех плоскостей тернарной логикой: 0x96 = a^b^c, 0xE8 = большинство
+inline void fullAdd(__m512i a, __m512i b, __m512i c, __m512i& sum, __m512i& carry) {
+    sum = _mm512_ternarylogic_epi64(a, b, c, 0x96);
+    carry = _mm512_ternarylogic_epi64(a, b, c, 0xE8);
+}
+
+// Сдвиги слов. _mm512_slli_epi64 в GCC 12 берет неопределенный вектор как подложку для
+// маски и дает ложное -Wmaybe-uninitialized; maskz с полной маской — та же инструкция
+// с нулевой подложкой.
+template <unsigned Shift>
+inline __m512i shiftLeft(__m512i words) {
+    return _mm512_maskz_slli_epi64(0xFF, words, Shift);
+}
+
+template <unsigned Shift>
+inline __m512i shiftRight(__m512i words) {
+    return _mm512_maskz_srli_epi64(0xFF, words, Shift);
+}
+
+// соседи слева и справа для восьми слов, начиная с ptr (нужны ptr[-1] и ptr[8])
+inline __m512i westNeighbors(const std::uint64_t* ptr, __m512i words) {
+    __m512i prev = _mm512_loadu_si512(ptr - 1);
+    return _mm512_or_si512(shiftLeft<1>(words), shiftRight<63>(prev));
+}
+
+inline __m512i eastNeighbors(const std::uint64_t* ptr, __m512i words) {
+    __m512i next = _mm512_loadu_si512(ptr + 1);
+    return _mm512_or_si512(shiftRight<1>(words), shiftLeft<63>(next));
+}
+
+// NeighborCounts для восьми слов
+struct Counts {
+    __m512i ones;
+    __m512i twos;
+    __m512i fours;
+    __m512i eights;
+};
+
+inline Counts countNeighbors(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                             __m512i a, __m512i m, __m512i b) {
+    __m512i aboveSum, aboveCarry, belowSum, belowCarry;
+    fullAdd(westNeighbors(above, a), a, eastNeighbors(above, a), aboveSum, aboveCarry);
+    fullAdd(westNeighbors(below, b), b, eastNeighbors(below, b), belowSum, belowCarry);
+    __m512i west = westNeighbors(row, m);
+    __m512i east = eastNeighbors(row, m);
+    __m512i midSum = _mm512_xor_si512(west, east);
+    __m512i midCarry = _mm512_and_si512(west, east);
+
+    Counts counts;
+    __m512i onesCarry, twosPart, foursA;
+    fullAdd(aboveSum, belowSum, midSum, counts.ones, onesCarry);
+    fullAdd(aboveCarry, belowCarry, midCarry, twosPart, foursA);
+    counts.twos = _mm512_xor_si512(twosPart, onesCarry);
+    // fours = foursA ^ (twosPart & onesCarry): 0x78; eights = foursA & twosPart & onesCarry: 0x80
+    counts.fours = _mm512_ternarylogic_epi64(foursA, twosPart, onesCarry, 0x78);
+    counts.eights = _mm512_ternarylogic_epi64(foursA, twosPart, onesCarry, 0x80);
+    return counts;
+}
+
+// Правила для векторного цикла: scalar считает края и хвосты строки тем же правилом.
+struct ConwayVector {
+    ConwayRule scalar;
+
+    __m512i operator()(const Counts& counts, __m512i center) const {
+        // ~fours & twos & (ones | center): 0x08
+        __m512i alive = _mm512_or_si512(counts.ones, center);
+        return _mm512_ternarylogic_epi64(counts.fours, counts.twos, alive, 0x08);
+    }
+};
+
+// RuleMasks: то же дерево мультиплексоров, таблица размножена на все слова вектора
+struct MasksVector {
+    const RuleMasks& scalar;
+    __m512i next[2][9];
+
+    explicit MasksVector(const RuleMasks& rule) : scalar(rule) {
+        for (int alive = 0; alive < 2; ++alive) {
+            for (int n = 0; n <= 8; ++n) {
+                next[alive][n] = _mm512_set1_epi64(static_cast<long long>(rule.next[alive][n]));
+            }
+        }
+    }
+
+    __m512i operator()(const Counts& counts, __m512i center) const {
+        return select(pick(next[0], counts), pick(next[1], counts), center);
+    }
+
+private:
+    // bit ? b : a одной инструкцией: 0xCA
+    static __m512i select(__m512i a, __m512i b, __m512i bit) {
+        return _mm512_ternarylogic_epi64(bit, b, a, 0xCA);
+    }
+    static __m512i pick(const __m512i* table, const Counts& counts) {
+        __m512i low = select(select(select(table[0], table[1], counts.ones), select(table[2], table[3], counts.ones),
+                                    counts.twos),
+                             select(select(table[4], table[5], counts.ones), select(table[6], table[7], counts.ones),
+                                    counts.twos),
+                             counts.fours);
+        return select(low, table[8], counts.eights);
+    }
+};
+
+inline void stepScalar(const ConwayRule&, const std::uint64_t* above, const std::uint64_t* row,
+                       const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWords(above, row, below, out, width, wordBegin, wordEnd);
+}
+
+inline void stepScalar(const RuleMasks& rule, const std::uint64_t* above, const std::uint64_t* row,
+                       const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsRule(rule, above, row, below, out, width, wordBegin, wordEnd);
+}
+
+template <typename VectorRule>
+void stepWordsWith(const VectorRule& rule, const std::uint64_t* above, const std::uint64_t* row,
+                   const std::uint64_t* below, std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    if (wordBegin >= wordEnd) return;
+    int words = (width + 63) / 64;
+    // первое и последнее слово замыкают тор, их считает скалярное ядро
+    int w = wordBegin > 1 ? wordBegin : 1;
+    stepScalar(rule.scalar, above, row, below, out, width, wordBegin, w);
+
+    for (; w + 8 < words && w + 8 <= wordEnd; w += 8) {
+        __m512i a = _mm512_loadu_si512(above + w);
+        __m512i m = _mm512_loadu_si512(row + w);
+        __m512i b = _mm512_loadu_si512(below + w);
+        _mm512_storeu_si512(out + w, rule(countNeighbors(above + w, row + w, below + w, a, m, b), m));
+    }
+
+    stepScalar(rule.scalar, above, row, below, out, width, w, wordEnd);
+}
+
+} // namespace
+
+void stepWordsAvx512(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                     std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsWith(ConwayVector(), above, row, below, out, width, wordBegin, wordEnd);
+}
+
+void stepWordsRuleAvx512(const RuleMasks& rule,
+                         const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                         std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsWith(MasksVector(rule), above, row, below, out, width, wordBegin, wordEnd);
+}
+
+bool avx512Available() {
+    return __builtin_cpu_supports("avx512f");
+}
+
+#else
+
+void stepWordsAvx512(const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                     std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWords(above, row, below, out, width, wordBegin, wordEnd);
+}
+
+void stepWordsRuleAvx512(const RuleMasks& rule,
+                         const std::uint64_t* above, const std::uint64_t* row, const std::uint64_t* below,
+                         std::uint64_t* out, int width, int wordBegin, int wordEnd) {
+    stepWordsRule(rule, above, row, below, out, width, wordBegin, wordEnd);
+}
+
+bool avx512Available() {
+    return false;
+}
+
+#endif
+
+} // namespace LifeKernels
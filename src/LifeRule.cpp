@@ -0,0 +1,217 @@
+#include "LifeRule.hpp"
+#include <cctype>
+#include <cstdlib>
+
+const int LifeRule::MAX_RANGE;
+const int LifeRule::MAX_STATES;
+
+namespace {
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts(1);
+    for (char c : text) {
+        if (c == separator) {
+            parts.emplace_back();
+        } else {
+            parts.back() += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return parts;
+}
+
+// неотрицательное целое без знака и пробелов
+bool parseNumber(const std::string& text, int& value) {
+    if (text.empty() || text.size() > 6) {
+        return false;
+    }
+    for (char c : text) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+    }
+    value = std::atoi(text.c_str());
+    return true;
+}
+
+// цифры числа соседей 0..8 в список разрешенных значений
+bool parseDigits(const std::string& digits, std::uint8_t* allowed) {
+    for (char c : digits) {
+        if (c < '0' || c > '8') {
+            return false;
+        }
+        allowed[c - '0'] = 1;
+    }
+    return true;
+}
+
+// "a..b", "a" или пустая строка (пустой диапазон)
+bool parseInterval(const std::string& text, int& low, int& high) {
+    if (text.empty()) {
+        low = 1;
+        high = 0;
+        return true;
+    }
+    std::size_t dots = text.find("..");
+    if (dots == std::string::npos) {
+        return parseNumber(text, low) && parseNumber(text, high);
+    }
+    return parseNumber(text.substr(0, dots), low) && parseNumber(text.substr(dots + 2), high) && low <= high;
+}
+
+bool parseStates(const std::string& text, int& states) {
+    // C0 и C1 в записи Larger than Life тоже означают два состояния
+    if (!parseNumber(text, states) || states > LifeRule::MAX_STATES) {
+        return false;
+    }
+    if (states < 2) {
+        states = 2;
+    }
+    return true;
+}
+
+} // namespace
+
+LifeRule::LifeRule() : states(2), countCenter(false) {
+    resize(1);
+    table[3] = 1;                    // B3
+    table[maxNeighbors + 1 + 2] = 1; // S2
+    table[maxNeighbors + 1 + 3] = 1; // S3
+}
+
+void LifeRule::resize(int newRange) {
+    range = newRange;
+    maxNeighbors = (2 * range + 1) * (2 * range + 1) - 1;
+    table.assign(2 * (maxNeighbors + 1), 0);
+}
+
+bool LifeRule::parse(const std::string& text, LifeRule& rule) {
+    LifeRule parsed;
+    std::vector<std::string> parts = split(text, ',');
+
+    if (parts.size() > 1) {
+        // Larger than Life: R, C, M, S, B, N в любом порядке; обязательны R, S и B
+        int newRange = 0, newStates = 2, center = 0;
+        int birthLow = 1, birthHigh = 0, surviveLow = 1, surviveHigh = 0;
+        bool hasBirth = false, hasSurvive = false;
+        for (const std::string& part : parts) {
+            if (part.empty()) {
+                return false;
+            }
+            std::string value = part.substr(1);
+            bool ok = false;
+            switch (part[0]) {
+            case 'r': ok = parseNumber(value, newRange) && newRange >= 1 && newRange <= MAX_RANGE; break;
+            case 'c': ok = parseStates(value, newStates); break;
+            case 'm': ok = parseNumber(value, center) && center <= 1; break;
+            case 's': ok = hasSurvive = parseInterval(value, surviveLow, surviveHigh); break;
+            case 'b': ok = hasBirth = parseInterval(value, birthLow, birthHigh); break;
+            case 'n': ok = value == "m"; break; // поддерживается только квадратная окрестность
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        if (newRange == 0 || !hasBirth || !hasSurvive) {
+            return false;
+        }
+        parsed.resize(newRange);
+        parsed.states = newStates;
+        parsed.countCenter = center == 1;
+        // в таблице число соседей без центра; у живой клетки при M1 центр добавляет единицу
+        for (int n = 0; n <= parsed.maxNeighbors; ++n) {
+            parsed.table[n] = n >= birthLow && n <= birthHigh;
+            int sum = n + center;
+            parsed.table[parsed.maxNeighbors + 1 + n] = sum >= surviveLow && sum <= surviveHigh;
+        }
+        rule = parsed;
+        return true;
+    }
+
+    parts = split(text, '/');
+    if (parts.size() < 2 || parts.size() > 3) {
+        return false;
+    }
+    std::uint8_t* birth = parsed.table.data();
+    std::uint8_t* survive = birth + parsed.maxNeighbors + 1;
+    parsed.table.assign(parsed.table.size(), 0);
+
+    bool letters = !parts[0].empty() && std::isalpha(static_cast<unsigned char>(parts[0][0]));
+    if (letters) {
+        // B.../S.../C... в любом порядке
+        bool seen[3] = {false, false, false};
+        for (const std::string& part : parts) {
+            if (part.empty()) {
+                return false;
+            }
+            std::string value = part.substr(1);
+            int kind = part[0] == 'b' ? 0 : part[0] == 's' ? 1 : (part[0] == 'c' || part[0] == 'g') ? 2 : -1;
+            if (kind < 0 || seen[kind]) {
+                return false;
+            }
+            seen[kind] = true;
+            bool ok = kind == 0   ? parseDigits(value, birth)
+                      : kind == 1 ? parseDigits(value, survive)
+                                  : parseStates(value, parsed.states);
+            if (!ok) {
+                return false;
+            }
+        }
+        if (!seen[0] || !seen[1]) {
+            return false;
+        }
+    } else {
+        // позиционная запись S/B или S/B/C
+        if (!parseDigits(parts[0], survive) || !parseDigits(parts[1], birth)) {
+            return false;
+        }
+        if (parts.size() == 3 && !parseStates(parts[2], parsed.states)) {
+            return false;
+        }
+    }
+    rule = parsed;
+    return true;
+}
+
+std::string LifeRule::toString() const {
+    const std::uint8_t* birth = table.data();
+    const std::uint8_t* survive = birth + maxNeighbors + 1;
+
+    if (range == 1) {
+        std::string text = "B";
+        for (int n = 0; n <= maxNeighbors; ++n) {
+            if (birth[n]) text += static_cast<char>('0' + n);
+        }
+        text += "/S";
+        for (int n = 0; n <= maxNeighbors; ++n) {
+            if (survive[n]) text += static_cast<char>('0' + n);
+        }
+        if (states > 2) {
+            text += "/C" + std::to_string(states);
+        }
+        return text;
+    }
+
+    // диапазоны восстанавливаются по таблице: при разборе она заполняется отрезками
+    auto interval = [this](const std::uint8_t* allowed, int shift) {
+        int low = -1, high = -1;
+        for (int n = 0; n <= maxNeighbors; ++n) {
+            if (allowed[n]) {
+                if (low < 0) low = n;
+                high = n;
+            }
+        }
+        if (low < 0) return std::string();
+        return std::to_string(low + shift) + ".." + std::to_string(high + shift);
+    };
+    return "R" + std::to_string(range) + ",C" + std::to_string(states > 2 ? states : 0) + ",M" +
+           (countCenter ? "1" : "0") + ",S" + interval(survive, countCenter ? 1 : 0) + ",B" +
+           interval(birth, 0) + ",NM";
+}
+
+bool LifeRule::isConway() const {
+    return *this == LifeRule();
+}
+
+bool LifeRule::operator==(const LifeRule& other) const {
+    return range == other.range && states == other.states && table == other.table;
+}
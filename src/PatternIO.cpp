@@ -0,0 +1,680 @@
+#include "PatternIO.hpp"
+#include "BitGrid.hpp"
+#include "GameOfLifeCore.hpp"
+#include "LifeRule.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace PatternIO {
+
+namespace {
+
+const std::size_t BUFFER_SIZE = std::size_t(1) << 16;
+const int RLE_LINE_LENGTH = 70; // длина строки тела RLE при записи, как у Golly
+const int LEAF_LEVEL = 3;       // листья Macrocell — блоки 8x8, по байту на строку
+const int MAX_LEVEL = 62;
+
+// поток символов через буфер фиксированного размера; файл читается ровно один раз
+class Reader {
+public:
+    explicit Reader(std::istream& in) : in(in), buffer(BUFFER_SIZE), position(0), size(0), line(1) {}
+
+    int peek() {
+        if (position == size && !fill()) {
+            return EOF;
+        }
+        return static_cast<unsigned char>(buffer[position]);
+    }
+
+    int get() {
+        int c = peek();
+        if (c != EOF) {
+            ++position;
+            if (c == '\n') ++line;
+        }
+        return c;
+    }
+
+    // строка до перевода строки, без него и без \r
+    std::string readLine() {
+        std::string text;
+        while (peek() != EOF) {
+            // строка копируется из буфера кусками, а не по символу
+            const char* begin = buffer.data() + position;
+            const char* end = static_cast<const char*>(std::memchr(begin, '\n', size - position));
+            std::size_t length = end ? static_cast<std::size_t>(end - begin) : size - position;
+            text.append(begin, length);
+            position += length;
+            if (end) {
+                ++position;
+                ++line;
+                break;
+            }
+        }
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        return text;
+    }
+
+    void skipSpaces() {
+        while (peek() != EOF && std::isspace(peek())) {
+            get();
+        }
+    }
+
+    long long getLine() const { return line; }
+
+private:
+    bool fill() {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        size = static_cast<std::size_t>(in.gcount());
+        position = 0;
+        return size > 0;
+    }
+
+    std::istream& in;
+    std::vector<char> buffer;
+    std::size_t position;
+    std::size_t size;
+    long long line;
+};
+
+std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) return std::string();
+    std::size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool parseCount(const std::string& text, long long& value) {
+    if (text.empty() || text.size() > 18) return false;
+    for (char c : text) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+    }
+    value = std::stoll(text);
+    return true;
+}
+
+// размер тора из суффикса правила Golly; 0 — не задан
+struct Torus {
+    long long width = 0;
+    long long height = 0;
+};
+
+// Правило из файла. Суффикс тора Golly (":T300,130") задает размер поля; его пишет save,
+// чтобы загрузка вернула поле того же размера. Другие топологии и сдвиги не поддерживаются
+// и отбрасываются.
+bool parseRule(const std::string& text, LifeRule& rule, Torus& torus) {
+    std::size_t colon = text.find(':');
+    if (colon != std::string::npos) {
+        std::string topology = trim(text.substr(colon + 1));
+        std::size_t comma = topology.find(',');
+        long long width, height;
+        if (!topology.empty() && (topology[0] == 'T' || topology[0] == 't') && comma != std::string::npos &&
+            parseCount(trim(topology.substr(1, comma - 1)), width) &&
+            parseCount(trim(topology.substr(comma + 1)), height) && width > 0 && height > 0) {
+            torus.width = width;
+            torus.height = height;
+        }
+    }
+    return LifeRule::parse(trim(text.substr(0, colon)), rule);
+}
+
+// правило с размером поля для записи
+std::string ruleWithTorus(const GameOfLifeCore& game) {
+    return game.getRule().toString() + ":T" + std::to_string(game.getWidth()) + "," +
+           std::to_string(game.getHeight());
+}
+
+// включает count клеток строки row начиная со столбца col, целыми словами
+void fillRun(BitGrid& grid, int row, long long col, long long count) {
+    std::uint64_t* words = grid.row(row);
+    while (count > 0) {
+        int bit = static_cast<int>(col % BitGrid::WORD_BITS);
+        long long take = std::min<long long>(BitGrid::WORD_BITS - bit, count);
+        std::uint64_t mask = take == BitGrid::WORD_BITS ? ~std::uint64_t(0) : ((std::uint64_t(1) << take) - 1);
+        words[col / BitGrid::WORD_BITS] |= mask << bit;
+        col += take;
+        count -= take;
+    }
+}
+
+// Размер поля под образец size: явный, размер тора из файла или не меньше текущего и образца с рамкой
+bool fieldSize(long long patternSize, int requested, long long torus, int current, int& result) {
+    if (requested > 0) {
+        result = requested;
+        return patternSize <= requested;
+    }
+    long long size = torus > 0 ? torus : std::max<long long>(current, patternSize + 2 * MARGIN);
+    if (size > INT_MAX / 2) {
+        return false;
+    }
+    result = static_cast<int>(size);
+    return patternSize <= size;
+}
+
+// Общий конец загрузки: поле уже заполнено, game меняется только здесь
+bool apply(GameOfLifeCore& game, BitGrid&& grid, const LifeRule& rule, long long generation, std::string& error) {
+    int side = 2 * rule.getRange() + 1;
+    if (side > grid.getWidth() || side > grid.getHeight()) {
+        error = "rule neighbourhood does not fit the field";
+        return false;
+    }
+    if (generation > INT_MAX) {
+        error = "generation " + std::to_string(generation) + " is out of range";
+        return false;
+    }
+    game.loadGrid(std::move(grid));
+    game.setRule(rule);
+    game.setGeneration(static_cast<int>(generation));
+    return true;
+}
+
+// ---------------------------------------------------------------- RLE
+
+bool loadRle(Reader& reader, GameOfLifeCore& game, std::string& error, int width, int height) {
+    LifeRule rule;
+    Torus torus;
+    long long generation = 0;
+    std::string header;
+    // комментарии до строки размера; из #CXRLE берется номер поколения, из #r — старая запись правила
+    for (;;) {
+        reader.skipSpaces();
+        if (reader.peek() == EOF) {
+            error = "missing RLE header";
+            return false;
+        }
+        std::string line = reader.readLine();
+        if (line[0] != '#') {
+            header = line;
+            break;
+        }
+        if (line.compare(0, 7, "#CXRLE ") == 0) {
+            std::size_t gen = line.find("Gen=");
+            if (gen != std::string::npos) {
+                std::string digits;
+                for (std::size_t i = gen + 4; i < line.size() && std::isdigit(static_cast<unsigned char>(line[i])); ++i) {
+                    digits += line[i];
+                }
+                parseCount(digits, generation);
+            }
+        } else if (line.size() > 2 && line[1] == 'r' && !parseRule(line.substr(2), rule, torus)) {
+            error = "unsupported rule: " + trim(line.substr(2));
+            return false;
+        }
+    }
+
+    // "x = 3, y = 3, rule = B3/S23"; в правиле Larger than Life тоже есть запятые, поэтому оно берется целиком
+    std::size_t rulePosition = header.find("rule");
+    if (rulePosition != std::string::npos) {
+        std::size_t equals = header.find('=', rulePosition);
+        if (equals == std::string::npos || !parseRule(header.substr(equals + 1), rule, torus)) {
+            error = "unsupported rule in header: " + header;
+            return false;
+        }
+        header.erase(rulePosition);
+    }
+    long long patternWidth = -1, patternHeight = -1;
+    std::size_t start = 0;
+    while (start < header.size()) {
+        std::size_t comma = header.find(',', start);
+        std::string item = header.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? header.size() : comma + 1;
+        std::size_t equals = item.find('=');
+        if (equals == std::string::npos) continue;
+        std::string key = trim(item.substr(0, equals));
+        std::string value = trim(item.substr(equals + 1));
+        if (key == "x" && !parseCount(value, patternWidth)) patternWidth = -1;
+        if (key == "y" && !parseCount(value, patternHeight)) patternHeight = -1;
+    }
+    if (patternWidth < 0 || patternHeight < 0) {
+        error = "bad RLE header: " + header;
+        return false;
+    }
+
+    int fieldWidth, fieldHeight;
+    if (!fieldSize(patternWidth, width, torus.width, game.getWidth(), fieldWidth) ||
+        !fieldSize(patternHeight, height, torus.height, game.getHeight(), fieldHeight)) {
+        error = "pattern does not fit the field";
+        return false;
+    }
+    BitGrid grid(fieldWidth, fieldHeight);
+    long long left = (fieldWidth - patternWidth) / 2;
+    long long top = (fieldHeight - patternHeight) / 2;
+
+    // тело: <число><тег>, b — мертвые, o — живые, $ — конец строки, ! — конец образца.
+    // В записи Generations живая клетка — A, умирающие состояния B.. при загрузке не сохраняются.
+    long long row = 0, col = 0, count = 0;
+    bool prefix = false; // p..y перед буквой — состояние больше 24, живым оно не бывает
+    for (int c = reader.get(); c != EOF && c != '!'; c = reader.get()) {
+        if (std::isdigit(c)) {
+            count = count * 10 + (c - '0');
+            if (count > (1LL << 40)) {
+                error = "run length too large at line " + std::to_string(reader.getLine());
+                return false;
+            }
+            continue;
+        }
+        if (std::isspace(c)) {
+            continue;
+        }
+        long long run = count > 0 ? count : 1;
+        count = 0;
+        if (c == '$') {
+            row += run;
+            col = 0;
+        } else if ((c == 'o' || c == 'A') && !prefix) {
+            if (row >= patternHeight || col + run > patternWidth) {
+                error = "pattern exceeds its declared size at line " + std::to_string(reader.getLine());
+                return false;
+            }
+            fillRun(grid, static_cast<int>(top + row), left + col, run);
+            col += run;
+        } else if (c == 'b' || c == '.' || (c >= 'A' && c <= 'X')) {
+            col += run;
+        } else if (c >= 'p' && c <= 'y') {
+            prefix = true;
+            count = run > 1 ? run : 0;
+            continue;
+        } else {
+            error = std::string("unexpected character '") + static_cast<char>(c) + "' at line " +
+                    std::to_string(reader.getLine());
+            return false;
+        }
+        prefix = false;
+    }
+    return apply(game, std::move(grid), rule, generation, error);
+}
+
+// построчная запись тела RLE с переносом длинных строк
+class RleWriter {
+public:
+    explicit RleWriter(std::ostream& out) : out(out), lineLength(0) {}
+
+    void put(long long count, char tag) {
+        if (count <= 0) return;
+        std::string token = count > 1 ? std::to_string(count) + tag : std::string(1, tag);
+        if (lineLength + static_cast<int>(token.size()) > RLE_LINE_LENGTH) {
+            out << '\n';
+            lineLength = 0;
+        }
+        out << token;
+        lineLength += static_cast<int>(token.size());
+    }
+
+    void finish() {
+        put(1, '!');
+        out << '\n';
+    }
+
+private:
+    std::ostream& out;
+    int lineLength;
+};
+
+// сколько клеток подряд начиная с col имеют состояние alive
+long long runLength(const std::uint64_t* words, int col, int width, bool alive) {
+    long long length = 0;
+    while (col < width) {
+        int bit = col % BitGrid::WORD_BITS;
+        std::uint64_t word = (alive ? words[col / BitGrid::WORD_BITS] : ~words[col / BitGrid::WORD_BITS]) >> bit;
+        int available = BitGrid::WORD_BITS - bit;
+        int same = ~word == 0 ? available : std::min(available, __builtin_ctzll(~word));
+        same = std::min(same, width - col);
+        length += same;
+        col += same;
+        if (same < available) break;
+    }
+    return length;
+}
+
+bool saveRle(std::ostream& out, const GameOfLifeCore& game) {
+    const BitGrid& grid = game.getGrid();
+    int width = grid.getWidth();
+    out << "#CXRLE Pos=0,0 Gen=" << game.getGeneration() << '\n';
+    out << "x = " << width << ", y = " << grid.getHeight() << ", rule = " << ruleWithTorus(game) << '\n';
+
+    RleWriter writer(out);
+    long long pendingRows = 0; // концы строк копятся, чтобы пустые строки ушли одним "n$"
+    for (int row = 0; row < grid.getHeight(); ++row) {
+        const std::uint64_t* words = grid.row(row);
+        bool empty = true;
+        for (int w = 0; w < grid.getWordsPerRow(); ++w) {
+            if (words[w]) {
+                empty = false;
+                break;
+            }
+        }
+        if (!empty) {
+            writer.put(pendingRows, '$');
+            pendingRows = 0;
+            int col = 0;
+            while (col < width) {
+                long long dead = runLength(words, col, width, false);
+                if (col + dead >= width) break; // мертвые клетки в конце строки не пишутся
+                writer.put(dead, 'b');
+                col += static_cast<int>(dead);
+                long long alive = runLength(words, col, width, true);
+                writer.put(alive, 'o');
+                col += static_cast<int>(alive);
+            }
+        }
+        ++pendingRows;
+    }
+    writer.finish();
+    return static_cast<bool>(out);
+}
+
+// ---------------------------------------------------------------- Macrocell
+
+struct MacroNode {
+    int level;                 // LEAF_LEVEL у листа
+    std::uint32_t children[4]; // nw, ne, sw, se; 0 — пустой узел
+    std::uint64_t leaf;        // бит r * 8 + c — клетка (r, c) листа
+};
+
+// рамка живых клеток узла относительно его левого верхнего угла
+struct Box {
+    long long minX, minY, maxX, maxY;
+    bool empty;
+};
+
+Box unite(Box a, const Box& b, long long dx, long long dy) {
+    if (b.empty) return a;
+    Box shifted = {b.minX + dx, b.minY + dy, b.maxX + dx, b.maxY + dy, false};
+    if (a.empty) return shifted;
+    return {std::min(a.minX, shifted.minX), std::min(a.minY, shifted.minY),
+            std::max(a.maxX, shifted.maxX), std::max(a.maxY, shifted.maxY), false};
+}
+
+class MacrocellLoader {
+public:
+    bool read(Reader& reader, std::string& error) {
+        nodes.push_back(MacroNode{0, {0, 0, 0, 0}, 0}); // номер 0 — пустой узел
+        reader.readLine();                              // "[M2] (...)"
+        for (;;) {
+            reader.skipSpaces();
+            if (reader.peek() == EOF) break;
+            std::string line = reader.readLine();
+            if (line[0] == '#') {
+                if (line.size() > 2 && line[1] == 'R' && !parseRule(line.substr(2), rule, torus)) {
+                    error = "unsupported rule: " + trim(line.substr(2));
+                    return false;
+                }
+                if (line.size() > 2 && line[1] == 'G') {
+                    parseCount(trim(line.substr(2)), generation);
+                }
+                continue;
+            }
+            if (!(std::isdigit(static_cast<unsigned char>(line[0])) ? readNode(line) : readLeaf(line))) {
+                error = "bad macrocell node at line " + std::to_string(reader.getLine() - 1);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool build(GameOfLifeCore& game, std::string& error, int width, int height) {
+        std::uint32_t root = static_cast<std::uint32_t>(nodes.size() - 1);
+        boxes.assign(nodes.size(), Box{0, 0, 0, 0, true});
+        for (std::uint32_t id = 1; id < nodes.size(); ++id) {
+            boxes[id] = computeBox(id); // дети всегда записаны раньше родителя
+        }
+        const Box& box = boxes[root];
+        // С размером тора образец — все поле от угла корня, как его пишет save; иначе — рамка живых клеток
+        bool anchored = torus.width > 0 && torus.height > 0;
+        if (anchored && !box.empty && (box.maxX >= torus.width || box.maxY >= torus.height)) {
+            error = "pattern exceeds its declared size";
+            return false;
+        }
+        long long originX = anchored || box.empty ? 0 : box.minX;
+        long long originY = anchored || box.empty ? 0 : box.minY;
+        long long patternWidth = anchored ? torus.width : box.empty ? 0 : box.maxX - box.minX + 1;
+        long long patternHeight = anchored ? torus.height : box.empty ? 0 : box.maxY - box.minY + 1;
+        int fieldWidth, fieldHeight;
+        if (!fieldSize(patternWidth, width, torus.width, game.getWidth(), fieldWidth) ||
+            !fieldSize(patternHeight, height, torus.height, game.getHeight(), fieldHeight)) {
+            error = "pattern does not fit the field";
+            return false;
+        }
+        BitGrid grid(fieldWidth, fieldHeight);
+        if (!box.empty) {
+            draw(grid, root, (fieldWidth - patternWidth) / 2 - originX, (fieldHeight - patternHeight) / 2 - originY);
+        }
+        return apply(game, std::move(grid), rule, generation, error);
+    }
+
+private:
+    // строки листа через $, в строке . — мертвая клетка, * — живая
+    bool readLeaf(const std::string& line) {
+        std::uint64_t bits = 0;
+        int r = 0, c = 0;
+        for (char ch : line) {
+            if (ch == '$') {
+                ++r;
+                c = 0;
+            } else if (ch == '.' || ch == '*') {
+                if (r >= 8 || c >= 8) return false;
+                if (ch == '*') bits |= std::uint64_t(1) << (r * 8 + c);
+                ++c;
+            } else if (!std::isspace(static_cast<unsigned char>(ch))) {
+                return false;
+            }
+        }
+        nodes.push_back(MacroNode{LEAF_LEVEL, {0, 0, 0, 0}, bits});
+        return true;
+    }
+
+    // "уровень nw ne sw se", дети — номера уже прочитанных узлов
+    bool readNode(const std::string& line) {
+        long long values[5];
+        const char* text = line.c_str();
+        for (long long& value : values) {
+            while (*text == ' ') ++text;
+            if (!std::isdigit(static_cast<unsigned char>(*text))) return false;
+            value = 0;
+            for (; std::isdigit(static_cast<unsigned char>(*text)); ++text) {
+                value = value * 10 + (*text - '0');
+                if (value > UINT32_MAX) return false;
+            }
+        }
+        // узлы ниже листа 8x8 бывают только у многоцветных правил, их не поддерживаем
+        if (values[0] <= LEAF_LEVEL || values[0] > MAX_LEVEL) return false;
+        MacroNode node{static_cast<int>(values[0]), {0, 0, 0, 0}, 0};
+        for (int i = 0; i < 4; ++i) {
+            long long child = values[i + 1];
+            if (child >= static_cast<long long>(nodes.size())) return false;
+            if (child != 0 && nodes[child].level != node.level - 1) return false;
+            node.children[i] = static_cast<std::uint32_t>(child);
+        }
+        nodes.push_back(node);
+        return true;
+    }
+
+    Box computeBox(std::uint32_t id) const {
+        const MacroNode& node = nodes[id];
+        Box box{0, 0, 0, 0, true};
+        if (node.level == LEAF_LEVEL) {
+            if (node.leaf == 0) return box;
+            std::uint64_t columns = 0; // столбцы, где есть живые клетки
+            for (int r = 0; r < 8; ++r) {
+                columns |= (node.leaf >> (r * 8)) & 0xFF;
+            }
+            return Box{__builtin_ctzll(columns), __builtin_ctzll(node.leaf) / 8,
+                       63 - __builtin_clzll(columns), (63 - __builtin_clzll(node.leaf)) / 8, false};
+        }
+        long long half = 1LL << (node.level - 1);
+        for (int i = 0; i < 4; ++i) {
+            box = unite(box, boxes[node.children[i]], (i % 2) * half, (i / 2) * half);
+        }
+        return box;
+    }
+
+    // раскладывает узел с левым верхним углом (x, y) в координатах поля
+    void draw(BitGrid& grid, std::uint32_t id, long long x, long long y) const {
+        const MacroNode& node = nodes[id];
+        if (boxes[id].empty) return;
+        if (node.level == LEAF_LEVEL) {
+            for (int r = 0; r < 8; ++r) {
+                std::uint64_t bits = (node.leaf >> (r * 8)) & 0xFF;
+                if (!bits) continue;
+                long long col = x;
+                if (col < 0) { // живые клетки листа внутри поля, пустые столбцы могут выходить за край
+                    bits >>= -col;
+                    col = 0;
+                }
+                std::uint64_t* words = grid.row(static_cast<int>(y + r));
+                int bit = static_cast<int>(col % BitGrid::WORD_BITS);
+                words[col / BitGrid::WORD_BITS] |= bits << bit;
+                if (bit > BitGrid::WORD_BITS - 8 && (bits >> (BitGrid::WORD_BITS - bit))) {
+                    words[col / BitGrid::WORD_BITS + 1] |= bits >> (BitGrid::WORD_BITS - bit);
+                }
+            }
+            return;
+        }
+        long long half = 1LL << (node.level - 1);
+        for (int i = 0; i < 4; ++i) {
+            draw(grid, node.children[i], x + (i % 2) * half, y + (i / 2) * half);
+        }
+    }
+
+    std::vector<MacroNode> nodes;
+    std::vector<Box> boxes;
+    LifeRule rule;
+    Torus torus;
+    long long generation = 0;
+};
+
+// Запись квадродерева: одинаковые поддеревья пишутся один раз, номер узла — номер его строки
+class MacrocellWriter {
+public:
+    MacrocellWriter(std::ostream& out, const BitGrid& grid) : out(out), grid(grid), written(0) {}
+
+    void write() {
+        int level = LEAF_LEVEL;
+        while ((1LL << level) < std::max(grid.getWidth(), grid.getHeight())) ++level;
+        if (build(level, 0, 0) == 0) {
+            // пустое поле: один пустой лист, чтобы у файла был корень
+            out << "$\n";
+        }
+    }
+
+private:
+    struct NodeKey {
+        int level;
+        std::uint32_t children[4];
+        bool operator==(const NodeKey& other) const {
+            return level == other.level && std::equal(children, children + 4, other.children);
+        }
+    };
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey& key) const {
+            std::uint64_t hash = static_cast<std::uint64_t>(key.level);
+            for (std::uint32_t child : key.children) {
+                hash = (hash ^ child) * 0x9E3779B97F4A7C15ull;
+            }
+            return static_cast<std::size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    std::uint32_t build(int level, long long x, long long y) {
+        if (x >= grid.getWidth() || y >= grid.getHeight()) return 0;
+        if (level == LEAF_LEVEL) return leaf(x, y);
+        long long half = 1LL << (level - 1);
+        NodeKey key{level, {build(level - 1, x, y), build(level - 1, x + half, y),
+                            build(level - 1, x, y + half), build(level - 1, x + half, y + half)}};
+        if (!key.children[0] && !key.children[1] && !key.children[2] && !key.children[3]) return 0;
+        auto found = nodeIds.find(key);
+        if (found != nodeIds.end()) return found->second;
+        out << level << ' ' << key.children[0] << ' ' << key.children[1] << ' ' << key.children[2] << ' '
+            << key.children[3] << '\n';
+        return nodeIds[key] = ++written;
+    }
+
+    std::uint32_t leaf(long long x, long long y) {
+        // x кратно 8, так что байт строки листа целиком лежит в одном слове
+        std::uint64_t bits = 0;
+        for (int r = 0; r < 8 && y + r < grid.getHeight(); ++r) {
+            std::uint64_t word = grid.row(static_cast<int>(y + r))[x / BitGrid::WORD_BITS];
+            bits |= ((word >> (x % BitGrid::WORD_BITS)) & 0xFF) << (r * 8);
+        }
+        if (!bits) return 0;
+        auto found = leafIds.find(bits);
+        if (found != leafIds.end()) return found->second;
+
+        std::string line;
+        int lastRow = 7;
+        while (((bits >> (lastRow * 8)) & 0xFF) == 0) --lastRow;
+        for (int r = 0; r <= lastRow; ++r) {
+            std::uint64_t rowBits = (bits >> (r * 8)) & 0xFF;
+            for (int c = 0; rowBits >> c; ++c) {
+                line += (rowBits >> c) & 1u ? '*' : '.';
+            }
+            line += '$';
+        }
+        out << line << '\n';
+        return leafIds[bits] = ++written;
+    }
+
+    std::ostream& out;
+    const BitGrid& grid;
+    std::uint32_t written;
+    std::unordered_map<std::uint64_t, std::uint32_t> leafIds;
+    std::unordered_map<NodeKey, std::uint32_t, NodeKeyHash> nodeIds;
+};
+
+bool saveMacrocell(std::ostream& out, const GameOfLifeCore& game) {
+    out << "[M2] (GameOfLife)\n#R " << ruleWithTorus(game) << '\n';
+    if (game.getGeneration() > 0) {
+        out << "#G " << game.getGeneration() << '\n';
+    }
+    MacrocellWriter(out, game.getGrid()).write();
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+bool load(std::istream& in, GameOfLifeCore& game, std::string& error, int width, int height) {
+    Reader reader(in);
+    reader.skipSpaces();
+    if (reader.peek() == '[') {
+        MacrocellLoader loader;
+        return loader.read(reader, error) && loader.build(game, error, width, height);
+    }
+    return loadRle(reader, game, error, width, height);
+}
+
+bool loadFile(const std::string& path, GameOfLifeCore& game, std::string& error, int width, int height) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return load(in, game, error, width, height);
+}
+
+bool save(std::ostream& out, const GameOfLifeCore& game, Format format) {
+    return format == Format::Macrocell ? saveMacrocell(out, game) : saveRle(out, game);
+}
+
+bool saveFile(const std::string& path, const GameOfLifeCore& game, Format format) {
+    std::ofstream out(path, std::ios::binary);
+    return out && save(out, game, format);
+}
+
+Format formatFromPath(const std::string& path) {
+    std::size_t dot = path.rfind('.');
+    std::string extension = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    for (char& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == "mc" ? Format::Macrocell : Format::Rle;
+}
+
+} // namespace PatternIO
@@ -0,0 +1,285 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler {
+
+std::atomic<bool> enabledFlag{false};
+std::atomic<bool> tracingFlag{false};
+
+const int Histogram::LINEAR;
+const int Histogram::SUB_BUCKETS;
+const int Histogram::BUCKETS;
+
+namespace {
+
+const int METRICS = static_cast<int>(Metric::Count);
+
+// событие трассы: начало и упакованные (значение << 8 | метрика); у длительностей значение — длина
+struct TraceEvent {
+    std::atomic<std::uint64_t> start;
+    std::atomic<std::uint64_t> packed;
+};
+
+// Замеры одного потока. Пишет только сам поток, поэтому увеличение — загрузка и запись,
+// а не атомарное сложение с блокировкой шины; читатели видят значения без разрывов.
+struct ThreadData {
+    std::atomic<std::uint64_t> counts[METRICS][Histogram::BUCKETS];
+    std::atomic<std::uint64_t> count[METRICS];
+    std::atomic<std::uint64_t> sum[METRICS];
+    std::atomic<std::uint64_t> last[METRICS];
+    std::atomic<std::uint64_t> lastTime[METRICS];
+    std::atomic<std::uint64_t> traceWritten;
+    std::unique_ptr<TraceEvent[]> trace;
+    std::string name;
+    int id;
+};
+
+inline void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// данные потоков живут до конца программы: оверлей может читать замеры уже завершенного потока
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadData>> registry;
+thread_local ThreadData* current = nullptr;
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+ThreadData& currentThread() {
+    if (!current) {
+        std::unique_ptr<ThreadData> data(new ThreadData()); // () обнуляет счетчики
+        data->trace.reset(new TraceEvent[TRACE_EVENTS]());
+        std::lock_guard<std::mutex> lock(registryMutex);
+        data->id = static_cast<int>(registry.size()) + 1;
+        data->name = "thread " + std::to_string(data->id);
+        current = data.get();
+        registry.push_back(std::move(data));
+    }
+    return *current;
+}
+
+void writeEscaped(std::FILE* out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            std::fputc(c, out);
+        }
+    }
+}
+
+} // namespace
+
+const char* metricName(Metric metric) {
+    switch (metric) {
+    case Metric::Step: return "step";
+    case Metric::Publish: return "publish";
+    case Metric::Frame: return "frame";
+    case Metric::Render: return "render";
+    case Metric::Upload: return "upload";
+    case Metric::DrawCalls: return "draw calls";
+    case Metric::Population: return "population";
+    case Metric::CellsChanged: return "cells changed";
+    default: return "";
+    }
+}
+
+bool isDuration(Metric metric) {
+    return metric <= Metric::Upload;
+}
+
+int Histogram::bucketOf(std::uint64_t value) {
+    if (value < static_cast<std::uint64_t>(LINEAR)) {
+        return static_cast<int>(value);
+    }
+    int exponent = 63 - __builtin_clzll(value); // не меньше 4
+    int sub = static_cast<int>((value >> (exponent - 3)) & (SUB_BUCKETS - 1));
+    return LINEAR + (exponent - 4) * SUB_BUCKETS + sub;
+}
+
+std::uint64_t Histogram::bucketValue(int bucket) {
+    if (bucket < LINEAR) {
+        return static_cast<std::uint64_t>(bucket);
+    }
+    int exponent = (bucket - LINEAR) / SUB_BUCKETS + 4;
+    std::uint64_t sub = static_cast<std::uint64_t>((bucket - LINEAR) % SUB_BUCKETS);
+    std::uint64_t width = std::uint64_t(1) << (exponent - 3);
+    return (SUB_BUCKETS + sub) * width + width / 2;
+}
+
+std::uint64_t Histogram::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * count + 0.5));
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= target) {
+            return bucketValue(bucket);
+        }
+    }
+    return bucketValue(BUCKETS - 1);
+}
+
+void Histogram::subtract(const Histogram& earlier) {
+    for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+        counts[bucket] -= earlier.counts[bucket];
+    }
+    count -= earlier.count;
+    sum -= earlier.sum;
+}
+
+void Summary::subtract(const Summary& earlier) {
+    for (int metric = 0; metric < METRICS; ++metric) {
+        metrics[metric].subtract(earlier.metrics[metric]);
+    }
+}
+
+void setEnabled(bool enabled) {
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+    if (!enabled) {
+        tracingFlag.store(false, std::memory_order_relaxed);
+    }
+}
+
+void setTracing(bool tracing) {
+    if (tracing && !isTracing()) {
+        // новая запись начинается с пустых колец: события прошлой записи в трассу не попадут
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<ThreadData>& data : registry) {
+            data->traceWritten.store(0, std::memory_order_relaxed);
+        }
+    }
+    if (tracing) {
+        enabledFlag.store(true, std::memory_order_relaxed);
+    }
+    tracingFlag.store(tracing, std::memory_order_relaxed);
+}
+
+std::uint64_t now() {
+    // +1: ноль в ScopedTimer означает «не замерялось»
+    return static_cast<std::uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count()) + 1;
+}
+
+void recordValue(Metric metric, std::uint64_t value, std::uint64_t start) {
+    ThreadData& data = currentThread();
+    int index = static_cast<int>(metric);
+    add(data.counts[index][Histogram::bucketOf(value)], 1);
+    add(data.count[index], 1);
+    add(data.sum[index], value);
+    std::uint64_t time = start != 0 ? start : now();
+    data.last[index].store(value, std::memory_order_relaxed);
+    data.lastTime[index].store(time, std::memory_order_relaxed);
+
+    if (isTracing()) {
+        std::uint64_t written = data.traceWritten.load(std::memory_order_relaxed);
+        TraceEvent& event = data.trace[written % TRACE_EVENTS];
+        event.start.store(time, std::memory_order_relaxed);
+        event.packed.store(value << 8 | static_cast<std::uint64_t>(index), std::memory_order_relaxed);
+        data.traceWritten.store(written + 1, std::memory_order_release);
+    }
+}
+
+void setThreadName(const char* name) {
+    ThreadData& data = currentThread();
+    std::lock_guard<std::mutex> lock(registryMutex); // имя читает writeTrace()
+    data.name = name;
+}
+
+Summary collect() {
+    Summary summary;
+    std::uint64_t newest[METRICS] = {};
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const std::unique_ptr<ThreadData>& data : registry) {
+        for (int metric = 0; metric < METRICS; ++metric) {
+            Histogram& histogram = summary.metrics[metric];
+            for (int bucket = 0; bucket < Histogram::BUCKETS; ++bucket) {
+                histogram.counts[bucket] += data->counts[metric][bucket].load(std::memory_order_relaxed);
+            }
+            histogram.count += data->count[metric].load(std::memory_order_relaxed);
+            histogram.sum += data->sum[metric].load(std::memory_order_relaxed);
+            std::uint64_t time = data->lastTime[metric].load(std::memory_order_relaxed);
+            if (time > newest[metric]) {
+                newest[metric] = time;
+                summary.last[metric] = data->last[metric].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return summary;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const std::unique_ptr<ThreadData>& data : registry) {
+        for (int metric = 0; metric < METRICS; ++metric) {
+            for (int bucket = 0; bucket < Histogram::BUCKETS; ++bucket) {
+                data->counts[metric][bucket].store(0, std::memory_order_relaxed);
+            }
+            data->count[metric].store(0, std::memory_order_relaxed);
+            data->sum[metric].store(0, std::memory_order_relaxed);
+            data->last[metric].store(0, std::memory_order_relaxed);
+            data->lastTime[metric].store(0, std::memory_order_relaxed);
+        }
+        data->traceWritten.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool writeTrace(const std::string& path, std::string& error) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        error = "cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    bool tracing = isTracing();
+    tracingFlag.store(false, std::memory_order_relaxed);
+
+    std::fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    const char* separator = "";
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const std::unique_ptr<ThreadData>& data : registry) {
+        std::fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"",
+                     separator, data->id);
+        writeEscaped(out, data->name);
+        std::fprintf(out, "\"}}");
+        separator = ",\n";
+
+        std::uint64_t written = data->traceWritten.load(std::memory_order_acquire);
+        std::uint64_t first = written > static_cast<std::uint64_t>(TRACE_EVENTS) ? written - TRACE_EVENTS : 0;
+        for (std::uint64_t i = first; i < written; ++i) {
+            const TraceEvent& event = data->trace[i % TRACE_EVENTS];
+            std::uint64_t packed = event.packed.load(std::memory_order_relaxed);
+            Metric metric = static_cast<Metric>(packed & 0xFF);
+            std::uint64_t value = packed >> 8;
+            double start = event.start.load(std::memory_order_relaxed) / 1000.0; // трасса — в микросекундах
+            if (isDuration(metric)) {
+                std::fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                             metricName(metric), data->id, start, value / 1000.0);
+            } else {
+                std::fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, "
+                                  "\"args\": {\"value\": %llu}}",
+                             metricName(metric), data->id, start, static_cast<unsigned long long>(value));
+            }
+        }
+    }
+    std::fprintf(out, "\n]}\n");
+    tracingFlag.store(tracing, std::memory_order_relaxed);
+
+    bool ok = std::fflush(out) == 0 && !std::ferror(out);
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) {
+        error = "cannot write " + path;
+    }
+    return ok;
+}
+
+} // namespace Profiler
@@ -0,0 +1,71 @@
+#include "Scheduler.hpp"
+#include <algorithm>
+
+const int Scheduler::MAX_BACKLOG;
+constexpr double Scheduler::MAX_CATCH_UP_SECONDS;
+constexpr double Scheduler::DEFAULT_RATE;
+
+Scheduler::Scheduler()
+    : mode(Mode::FixedRate), targetRate(DEFAULT_RATE), last(Clock::now()), accumulator(0) {}
+
+void Scheduler::setMode(Mode newMode) {
+    mode = newMode;
+}
+
+Scheduler::Mode Scheduler::getMode() const {
+    return mode;
+}
+
+void Scheduler::setTargetRate(double generationsPerSecond) {
+    if (generationsPerSecond > 0) {
+        targetRate = generationsPerSecond;
+    }
+}
+
+double Scheduler::getTargetRate() const {
+    return targetRate;
+}
+
+void Scheduler::restart(Clock::time_point now) {
+    last = now;
+    accumulator = Clock::duration(0);
+}
+
+int Scheduler::advance(Clock::time_point now) {
+    if (mode == Mode::Uncapped) {
+        last = now;
+        return 1; // по одному поколению, чтобы правки применялись без задержки
+    }
+
+    accumulator += now - last;
+    last = now;
+    Clock::duration step = period();
+    long long due = accumulator / step;
+
+    if (mode == Mode::FixedRate && due > MAX_BACKLOG) {
+        // ядро не успевает за целевой скоростью: замедляемся вместо лавины долгов
+        accumulator = Clock::duration(0);
+        return MAX_BACKLOG;
+    }
+    if (mode == Mode::FrameSkip) {
+        long long maxDue = std::max(1LL, static_cast<long long>(MAX_CATCH_UP_SECONDS * targetRate));
+        if (due > maxDue) {
+            accumulator = Clock::duration(0);
+            return static_cast<int>(maxDue);
+        }
+    }
+    accumulator -= due * step;
+    return static_cast<int>(due);
+}
+
+Scheduler::Clock::time_point Scheduler::nextDeadline() const {
+    if (mode == Mode::Uncapped) {
+        return last;
+    }
+    return last + (period() - accumulator);
+}
+
+Scheduler::Clock::duration Scheduler::period() const {
+    auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetRate));
+    return std::max(step, Clock::duration(1));
+}
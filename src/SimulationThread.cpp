@@ -0,0 +1,212 @@
+#include "SimulationThread.hpp"
+#include "Profiler.hpp"
+
+namespace {
+
+SimulationThread::Snapshot initialSnapshot(const GameOfLifeCore& game) {
+    SimulationThread::Snapshot snapshot;
+    snapshot.grid = game.getGrid();
+    snapshot.generation = game.getGeneration();
+    snapshot.cycleState = game.getCycles().getState();
+    snapshot.period = game.getCycles().getPeriod();
+    const ActivityTracker& activity = game.getActivity();
+    snapshot.tileVersions.assign(static_cast<std::size_t>(activity.getTilesX()) * activity.getTilesY(), 0);
+    return snapshot;
+}
+
+} // namespace
+
+SimulationThread::SimulationThread(GameOfLifeCore& game)
+    : game(game), snapshots(initialSnapshot(game)),
+      stopping(false), running(false), version(0),
+      tileVersions(snapshots.getReadBuffer().tileVersions), checkpointEvery(0) {}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    if (worker.joinable()) {
+        return;
+    }
+    stopping = false;
+    worker = std::thread(&SimulationThread::loop, this);
+}
+
+void SimulationThread::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    worker.join();
+}
+
+void SimulationThread::setRunning(bool newRunning) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running == newRunning) {
+            return;
+        }
+        running = newRunning;
+        scheduler.restart(Clock::now()); // время на паузе не превращается в отставание
+    }
+    wakeUp.notify_one();
+}
+
+void SimulationThread::setMode(Scheduler::Mode mode) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scheduler.setMode(mode);
+        scheduler.restart(Clock::now());
+    }
+    wakeUp.notify_one();
+}
+
+void SimulationThread::setTargetRate(double generationsPerSecond) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scheduler.setTargetRate(generationsPerSecond);
+    }
+    wakeUp.notify_one();
+}
+
+void SimulationThread::post(const Command& command) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(command);
+    }
+    wakeUp.notify_one();
+}
+
+void SimulationThread::setCheckpointing(const std::string& path, int everyGenerations) {
+    checkpointEvery = everyGenerations > 0 ? everyGenerations : 0;
+    checkpoints = checkpointEvery > 0 ? std::make_unique<CheckpointWriter>(path) : nullptr;
+}
+
+bool SimulationThread::acquireSnapshot() {
+    return snapshots.acquire();
+}
+
+const SimulationThread::Snapshot& SimulationThread::getSnapshot() const {
+    return snapshots.getReadBuffer();
+}
+
+// Поток ждет правок или времени следующего поколения (его назначает scheduler).
+// Правки применяются перед шагом, так что окно никогда не пишет в поле, которое сейчас
+// считается. Поколения, которые окно не увидит, не копируются в снимок: из пачки
+// поколений публикуется только последнее, а в режиме Uncapped снимок обновляется, только
+// когда окно забрало предыдущий.
+void SimulationThread::loop() {
+    Profiler::setThreadName("simulation");
+    bool unpublished = false; // в поле есть поколения, которых нет в снимке
+    while (true) {
+        int due = 0;
+        bool waitForReader;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && pending.empty()) {
+                if (unpublished && !(running && scheduler.getMode() == Scheduler::Mode::Uncapped)) {
+                    break; // остановились посреди пачки: показываем то, что уже посчитано
+                }
+                if (!running) {
+                    wakeUp.wait(lock);
+                    continue;
+                }
+                Clock::time_point deadline = scheduler.nextDeadline();
+                if (Clock::now() >= deadline) {
+                    break;
+                }
+                wakeUp.wait_until(lock, deadline);
+            }
+            if (stopping) {
+                break;
+            }
+            applying.swap(pending);
+            if (running) {
+                due = scheduler.advance(Clock::now());
+            }
+            waitForReader = scheduler.getMode() == Scheduler::Mode::Uncapped;
+        }
+
+        if (applyCommands()) {
+            markChangedTiles();
+            unpublished = true;
+        }
+        for (int i = 0; i < due; ++i) {
+            game.update();
+            markChangedTiles();
+            unpublished = true;
+            if (checkpoints && game.getGeneration() % checkpointEvery == 0) {
+                checkpoints->request(game.getGrid(), game.getRule(), static_cast<std::uint64_t>(game.getGeneration()));
+            }
+        }
+        if (unpublished && (!waitForReader || snapshots.wasRead() || due == 0)) {
+            publish();
+            unpublished = false;
+        }
+    }
+    if (unpublished) {
+        publish();
+    }
+}
+
+bool SimulationThread::applyCommands() {
+    bool edited = !applying.empty();
+    for (const Command& command : applying) {
+        switch (command.type) {
+        case Command::Type::SetCell:
+            game.setCell(command.row, command.col, command.alive);
+            break;
+        case Command::Type::Reset:
+            game.reset();
+            break;
+        case Command::Type::History:
+            game.setHistoryBudget(command.alive ? GenerationHistory::DEFAULT_BUDGET : 0);
+            break;
+        case Command::Type::CommitEdit:
+            game.commitEdit();
+            break;
+        case Command::Type::Undo:
+            game.undo();
+            break;
+        case Command::Type::Redo:
+            game.redo();
+            break;
+        case Command::Type::Seek:
+            game.seekGeneration(command.generation);
+            break;
+        }
+    }
+    applying.clear();
+    return edited;
+}
+
+// Помечает плитки, изменившиеся за последнее поколение или правку. Окно может пропустить
+// несколько поколений, поэтому хранится не список, а номер последнего изменения плитки.
+void SimulationThread::markChangedTiles() {
+    const std::vector<int>& changedTiles = game.getActivity().getChangedTiles();
+    if (changedTiles.empty()) {
+        return; // устоявшееся поле: окну нечего перерисовывать
+    }
+    ++version;
+    for (int tile : changedTiles) {
+        tileVersions[tile] = version;
+    }
+}
+
+// копирует поле в свободный буфер снимка; размеры совпадают, так что память не выделяется
+void SimulationThread::publish() {
+    Profiler::ScopedTimer timer(Profiler::Metric::Publish);
+    Snapshot& snapshot = snapshots.getWriteBuffer();
+    snapshot.grid = game.getGrid();
+    snapshot.generation = game.getGeneration();
+    snapshot.cycleState = game.getCycles().getState();
+    snapshot.period = game.getCycles().getPeriod();
+    snapshot.version = version;
+    snapshot.tileVersions = tileVersions;
+    snapshots.publish();
+}
@@ -0,0 +1,337 @@
+#include "SoupSearch.hpp"
+#include "GameOfLifeCore.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace SoupSearch {
+
+namespace {
+
+// диапазон номеров супов одного потока; своя строка кэша, чтобы потоки не мешали друг другу
+struct alignas(64) WorkRange {
+    std::mutex mutex;
+    std::uint64_t begin = 0;
+    std::uint64_t end = 0;
+};
+
+bool takeOwn(WorkRange& range, std::uint64_t& index) {
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin == range.end) {
+        return false;
+    }
+    index = range.begin++;
+    return true;
+}
+
+// Забирает верхнюю половину самого большого чужого остатка: одну задачу себе, остальное
+// в свой диапазон. Супы живут очень по-разному, так что без кражи потоки простаивали бы
+// в конце прогона, дожидаясь одного долгого диапазона.
+bool steal(WorkRange* ranges, int count, int self, std::uint64_t& index) {
+    while (true) {
+        int victim = -1;
+        std::uint64_t largest = 0;
+        for (int other = 0; other < count; ++other) {
+            if (other == self) continue;
+            std::lock_guard<std::mutex> lock(ranges[other].mutex);
+            std::uint64_t remaining = ranges[other].end - ranges[other].begin;
+            if (remaining > largest) {
+                largest = remaining;
+                victim = other;
+            }
+        }
+        if (victim < 0) {
+            return false; // работы не осталось нигде
+        }
+        std::uint64_t begin;
+        std::uint64_t end;
+        {
+            std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+            std::uint64_t remaining = ranges[victim].end - ranges[victim].begin;
+            if (remaining == 0) {
+                continue; // пока искали, остаток разобрали
+            }
+            end = ranges[victim].end;
+            begin = end - (remaining + 1) / 2;
+            ranges[victim].end = begin;
+        }
+        std::lock_guard<std::mutex> lock(ranges[self].mutex);
+        ranges[self].begin = begin + 1;
+        ranges[self].end = end;
+        index = begin;
+        return true;
+    }
+}
+
+void addResult(Report& report, const SoupResult& result, std::uint64_t index) {
+    report.soups++;
+    report.populationSum += result.population;
+    report.maxPopulation = std::max(report.maxPopulation, result.population);
+    report.objectSum += static_cast<std::uint64_t>(result.objects);
+    if (!result.settled) {
+        return;
+    }
+    report.settled++;
+    report.lifespanSum += static_cast<std::uint64_t>(result.lifespan);
+    if (report.settled == 1 || result.lifespan > report.maxLifespan ||
+        (result.lifespan == report.maxLifespan && index < report.maxLifespanSoup)) {
+        report.maxLifespan = result.lifespan;
+        report.maxLifespanSoup = index;
+    }
+    if (result.extinct) {
+        report.extinct++;
+    } else {
+        report.periods[result.period]++;
+    }
+}
+
+void merge(Report& total, const Report& part) {
+    if (part.settled > 0 && (total.settled == 0 || part.maxLifespan > total.maxLifespan ||
+                             (part.maxLifespan == total.maxLifespan && part.maxLifespanSoup < total.maxLifespanSoup))) {
+        total.maxLifespan = part.maxLifespan;
+        total.maxLifespanSoup = part.maxLifespanSoup;
+    }
+    total.soups += part.soups;
+    total.settled += part.settled;
+    total.extinct += part.extinct;
+    total.lifespanSum += part.lifespanSum;
+    total.populationSum += part.populationSum;
+    total.maxPopulation = std::max(total.maxPopulation, part.maxPopulation);
+    total.objectSum += part.objectSum;
+    for (const auto& entry : part.periods) {
+        total.periods[entry.first] += entry.second;
+    }
+    for (const auto& entry : part.objects) {
+        total.objects[entry.first] += entry.second;
+    }
+}
+
+// Код формы: строки канонического вида (наименьший код из восьми поворотов и отражений)
+// битовыми масками в hex через '-'. Формы шире 64 клеток не различаются.
+std::string shapeCode(const std::vector<std::pair<int, int>>& cells) {
+    std::string best;
+    std::vector<std::pair<int, int>> transformed(cells.size());
+    std::vector<std::uint64_t> rows;
+    for (int transform = 0; transform < 8; ++transform) {
+        int minRow = 0;
+        int minCol = 0;
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            int r = cells[i].first;
+            int c = cells[i].second;
+            if (transform & 4) std::swap(r, c);
+            if (transform & 1) r = -r;
+            if (transform & 2) c = -c;
+            transformed[i] = {r, c};
+            minRow = i == 0 ? r : std::min(minRow, r);
+            minCol = i == 0 ? c : std::min(minCol, c);
+        }
+        rows.clear();
+        bool tooWide = false;
+        for (const auto& cell : transformed) {
+            int r = cell.first - minRow;
+            int c = cell.second - minCol;
+            if (c >= 64) {
+                tooWide = true;
+                break;
+            }
+            if (static_cast<std::size_t>(r) >= rows.size()) {
+                rows.resize(r + 1, 0);
+            }
+            rows[r] |= std::uint64_t(1) << c;
+        }
+        if (tooWide) {
+            return "big";
+        }
+        std::string code;
+        char hex[20];
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            std::snprintf(hex, sizeof(hex), r == 0 ? "%llx" : "-%llx", static_cast<unsigned long long>(rows[r]));
+            code += hex;
+        }
+        // сравнение сначала по длине, чтобы короткие (компактные) виды выигрывали
+        if (best.empty() || code.size() < best.size() || (code.size() == best.size() && code < best)) {
+            best = code;
+        }
+    }
+    return best;
+}
+
+// клетки формы из рисунка: 'o' — живая клетка, '/' — новая строка
+std::vector<std::pair<int, int>> drawing(const char* picture) {
+    std::vector<std::pair<int, int>> cells;
+    int row = 0;
+    int col = 0;
+    for (const char* p = picture; *p; ++p) {
+        if (*p == '/') {
+            ++row;
+            col = 0;
+            continue;
+        }
+        if (*p == 'o') {
+            cells.emplace_back(row, col);
+        }
+        ++col;
+    }
+    return cells;
+}
+
+// самые частые объекты супов Конвея; у осцилляторов и глайдера — фазы, связные целиком
+const std::map<std::string, std::string>& knownShapes() {
+    static const std::map<std::string, std::string> shapes = [] {
+        const char* table[][2] = {
+            {"block", "oo/oo"},
+            {"blinker", "ooo"},
+            {"beehive", ".oo./o..o/.oo."},
+            {"loaf", ".oo./o..o/.o.o/..o."},
+            {"boat", "oo./o.o/.o."},
+            {"ship", "oo./o.o/.oo"},
+            {"tub", ".o./o.o/.o."},
+            {"pond", ".oo./o..o/o..o/.oo."},
+            {"barge", ".o../o.o./.o.o/..o."},
+            {"longboat", "oo../o.o./.o.o/..o."},
+            {"toad", ".ooo/ooo."},
+            {"beacon", "oo../oo../..oo/..oo"},
+            {"glider", ".o./..o/ooo"},
+            {"glider", "o.o/.oo/.o."},
+        };
+        std::map<std::string, std::string> result;
+        for (const auto& entry : table) {
+            std::vector<std::pair<int, int>> cells = drawing(entry[1]);
+            result["xs" + std::to_string(cells.size()) + "_" + shapeCode(cells)] = entry[0];
+        }
+        return result;
+    }();
+    return shapes;
+}
+
+} // namespace
+
+void fillSoup(BitGrid& grid, const Options& options, std::uint64_t index) {
+    Random random(options.seed, index);
+    int size = std::min({options.soupSize, grid.getWidth(), grid.getHeight()});
+    int top = (grid.getHeight() - size) / 2;
+    int left = (grid.getWidth() - size) / 2;
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; c += BitGrid::WORD_BITS) {
+            std::uint64_t bits = random.nextBits(options.fillPercent);
+            int count = std::min(BitGrid::WORD_BITS, size - c);
+            for (int b = 0; b < count; ++b) {
+                if ((bits >> b) & 1u) {
+                    grid.set(top + r, left + c + b, true);
+                }
+            }
+        }
+    }
+}
+
+SoupResult runSoup(GameOfLifeCore& game, const Options& options, std::uint64_t index, Census* census) {
+    BitGrid grid(game.getWidth(), game.getHeight());
+    fillSoup(grid, options, index);
+    game.setGrid(grid);
+    game.setGeneration(0);
+    while (!game.isFinished() && game.getGeneration() < options.maxGenerations) {
+        game.update();
+    }
+
+    SoupResult result;
+    const CycleDetector& cycles = game.getCycles();
+    result.settled = game.isFinished();
+    result.extinct = cycles.getState() == CycleDetector::State::Extinct;
+    result.period = cycles.getPeriod();
+    // повтор замечается через период после того, как поле вошло в цикл
+    result.lifespan = !result.settled ? game.getGeneration()
+                    : result.extinct  ? cycles.getDetectedAt()
+                                      : cycles.getDetectedAt() - cycles.getPeriod();
+    result.population = game.getPopulation();
+    if (census) {
+        result.objects = countObjects(game.getGrid(), *census);
+    }
+    return result;
+}
+
+Report run(const Options& options) {
+    auto start = std::chrono::steady_clock::now();
+    int threads = std::max(1, options.threads);
+
+    std::vector<std::unique_ptr<GameOfLifeCore>> games;
+    for (int t = 0; t < threads; ++t) {
+        games.push_back(std::make_unique<GameOfLifeCore>(options.fieldWidth, options.fieldHeight));
+        games.back()->setRule(options.rule);
+    }
+    std::unique_ptr<WorkRange[]> ranges(new WorkRange[threads]);
+    for (int t = 0; t < threads; ++t) {
+        ranges[t].begin = options.soups * t / threads;
+        ranges[t].end = options.soups * (t + 1) / threads;
+    }
+    std::vector<Report> partial(threads);
+
+    auto worker = [&](int self) {
+        std::uint64_t index;
+        while (takeOwn(ranges[self], index) || steal(ranges.get(), threads, self, index)) {
+            addResult(partial[self], runSoup(*games[self], options, index, &partial[self].objects), index);
+        }
+    };
+    ThreadPool pool(threads);
+    pool.run(threads, worker);
+
+    Report report;
+    for (const Report& part : partial) {
+        merge(report, part);
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+int countObjects(const BitGrid& grid, Census& census) {
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    BitGrid seen(width, height);
+    std::vector<std::pair<int, int>> stack;
+    std::vector<std::pair<int, int>> cells;
+    int objects = 0;
+    for (int row = 0; row < height; ++row) {
+        const std::uint64_t* words = grid.row(row);
+        for (int w = 0; w < grid.getWordsPerRow(); ++w) {
+            for (std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                int col = w * BitGrid::WORD_BITS + __builtin_ctzll(bits);
+                if (seen.get(row, col)) continue;
+
+                // обход в глубину; координаты не заворачиваются, чтобы форма на краю тора не разорвалась
+                cells.clear();
+                stack.assign(1, {row, col});
+                seen.set(row, col, true);
+                while (!stack.empty()) {
+                    std::pair<int, int> cell = stack.back();
+                    stack.pop_back();
+                    cells.push_back(cell);
+                    for (int dr = -1; dr <= 1; ++dr) {
+                        for (int dc = -1; dc <= 1; ++dc) {
+                            int r = cell.first + dr;
+                            int c = cell.second + dc;
+                            int wrappedRow = ((r % height) + height) % height;
+                            int wrappedCol = ((c % width) + width) % width;
+                            if (grid.get(wrappedRow, wrappedCol) && !seen.get(wrappedRow, wrappedCol)) {
+                                seen.set(wrappedRow, wrappedCol, true);
+                                stack.emplace_back(r, c);
+                            }
+                        }
+                    }
+                }
+                census[objectName(cells)]++;
+                ++objects;
+            }
+        }
+    }
+    return objects;
+}
+
+std::string objectName(const std::vector<std::pair<int, int>>& cells) {
+    std::string code = "xs" + std::to_string(cells.size()) + "_" + shapeCode(cells);
+    auto known = knownShapes().find(code);
+    return known != knownShapes().end() ? known->second : code;
+}
+
+} // namespace SoupSearch
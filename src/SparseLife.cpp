@@ -0,0 +1,218 @@
+#include "SparseLife.hpp"
+#include "LifeKernels.hpp"
+#include <algorithm>
+
+const int SparseLife::CHUNK_SIZE;
+
+namespace {
+
+const int CHUNK_SHIFT = 6; // log2(CHUNK_SIZE)
+const std::uint64_t EMPTY_ROWS[SparseLife::CHUNK_SIZE] = {};
+
+// номер куска и позиция внутри него; сдвиг округляет вниз и для отрицательных координат
+std::int64_t chunkOf(std::int64_t coord) { return coord >> CHUNK_SHIFT; }
+int offsetIn(std::int64_t coord) { return static_cast<int>(coord & (SparseLife::CHUNK_SIZE - 1)); }
+
+} // namespace
+
+std::size_t SparseLife::ChunkKeyHash::operator()(const ChunkKey& key) const {
+    std::uint64_t h = static_cast<std::uint64_t>(key.row) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<std::uint64_t>(key.col) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+SparseLife::SparseLife() : current(0), generation(0) {}
+
+void SparseLife::setCell(std::int64_t row, std::int64_t col, bool alive) {
+    int index = alive ? getOrCreateChunk(chunkOf(row), chunkOf(col)) : findChunk(chunkOf(row), chunkOf(col));
+    if (index == NO_CHUNK) {
+        return; // мертвая клетка в пустой области — менять нечего
+    }
+    std::uint64_t bit = std::uint64_t(1) << offsetIn(col);
+    std::uint64_t& word = pool[index].cells[current][offsetIn(row)];
+    word = alive ? (word | bit) : (word & ~bit);
+}
+
+bool SparseLife::getCell(std::int64_t row, std::int64_t col) const {
+    int index = findChunk(chunkOf(row), chunkOf(col));
+    if (index == NO_CHUNK) {
+        return false;
+    }
+    return (pool[index].cells[current][offsetIn(row)] >> offsetIn(col)) & 1u;
+}
+
+void SparseLife::clear() {
+    pool.clear();
+    freeChunks.clear();
+    liveChunks.clear();
+    chunkIndex.clear();
+}
+
+// Шаг поколения: сначала создаются пустые куски рядом с живыми клетками на краях кусков,
+// затем каждый кусок считается по своим строкам и краевым строкам восьми соседей,
+// и в конце опустевшие куски возвращаются в пул.
+void SparseLife::update() {
+    std::size_t chunksWithCells = liveChunks.size();
+    for (std::size_t i = 0; i < chunksWithCells; ++i) {
+        growBorders(liveChunks[i]);
+    }
+
+    for (int index : liveChunks) {
+        stepChunk(index);
+    }
+    current ^= 1;
+
+    std::size_t kept = 0;
+    for (int index : liveChunks) {
+        const std::uint64_t* rows = pool[index].cells[current];
+        if (std::any_of(rows, rows + CHUNK_SIZE, [](std::uint64_t word) { return word != 0; })) {
+            liveChunks[kept++] = index;
+        } else {
+            releaseChunk(index);
+        }
+    }
+    liveChunks.resize(kept);
+    generation++;
+}
+
+std::uint64_t SparseLife::getGeneration() const {
+    return generation;
+}
+
+void SparseLife::setGeneration(std::uint64_t newGeneration) {
+    generation = newGeneration;
+}
+
+std::size_t SparseLife::getPopulation() const {
+    std::size_t count = 0;
+    for (int index : liveChunks) {
+        for (std::uint64_t word : pool[index].cells[current]) {
+            count += __builtin_popcountll(word);
+        }
+    }
+    return count;
+}
+
+std::size_t SparseLife::getChunkCount() const {
+    return liveChunks.size();
+}
+
+bool SparseLife::getBounds(std::int64_t& minRow, std::int64_t& minCol,
+                           std::int64_t& maxRow, std::int64_t& maxCol) const {
+    bool found = false;
+    for (int index : liveChunks) {
+        const Chunk& chunk = pool[index];
+        for (int r = 0; r < CHUNK_SIZE; ++r) {
+            std::uint64_t word = chunk.cells[current][r];
+            if (word == 0) {
+                continue;
+            }
+            std::int64_t row = chunk.key.row * CHUNK_SIZE + r;
+            std::int64_t first = chunk.key.col * CHUNK_SIZE + __builtin_ctzll(word);
+            std::int64_t last = chunk.key.col * CHUNK_SIZE + 63 - __builtin_clzll(word);
+            if (!found) {
+                minRow = maxRow = row;
+                minCol = first;
+                maxCol = last;
+                found = true;
+            } else {
+                minRow = std::min(minRow, row);
+                maxRow = std::max(maxRow, row);
+                minCol = std::min(minCol, first);
+                maxCol = std::max(maxCol, last);
+            }
+        }
+    }
+    return found;
+}
+
+int SparseLife::findChunk(std::int64_t chunkRow, std::int64_t chunkCol) const {
+    auto it = chunkIndex.find(ChunkKey{chunkRow, chunkCol});
+    return it == chunkIndex.end() ? NO_CHUNK : it->second;
+}
+
+int SparseLife::getOrCreateChunk(std::int64_t chunkRow, std::int64_t chunkCol) {
+    int index = findChunk(chunkRow, chunkCol);
+    if (index != NO_CHUNK) {
+        return index;
+    }
+    if (!freeChunks.empty()) {
+        index = freeChunks.back();
+        freeChunks.pop_back();
+    } else {
+        index = static_cast<int>(pool.size());
+        pool.emplace_back();
+    }
+    Chunk& chunk = pool[index];
+    chunk.key = ChunkKey{chunkRow, chunkCol};
+    std::fill(&chunk.cells[0][0], &chunk.cells[0][0] + 2 * CHUNK_SIZE, 0);
+    chunkIndex.emplace(chunk.key, index);
+    liveChunks.push_back(index);
+    return index;
+}
+
+void SparseLife::releaseChunk(int index) {
+    chunkIndex.erase(pool[index].key);
+    freeChunks.push_back(index);
+}
+
+// создает соседние куски, в которые на этом шаге могут родиться клетки
+void SparseLife::growBorders(int index) {
+    ChunkKey key = pool[index].key;
+    const std::uint64_t* rows = pool[index].cells[current];
+    std::uint64_t top = rows[0];
+    std::uint64_t bottom = rows[CHUNK_SIZE - 1];
+    std::uint64_t any = 0;
+    for (int r = 0; r < CHUNK_SIZE; ++r) {
+        any |= rows[r];
+    }
+    const std::uint64_t firstBit = 1;
+    const std::uint64_t lastBit = std::uint64_t(1) << (CHUNK_SIZE - 1);
+    // при создании куска pool может перераспределиться, поэтому дальше rows не используется
+    if (top) getOrCreateChunk(key.row - 1, key.col);
+    if (bottom) getOrCreateChunk(key.row + 1, key.col);
+    if (any & firstBit) getOrCreateChunk(key.row, key.col - 1);
+    if (any & lastBit) getOrCreateChunk(key.row, key.col + 1);
+    if (top & firstBit) getOrCreateChunk(key.row - 1, key.col - 1);
+    if (top & lastBit) getOrCreateChunk(key.row - 1, key.col + 1);
+    if (bottom & firstBit) getOrCreateChunk(key.row + 1, key.col - 1);
+    if (bottom & lastBit) getOrCreateChunk(key.row + 1, key.col + 1);
+}
+
+// считает следующее поколение куска во второй буфер
+void SparseLife::stepChunk(int index) {
+    Chunk& chunk = pool[index];
+    auto rowsOf = [this](std::int64_t chunkRow, std::int64_t chunkCol) {
+        int neighbor = findChunk(chunkRow, chunkCol);
+        return neighbor == NO_CHUNK ? EMPTY_ROWS : pool[neighbor].cells[current];
+    };
+    std::int64_t r = chunk.key.row;
+    std::int64_t c = chunk.key.col;
+
+    // столбцы слов с краевыми строками соседей сверху и снизу: индекс 0 — строка над куском
+    std::uint64_t mid[CHUNK_SIZE + 2];
+    std::uint64_t west[CHUNK_SIZE + 2];
+    std::uint64_t east[CHUNK_SIZE + 2];
+    mid[0] = rowsOf(r - 1, c)[CHUNK_SIZE - 1];
+    west[0] = rowsOf(r - 1, c - 1)[CHUNK_SIZE - 1];
+    east[0] = rowsOf(r - 1, c + 1)[CHUNK_SIZE - 1];
+    mid[CHUNK_SIZE + 1] = rowsOf(r + 1, c)[0];
+    west[CHUNK_SIZE + 1] = rowsOf(r + 1, c - 1)[0];
+    east[CHUNK_SIZE + 1] = rowsOf(r + 1, c + 1)[0];
+    std::copy(chunk.cells[current], chunk.cells[current] + CHUNK_SIZE, mid + 1);
+    const std::uint64_t* westRows = rowsOf(r, c - 1);
+    const std::uint64_t* eastRows = rowsOf(r, c + 1);
+    std::copy(westRows, westRows + CHUNK_SIZE, west + 1);
+    std::copy(eastRows, eastRows + CHUNK_SIZE, east + 1);
+
+    std::uint64_t* out = chunk.cells[current ^ 1];
+    for (int i = 1; i <= CHUNK_SIZE; ++i) {
+        out[i - 1] = LifeKernels::nextWord(
+            LifeKernels::westNeighbors(mid[i - 1], west[i - 1]), mid[i - 1],
+            LifeKernels::eastNeighbors(mid[i - 1], east[i - 1]),
+            LifeKernels::westNeighbors(mid[i], west[i]), mid[i],
+            LifeKernels::eastNeighbors(mid[i], east[i]),
+            LifeKernels::westNeighbors(mid[i + 1], west[i + 1]), mid[i + 1],
+            LifeKernels::eastNeighbors(mid[i + 1], east[i + 1]));
+    }
+}
@@ -0,0 +1,76 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(int threadCount) {
+    // вызывающий поток тоже выполняет задачи, поэтому рабочих на один меньше
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::getThreadCount() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::runTasks(int count, TaskFunction function, void* context) {
+    if (workers.empty() || count <= 1) {
+        for (int i = 0; i < count; ++i) {
+            function(context, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        taskFunction = function;
+        taskContext = context;
+        taskCount = count;
+        nextTask.store(0, std::memory_order_relaxed);
+        activeWorkers = static_cast<int>(workers.size());
+        ++batch;
+    }
+    wakeCondition.notify_all();
+
+    executeTasks();
+
+    // барьер: ждем, пока все рабочие потоки закончат свою часть
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+    taskFunction = nullptr;
+    taskContext = nullptr;
+}
+
+void ThreadPool::workerLoop() {
+    std::uint64_t seenBatch = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [&] { return stopping || batch != seenBatch; });
+        if (stopping) return;
+        seenBatch = batch;
+
+        lock.unlock();
+        executeTasks();
+        lock.lock();
+
+        if (--activeWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+// задачи разбираются динамически, так что быстрые потоки берут больше
+void ThreadPool::executeTasks() {
+    for (int index = nextTask.fetch_add(1); index < taskCount; index = nextTask.fetch_add(1)) {
+        taskFunction(taskContext, index);
+    }
+}
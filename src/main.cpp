@@ -1,9 +1,20 @@
 #include "GameOfLifeCore.hpp"
 #include "GameOfLifeRenderer.hpp"
+#include "PatternIO.hpp"
+#include <iostream>
+#include <string>
 
-int main() {
+// GameOfLife [PATTERN] — образец RLE или Macrocell загружается вместо случайного поля
+int main(int argc, char** argv) {
     GameOfLifeCore core;
+    if (argc > 1) {
+        std::string error;
+        if (!PatternIO::loadFile(argv[1], core, error)) {
+            std::cerr << argv[1] << ": " << error << std::endl;
+            return 1;
+        }
+    }
     GameOfLifeRenderer renderer(core);
     renderer.run();
     return 0;
-}
\ No newline at end of file
+}
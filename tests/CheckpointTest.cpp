@@ -0,0 +1,114 @@
+#include "Checkpoint.hpp"
+#include "GameOfLifeCore.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+} // namespace
+
+// Тест проверяет, что снимок возвращает поле, правило и поколение, а отображенные строки совпадают с полем
+TEST(CheckpointTest, SaveAndRestoreRoundTrip) {
+    GameOfLifeCore game(1000, 300, 17);
+    ASSERT_TRUE(game.setRule("B36/S23"));
+    for (int generation = 0; generation < 7; ++generation) {
+        game.update();
+    }
+    std::string path = tempPath("roundtrip.ckpt");
+    std::string error;
+    ASSERT_TRUE(Checkpoint::save(path, game, error)) << error;
+    EXPECT_TRUE(Checkpoint::isCheckpoint(path));
+
+    MappedCheckpoint mapped;
+    ASSERT_TRUE(mapped.open(path, error)) << error;
+    EXPECT_TRUE(mapped.verify());
+    EXPECT_EQ(mapped.getWidth(), 1000);
+    EXPECT_EQ(mapped.getGeneration(), 7u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapped.row(0)) % BitGrid::CACHE_LINE_BYTES, 0u);
+    for (int r = 0; r < 300; r += 37) {
+        for (int w = 0; w < game.getGrid().getWordsPerRow(); ++w) {
+            ASSERT_EQ(mapped.row(r)[w], game.getGrid().row(r)[w]);
+        }
+    }
+
+    GameOfLifeCore restored(10, 10);
+    ASSERT_TRUE(Checkpoint::restore(path, restored, error)) << error;
+    EXPECT_TRUE(restored.getGrid() == game.getGrid());
+    EXPECT_EQ(restored.getGeneration(), 7);
+    EXPECT_TRUE(restored.getRule() == game.getRule());
+
+    // продолжение после восстановления совпадает с непрерывным прогоном
+    game.update();
+    restored.update();
+    EXPECT_TRUE(restored.getGrid() == game.getGrid());
+    std::remove(path.c_str());
+}
+
+// Тест проверяет, что испорченный файл отвергается и поле не меняется
+TEST(CheckpointTest, RejectsCorruptedFiles) {
+    GameOfLifeCore game(200, 100, 2);
+    std::string path = tempPath("corrupt.ckpt");
+    std::string error;
+    ASSERT_TRUE(Checkpoint::save(path, game, error)) << error;
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(Checkpoint::HEADER_BYTES + 100);
+        file.put('\x5A');
+    }
+    GameOfLifeCore target(50, 50);
+    BitGrid before = target.getGrid();
+    EXPECT_FALSE(Checkpoint::restore(path, target, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_TRUE(target.getGrid() == before);
+    EXPECT_TRUE(Checkpoint::restore(path, target, error, false)); // без проверки суммы читается как есть
+
+    // поколение, не помещающееся в int поля, отвергается, а не обрезается
+    GameOfLifeCore late(50, 50);
+    ASSERT_TRUE(Checkpoint::save(path, game.getGrid(), game.getRule(), std::uint64_t(1) << 40, error)) << error;
+    error.clear();
+    EXPECT_FALSE(Checkpoint::restore(path, late, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_EQ(late.getWidth(), 50);
+    EXPECT_EQ(late.getGeneration(), 0);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "not a checkpoint";
+    }
+    MappedCheckpoint mapped;
+    EXPECT_FALSE(mapped.open(path, error));
+    EXPECT_FALSE(Checkpoint::isCheckpoint(path));
+    std::remove(path.c_str());
+}
+
+// Тест проверяет фоновую запись: request() не ждет диск, принятый снимок оказывается в файле
+TEST(CheckpointTest, BackgroundWriterWritesAcceptedSnapshots) {
+    GameOfLifeCore game(512, 512, 4);
+    std::string path = tempPath("background.ckpt");
+    {
+        CheckpointWriter writer(path);
+        for (int generation = 0; generation < 20; ++generation) {
+            game.update();
+            writer.request(game.getGrid(), game.getRule(), static_cast<std::uint64_t>(game.getGeneration()));
+        }
+        writer.flush();
+        EXPECT_EQ(writer.getWrittenCount() + writer.getSkippedCount(), 20u);
+        EXPECT_GE(writer.getWrittenCount(), 1u);
+        EXPECT_EQ(writer.getFailedCount(), 0u);
+
+        // после flush очередь пуста: следующий снимок принимается и записывается
+        EXPECT_TRUE(writer.request(game.getGrid(), game.getRule(), static_cast<std::uint64_t>(game.getGeneration())));
+        writer.flush();
+    }
+    GameOfLifeCore restored(8, 8);
+    std::string error;
+    ASSERT_TRUE(Checkpoint::restore(path, restored, error)) << error;
+    EXPECT_TRUE(restored.getGrid() == game.getGrid());
+    EXPECT_EQ(restored.getGeneration(), 20);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,62 @@
+#include "ActivityTracker.hpp"
+#include "DensityPyramid.hpp"
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+namespace {
+
+// живые клетки в блоке, посчитанные по одной
+std::uint32_t bruteCount(const BitGrid& grid, int level, int blockRow, int blockCol) {
+    int size = 1 << level;
+    std::uint32_t total = 0;
+    for (int r = blockRow * size; r < std::min((blockRow + 1) * size, grid.getHeight()); ++r) {
+        for (int c = blockCol * size; c < std::min((blockCol + 1) * size, grid.getWidth()); ++c) {
+            total += grid.get(r, c);
+        }
+    }
+    return total;
+}
+
+void expectMatchesGrid(const DensityPyramid& pyramid, const BitGrid& grid) {
+    for (int level = 0; level < pyramid.getLevelCount(); ++level) {
+        int size = 1 << level;
+        for (int r = 0; r * size < grid.getHeight(); ++r) {
+            for (int c = 0; c * size < grid.getWidth(); ++c) {
+                ASSERT_EQ(pyramid.count(grid, level, r, c), bruteCount(grid, level, r, c))
+                    << "level " << level << ", block " << r << "," << c;
+            }
+        }
+    }
+}
+
+} // namespace
+
+// Тест проверяет все уровни пирамиды после полного построения и после обновления плиток
+TEST(DensityPyramidTest, CountsMatchGridAfterTileUpdates) {
+    const int width = 300;
+    const int height = 170;
+    std::srand(3);
+    BitGrid grid(width, height);
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            grid.set(r, c, std::rand() % 3 == 0);
+        }
+    }
+
+    DensityPyramid pyramid;
+    pyramid.rebuild(grid);
+    EXPECT_EQ(pyramid.getLevelCount(), 10); // 512 >= 300 клеток в одном блоке
+    EXPECT_EQ(pyramid.count(grid, pyramid.getLevelCount() - 1, 0, 0), grid.population());
+    expectMatchesGrid(pyramid, grid);
+
+    ActivityTracker tiles(width, height);
+    std::vector<int> changed;
+    for (int edit = 0; edit < 40; ++edit) {
+        int r = std::rand() % height;
+        int c = std::rand() % width;
+        grid.set(r, c, !grid.get(r, c));
+        changed.push_back((r / ActivityTracker::TILE_HEIGHT) * tiles.getTilesX() + c / ActivityTracker::TILE_WIDTH);
+    }
+    pyramid.updateTiles(grid, changed);
+    expectMatchesGrid(pyramid, grid);
+}
@@ -0,0 +1,65 @@
+#include "Distributed.hpp"
+#include "GameOfLifeCore.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+// один и тот же случайный стартовый суп считается одним процессом и по прямоугольникам
+void expectSameAsSingleProcess(int width, int height, const char* rule, int generations,
+                               const Distributed::Options& options) {
+    GameOfLifeCore single(width, height, 11);
+    ASSERT_TRUE(single.setRule(rule));
+    GameOfLifeCore split(width, height, 11);
+    ASSERT_TRUE(split.setRule(rule));
+    ASSERT_EQ(single.getGrid(), split.getGrid());
+
+    for (int generation = 0; generation < generations; ++generation) {
+        single.update();
+    }
+    std::string error;
+    ASSERT_TRUE(Distributed::run(split, generations, options, error)) << error;
+    EXPECT_EQ(split.getGeneration(), generations);
+    EXPECT_EQ(split.getGrid(), single.getGrid());
+    EXPECT_EQ(split.getHash(), single.getHash());
+}
+
+} // namespace
+
+// Тест проверяет, что счет процессами 2x2 с обменом каждое поколение совпадает побитово
+TEST(DistributedTest, MatchesSingleProcessWithOneCellHalo) {
+    Distributed::Options options;
+    expectSameAsSingleProcess(200, 130, "B3/S23", 40, options);
+}
+
+// Тест проверяет неровное разбиение, заворот через единственный столбец прямоугольников и широкий ореол
+TEST(DistributedTest, MatchesSingleProcessWithWideHaloAndUnevenTiles) {
+    Distributed::Options options;
+    options.tilesX = 1;
+    options.tilesY = 3;
+    options.stepsPerExchange = 5;
+    expectSameAsSingleProcess(150, 101, "B36/S23", 23, options);
+
+    options.tilesX = 3;
+    options.tilesY = 2;
+    options.stepsPerExchange = 2;
+    expectSameAsSingleProcess(97, 64, "R2,C0,M1,S6..9,B7..8,NM", 9, options);
+}
+
+// Тест проверяет, что слишком мелкое разбиение и правила Generations отклоняются до запуска процессов
+TEST(DistributedTest, RejectsUnsupportedSetups) {
+    GameOfLifeCore game(40, 40, 3);
+    BitGrid before = game.getGrid();
+    Distributed::Options options;
+    options.tilesX = 8;
+    options.stepsPerExchange = 6;
+    std::string error;
+    EXPECT_FALSE(Distributed::run(game, 10, options, error));
+    EXPECT_FALSE(error.empty());
+
+    ASSERT_TRUE(game.setRule("B2/S/C3"));
+    options = Distributed::Options();
+    error.clear();
+    EXPECT_FALSE(Distributed::run(game, 10, options, error));
+    EXPECT_EQ(game.getGrid(), before);
+    EXPECT_EQ(game.getGeneration(), 0);
+}
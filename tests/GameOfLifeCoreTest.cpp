@@ -1,6 +1,42 @@
 #include "GameOfLifeCore.hpp"
-#include "GameOfLifeRenderer.hpp"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// все выделения памяти через operator new в тестах, чтобы ловить их в цикле шагов
+std::atomic<std::size_t> heapAllocations{0};
+
+// эталонное следующее поколение, посчитанное поклеточно через countNeighbors()
+BitGrid referenceStep(const GameOfLifeCore& game) {
+    const BitGrid& grid = game.getGrid();
+    BitGrid next(game.getWidth(), game.getHeight());
+    for (int i = 0; i < game.getHeight(); ++i) {
+        for (int j = 0; j < game.getWidth(); ++j) {
+            int neighbors = game.countNeighbors(i, j);
+            next.set(i, j, neighbors == 3 || (grid.get(i, j) && neighbors == 2));
+        }
+    }
+    return next;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
 
 // Тест проверяет корректность инициализации игрового поля
 TEST(GameOfLifeCoreTest, GridInitializedWithCorrectSize) {
@@ -138,4 +174,413 @@ TEST(GameOfLifeCoreTest, GenerationIncrementsAfterUpdate) {
     game.update();
 
     EXPECT_EQ(game.getGeneration(), gen + 1);
+}
+
+// Тест проверяет поле, размер которого задается при создании
+TEST(GameOfLifeCoreTest, RuntimeSizedGridIsPackedAndAligned) {
+    GameOfLifeCore game(200, 130);
+    const BitGrid& grid = game.getGrid();
+
+    EXPECT_EQ(game.getWidth(), 200);
+    EXPECT_EQ(game.getHeight(), 130);
+    EXPECT_EQ(grid.size(), 130u);
+    EXPECT_EQ(grid[0].size(), 200u);
+    EXPECT_EQ(grid.getWordsPerRow(), 4);
+
+    // каждая строка начинается с новой кэш-линии
+    for (int row = 0; row < grid.getHeight(); ++row) {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(grid.row(row)) % BitGrid::CACHE_LINE_BYTES, 0u);
+        EXPECT_EQ(grid.row(row)[grid.getWordsPerRow() - 1] & ~grid.getLastWordMask(), 0u);
+    }
+}
+
+// Тест проверяет подсчет соседей через края поля, ширина которого не кратна 64
+TEST(GameOfLifeCoreTest, CountNeighbors_WrapsAroundEdges) {
+    GameOfLifeCore game(70, 33);
+
+    for (int i = 0; i < game.getHeight(); ++i) {
+        for (int j = 0; j < game.getWidth(); ++j) {
+            game.setCell(i, j, false);
+        }
+    }
+
+    game.setCell(32, 69, true); // противоположный угол
+    game.setCell(0, 69, true);  // слева, через край
+    game.setCell(32, 0, true);  // сверху, через край
+    game.setCell(1, 1, true);   // по диагонали снизу-справа
+
+    EXPECT_EQ(game.countNeighbors(0, 0), 4);
+    EXPECT_EQ(game.countNeighbors(32, 69), 2);
+}
+
+
+// Тест проверяет, что пословное обновление совпадает с поклеточным на полях разной ширины
+TEST(GameOfLifeCoreTest, UpdateMatchesCountNeighborsReference) {
+    const int sizes[][2] = {{1, 1}, {5, 63}, {64, 64}, {3, 65}, {77, 130}, {50, 90}, {20, 200}};
+    for (const auto& size : sizes) {
+        GameOfLifeCore game(size[1], size[0], 12345);
+        for (int gen = 0; gen < 8; ++gen) {
+            BitGrid expected = referenceStep(game);
+            game.update();
+            ASSERT_TRUE(game.getGrid() == expected)
+                << "field " << size[1] << "x" << size[0] << ", generation " << gen;
+        }
+    }
+}
+
+// Тест проверяет, что все ядра (скалярное, табличное и векторные) дают то же поле, что и countNeighbors()
+TEST(GameOfLifeCoreTest, AllKernelsMatchReferenceOnRandomSeeds) {
+    const GameOfLifeCore::Kernel kernels[] = {
+        GameOfLifeCore::Kernel::Reference, GameOfLifeCore::Kernel::Swar,
+        GameOfLifeCore::Kernel::Avx2, GameOfLifeCore::Kernel::Avx512, GameOfLifeCore::Kernel::Lut};
+    const int sizes[][2] = {{7, 1}, {9, 300}, {31, 577}, {16, 1024}, {50, 90}};
+
+    for (GameOfLifeCore::Kernel kernel : kernels) {
+        if (!GameOfLifeCore::isKernelSupported(kernel)) {
+            continue; // процессор не поддерживает этот набор инструкций
+        }
+        for (unsigned seed = 1; seed <= 4; ++seed) {
+            for (const auto& size : sizes) {
+                GameOfLifeCore game(size[1], size[0], seed);
+                ASSERT_TRUE(game.setKernel(kernel));
+                for (int gen = 0; gen < 5; ++gen) {
+                    BitGrid expected = referenceStep(game);
+                    game.update();
+                    ASSERT_TRUE(game.getGrid() == expected)
+                        << "kernel " << static_cast<int>(kernel) << ", seed " << seed << ", field "
+                        << size[1] << "x" << size[0] << ", generation " << gen;
+                }
+            }
+        }
+    }
+}
+
+// Тест проверяет, что многопоточное обновление полосами совпадает с однопоточным
+TEST(GameOfLifeCoreTest, ParallelUpdateMatchesSingleThreaded) {
+    const int threadCounts[] = {2, 3, 8};
+    for (int threads : threadCounts) {
+        GameOfLifeCore serial(333, 101, 777);
+        GameOfLifeCore parallel(333, 101, 777);
+        parallel.setThreadCount(threads);
+        EXPECT_EQ(parallel.getThreadCount(), threads);
+
+        for (int gen = 0; gen < 20; ++gen) {
+            serial.update();
+            parallel.update();
+            ASSERT_TRUE(parallel.getGrid() == serial.getGrid())
+                << threads << " threads, generation " << gen;
+        }
+    }
+
+    // ноль и отрицательное число потоков — шаг в одном потоке
+    GameOfLifeCore game(64, 64);
+    game.setThreadCount(4);
+    game.setThreadCount(-1);
+    EXPECT_EQ(game.getThreadCount(), 1);
+    game.setThreadCount(0);
+    EXPECT_EQ(game.getThreadCount(), 1);
+    game.update();
+    EXPECT_EQ(game.getGeneration(), 1);
+}
+
+// Тест проверяет, что после первого шага update() больше не выделяет память
+TEST(GameOfLifeCoreTest, SteadyStateUpdateDoesNotAllocate) {
+    const int threadCounts[] = {1, 4};
+    for (int threads : threadCounts) {
+        GameOfLifeCore game(300, 200);
+        game.setThreadCount(threads);
+        game.update(); // прогрев
+
+        std::size_t gridAllocations = BitGrid::getAllocationCount();
+        std::size_t allocations = heapAllocations.load();
+        for (int gen = 0; gen < 50; ++gen) {
+            game.update();
+        }
+        EXPECT_EQ(BitGrid::getAllocationCount(), gridAllocations) << threads << " threads";
+        EXPECT_EQ(heapAllocations.load(), allocations) << threads << " threads";
+    }
+}
+
+// Тест проверяет, что пересчет только активных плиток дает то же поле, что и полный шаг,
+// в том числе после ручного изменения клеток между поколениями
+TEST(GameOfLifeCoreTest, ActivityTrackingMatchesFullUpdate) {
+    const GameOfLifeCore::Kernel kernels[] = {
+        GameOfLifeCore::Kernel::Reference, GameOfLifeCore::Kernel::Swar, GameOfLifeCore::Kernel::Lut,
+        GameOfLifeCore::bestKernel()};
+    const int sizes[][2] = {{50, 90}, {37, 200}, {130, 333}};
+    const int threadCounts[] = {1, 3};
+
+    for (GameOfLifeCore::Kernel kernel : kernels) {
+        for (const auto& size : sizes) {
+            for (int threads : threadCounts) {
+                GameOfLifeCore tracked(size[1], size[0], 2024);
+                GameOfLifeCore full(size[1], size[0], 2024);
+                full.setActivityTracking(false);
+                ASSERT_TRUE(tracked.setKernel(kernel));
+                ASSERT_TRUE(full.setKernel(kernel));
+                tracked.setThreadCount(threads);
+
+                for (int gen = 0; gen < 60; ++gen) {
+                    if (gen % 15 == 7) {
+                        int row = gen % size[0];
+                        int col = (gen * 31) % size[1];
+                        tracked.setCell(row, col, true);
+                        full.setCell(row, col, true);
+                    }
+                    tracked.update();
+                    full.update();
+                    ASSERT_TRUE(tracked.getGrid() == full.getGrid())
+                        << "kernel " << static_cast<int>(kernel) << ", field " << size[1] << "x"
+                        << size[0] << ", " << threads << " threads, generation " << gen;
+                }
+            }
+        }
+    }
+}
+
+// Тест проверяет, что на большом почти пустом поле изменяются только плитки рядом с фигурами
+TEST(GameOfLifeCoreTest, ActivityTrackingSkipsStableRegions) {
+    GameOfLifeCore game(1024, 1024);
+    game.setGrid(BitGrid(1024, 1024));
+    // блок — устойчивая фигура
+    game.setCell(500, 500, true);
+    game.setCell(500, 501, true);
+    game.setCell(501, 500, true);
+    game.setCell(501, 501, true);
+    game.update();
+    game.update();
+    EXPECT_TRUE(game.getActivity().getChangedTiles().empty());
+
+    // глайдер меняет не больше четырех соседних плиток
+    game.setCell(101, 100, true);
+    game.setCell(102, 101, true);
+    game.setCell(100, 102, true);
+    game.setCell(101, 102, true);
+    game.setCell(102, 102, true);
+    for (int gen = 0; gen < 8; ++gen) {
+        game.update();
+        EXPECT_FALSE(game.getActivity().getChangedTiles().empty());
+        EXPECT_LE(game.getActivity().getChangedTiles().size(), 4u);
+    }
+    EXPECT_EQ(game.getGrid().population(), 9u);
+}
+
+// Тест проверяет, что хэш и число живых клеток, обновляемые по изменениям (шаг, setCell, setRegion), совпадают
+// с посчитанными заново во всех путях шага: плитки, полосы в потоках, Generations и Larger than Life
+TEST(GameOfLifeCoreTest, IncrementalHashMatchesRecomputed) {
+    const char* rules[] = {"B3/S23", "B36/S23", "B2/S/C4", "R2,C0,M1,S4..7,B5..6,NM"};
+    for (const char* rulestring : rules) {
+        for (int threads : {1, 3}) {
+            GameOfLifeCore game(150, 70, 31);
+            ASSERT_TRUE(game.setRule(rulestring));
+            game.setThreadCount(threads);
+            for (int generation = 0; generation < 12; ++generation) {
+                game.update();
+                if (generation == 5) {
+                    game.setCell(3, 140, true);
+                }
+                if (generation == 8) {
+                    // прямоугольник через границу слов, как полоса ореола
+                    BitGrid region(70, 4);
+                    for (int col = 0; col < 70; col += 3) {
+                        region.set(col % 4, col, true);
+                    }
+                    ASSERT_TRUE(game.setRegion(60, 50, region));
+                    EXPECT_TRUE(game.getGrid().get(60, 50));
+                    EXPECT_FALSE(game.getGrid().get(61, 50));
+                    EXPECT_EQ(game.getCellState(61, 51), 0);
+                    EXPECT_FALSE(game.setRegion(67, 50, region));
+                }
+            }
+            if (game.getRule().getStates() > 2) {
+                continue; // возрасты умирающих клеток не переносятся через setGrid
+            }
+            GameOfLifeCore fresh(150, 70);
+            ASSERT_TRUE(fresh.setRule(rulestring));
+            ASSERT_TRUE(fresh.setGrid(game.getGrid()));
+            EXPECT_EQ(game.getHash(), fresh.getHash()) << rulestring << " threads=" << threads;
+            EXPECT_EQ(game.getPopulation(), fresh.getPopulation()) << rulestring;
+        }
+    }
+}
+
+// Тест проверяет обнаружение устойчивой фигуры, цикла и вымирания
+TEST(GameOfLifeCoreTest, DetectsStillLifeOscillatorAndExtinction) {
+    GameOfLifeCore game(64, 64);
+    game.setGrid(BitGrid(64, 64));
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::Extinct);
+
+    // блок
+    game.setCell(10, 10, true);
+    game.setCell(10, 11, true);
+    game.setCell(11, 10, true);
+    game.setCell(11, 11, true);
+    EXPECT_FALSE(game.isFinished());
+    game.update();
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::StillLife);
+    EXPECT_EQ(game.getPopulation(), 4u);
+
+    // мигалка рядом с блоком: период 2
+    game.setCell(30, 30, true);
+    game.setCell(30, 31, true);
+    game.setCell(30, 32, true);
+    game.update();
+    EXPECT_FALSE(game.isFinished());
+    game.update();
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::Oscillating);
+    EXPECT_EQ(game.getCycles().getPeriod(), 2);
+    EXPECT_EQ(game.getCycles().getDetectedAt(), game.getGeneration());
+
+    // одиночная клетка вымирает за шаг
+    game.setGrid(BitGrid(64, 64));
+    game.setCell(40, 40, true);
+    game.update();
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::Extinct);
+    EXPECT_EQ(game.getPopulation(), 0u);
+}
+
+// Тест проверяет, что глайдер на торе замечается как цикл с периодом 4 * размер поля
+TEST(GameOfLifeCoreTest, DetectsGliderReturningAroundTorus) {
+    GameOfLifeCore game(32, 32);
+    game.setGrid(BitGrid(32, 32));
+    game.setCell(0, 1, true);
+    game.setCell(1, 2, true);
+    game.setCell(2, 0, true);
+    game.setCell(2, 1, true);
+    game.setCell(2, 2, true);
+    for (int generation = 0; generation < 127 && !game.isFinished(); ++generation) {
+        game.update();
+    }
+    EXPECT_FALSE(game.isFinished());
+    game.update();
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::Oscillating);
+    EXPECT_EQ(game.getCycles().getPeriod(), 128);
+}
+
+// Тест проверяет, что повторы замечаются и при шагах пачками step(n), с точным периодом
+TEST(GameOfLifeCoreTest, DetectsCyclesAcrossTemporalBatches) {
+    // блок и мигалка: концы проходов по 3 поколения повторяются через 6, настоящий период — 2
+    GameOfLifeCore game(64, 64);
+    game.setGrid(BitGrid(64, 64));
+    game.setCell(10, 10, true);
+    game.setCell(10, 11, true);
+    game.setCell(11, 10, true);
+    game.setCell(11, 11, true);
+    game.setCell(30, 30, true);
+    game.setCell(30, 31, true);
+    game.setCell(30, 32, true);
+    GameOfLifeCore reference(64, 64);
+    reference.setGrid(game.getGrid());
+    for (int batch = 0; batch < 4 && !game.isFinished(); ++batch) {
+        game.step(9, 3);
+    }
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::Oscillating);
+    EXPECT_EQ(game.getCycles().getPeriod(), 2);
+    // уточнение периода прогоняет само поле и возвращает его на место
+    while (reference.getGeneration() < game.getGeneration()) {
+        reference.update();
+    }
+    EXPECT_TRUE(game.getGrid() == reference.getGrid());
+    EXPECT_EQ(game.getHash(), reference.getHash());
+    game.update();
+    reference.update();
+    EXPECT_TRUE(game.getGrid() == reference.getGrid());
+
+    // один блок: устойчивая фигура, хотя проход длится 8 поколений
+    game.setGrid(BitGrid(64, 64));
+    game.setCell(10, 10, true);
+    game.setCell(10, 11, true);
+    game.setCell(11, 10, true);
+    game.setCell(11, 11, true);
+    game.step(16);
+    EXPECT_EQ(game.getCycles().getState(), CycleDetector::State::StillLife);
+    EXPECT_EQ(game.getCycles().getPeriod(), 1);
+
+    // глайдер на торе возвращается через 128 поколений и между пачками
+    GameOfLifeCore glider(32, 32);
+    glider.setGrid(BitGrid(32, 32));
+    glider.setCell(0, 1, true);
+    glider.setCell(1, 2, true);
+    glider.setCell(2, 0, true);
+    glider.setCell(2, 1, true);
+    glider.setCell(2, 2, true);
+    GameOfLifeCore expected(32, 32);
+    expected.setGrid(glider.getGrid());
+    while (!glider.isFinished() && glider.getGeneration() < 1000) {
+        glider.step(40);
+    }
+    EXPECT_EQ(glider.getCycles().getState(), CycleDetector::State::Oscillating);
+    EXPECT_EQ(glider.getCycles().getPeriod(), 128);
+    EXPECT_EQ(glider.getCycles().getDetectedAt(), 128);
+    expected.step(glider.getGeneration(), 1);
+    EXPECT_TRUE(glider.getGrid() == expected.getGrid());
+}
+
+// Тест проверяет, что случайное поле зависит только от зерна: не от числа потоков и не от истории ядра
+TEST(GameOfLifeCoreTest, RandomizeGridIsSeededAndThreadIndependent) {
+    GameOfLifeCore serial(1000, 333);
+    GameOfLifeCore parallel(1000, 333);
+    parallel.setThreadCount(4);
+    serial.randomizeGrid(99, 30);
+    parallel.update();
+    parallel.randomizeGrid(99, 30);
+    EXPECT_TRUE(serial.getGrid() == parallel.getGrid());
+    EXPECT_EQ(serial.getHash(), parallel.getHash());
+    EXPECT_NEAR(static_cast<double>(serial.getPopulation()) / (1000.0 * 333.0), 0.30, 0.01);
+    EXPECT_EQ(serial.getPopulation(), serial.getGrid().population());
+
+    // биты за шириной поля остаются нулевыми
+    for (int r = 0; r < 333; ++r) {
+        ASSERT_EQ(serial.getGrid().row(r)[serial.getGrid().getWordsPerRow() - 1] & ~serial.getGrid().getLastWordMask(), 0u);
+    }
+
+    // последовательность зерен ядра: каждый сброс — новое поле, то же зерно — та же последовательность
+    GameOfLifeCore first(200, 100, 5);
+    GameOfLifeCore second(200, 100, 5);
+    EXPECT_TRUE(first.getGrid() == second.getGrid());
+    first.reset();
+    EXPECT_FALSE(first.getGrid() == second.getGrid());
+    second.reset();
+    EXPECT_TRUE(first.getGrid() == second.getGrid());
+    GameOfLifeCore other(200, 100, 6);
+    EXPECT_FALSE(other.getGrid() == second.getGrid());
+}
+
+// Тест проверяет, что step(n) с временными блоками совпадает с n вызовами update() вместе с хэшем,
+// в том числе при нескольких полосах, неполном последнем проходе, потоках и поле ниже полосы
+TEST(GameOfLifeCoreTest, TemporalBlockingMatchesUpdate) {
+    struct Case {
+        int width;
+        int height;
+        const char* rule;
+        int threads;
+        int depth;
+    };
+    const Case cases[] = {
+        {3000, 1000, "B3/S23", 1, 8}, // около 325 строк на полосу
+        {3000, 1000, "B36/S23", 3, 8},
+        {1000, 700, "B3/S23", 2, 3},
+        {100, 40, "B3/S23", 1, 16},   // полоса выше поля, ореол заворачивается на себя
+        {200, 90, "B2/S/C3", 1, 8},   // Generations: обычные шаги
+    };
+    for (const Case& c : cases) {
+        GameOfLifeCore expected(c.width, c.height, 21);
+        GameOfLifeCore blocked(c.width, c.height, 21);
+        ASSERT_TRUE(expected.setRule(c.rule));
+        ASSERT_TRUE(blocked.setRule(c.rule));
+        blocked.setThreadCount(c.threads);
+        for (int generation = 0; generation < 21; ++generation) {
+            expected.update();
+        }
+        blocked.step(21, c.depth);
+        EXPECT_EQ(blocked.getGeneration(), 21) << c.width << "x" << c.height << " " << c.rule;
+        EXPECT_TRUE(blocked.getGrid() == expected.getGrid()) << c.width << "x" << c.height << " " << c.rule;
+        EXPECT_EQ(blocked.getHash(), expected.getHash()) << c.rule;
+        EXPECT_EQ(blocked.getPopulation(), expected.getPopulation()) << c.rule;
+
+        // после блоков обычный шаг по плиткам считает все поле заново
+        expected.update();
+        blocked.update();
+        EXPECT_TRUE(blocked.getGrid() == expected.getGrid()) << c.rule;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "GameOfLifeCore.hpp"
+#include "GenerationHistory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+// состояние поля, которое должно вернуться после перемотки
+struct State {
+    BitGrid grid;
+    int generation;
+    std::uint64_t hash;
+    std::size_t population;
+};
+
+State capture(const GameOfLifeCore& game) {
+    return {game.getGrid(), game.getGeneration(), game.getHash(), game.getPopulation()};
+}
+
+void expectState(const GameOfLifeCore& game, const State& state) {
+    EXPECT_TRUE(game.getGrid() == state.grid);
+    EXPECT_EQ(game.getGeneration(), state.generation);
+    EXPECT_EQ(game.getHash(), state.hash);
+    EXPECT_EQ(game.getPopulation(), state.population);
+}
+
+} // namespace
+
+// Тест проверяет, что undo() проходит назад поколения, правки и новое поле, а redo() возвращает их
+TEST(GenerationHistoryTest, UndoAndRedoRestoreGenerationsAndEdits) {
+    GameOfLifeCore game(150, 70, 7);
+    game.setHistoryBudget(GenerationHistory::DEFAULT_BUDGET);
+    std::vector<State> states{capture(game)};
+    for (int i = 0; i < 5; ++i) {
+        game.update();
+        states.push_back(capture(game));
+    }
+    // штрих из нескольких клеток — одна запись
+    game.setCell(10, 10, true);
+    game.setCell(10, 11, true);
+    game.setCell(69, 149, !game.getGrid().get(69, 149));
+    game.commitEdit();
+    states.push_back(capture(game));
+    game.reset();
+    states.push_back(capture(game));
+    game.update();
+    states.push_back(capture(game));
+
+    for (int i = static_cast<int>(states.size()) - 2; i >= 0; --i) {
+        ASSERT_TRUE(game.undo());
+        expectState(game, states[i]);
+    }
+    EXPECT_FALSE(game.undo());
+    for (std::size_t i = 1; i < states.size(); ++i) {
+        ASSERT_TRUE(game.redo());
+        expectState(game, states[i]);
+    }
+    EXPECT_FALSE(game.redo());
+
+    // после отмены новая правка стирает отмененные записи
+    game.undo();
+    game.undo();
+    game.setCell(0, 0, !game.getGrid().get(0, 0));
+    EXPECT_FALSE(game.redo());
+    ASSERT_TRUE(game.undo());
+    expectState(game, states[states.size() - 3]);
+
+    // шаг после перемотки считается от восстановленного поля
+    GameOfLifeCore reference(150, 70);
+    reference.setGrid(game.getGrid());
+    reference.update();
+    game.update();
+    EXPECT_TRUE(game.getGrid() == reference.getGrid());
+    EXPECT_EQ(game.getHash(), reference.getHash());
+}
+
+// Тест проверяет перемотку к любому записанному поколению через ключевые кадры и вытеснение по бюджету
+TEST(GenerationHistoryTest, SeeksAnyGenerationWithinBudget) {
+    GameOfLifeCore game(256, 128, 3);
+    game.setHistoryBudget(GenerationHistory::DEFAULT_BUDGET);
+    std::vector<State> states{capture(game)};
+    for (int i = 0; i < 120; ++i) {
+        game.update();
+        states.push_back(capture(game));
+    }
+    for (int target : {0, 119, 37, 38, 100, 1, 120, 60}) {
+        ASSERT_TRUE(game.seekGeneration(target));
+        expectState(game, states[target]);
+    }
+
+    // временные блоки: несколько поколений за раз — одна запись
+    game.seekGeneration(120);
+    game.step(16);
+    State blocked = capture(game);
+    ASSERT_TRUE(game.undo());
+    expectState(game, states[120]);
+    ASSERT_TRUE(game.redo());
+    expectState(game, blocked);
+
+    // маленький бюджет оставляет только последние записи, и дальше них назад не уйти
+    const std::size_t budget = 16 * 1024;
+    game.setHistoryBudget(budget);
+    const GenerationHistory* history = game.getHistory();
+    ASSERT_NE(history, nullptr);
+    EXPECT_LE(history->getBytes(), budget);
+    EXPECT_LT(history->size(), 120);
+    int oldest = history->getGeneration(0);
+    ASSERT_LE(oldest, 120);
+    game.seekGeneration(0);
+    EXPECT_EQ(game.getGeneration(), oldest);
+    expectState(game, states[oldest]);
+    EXPECT_FALSE(game.undo());
+
+    game.setHistoryBudget(0);
+    EXPECT_EQ(game.getHistory(), nullptr);
+    EXPECT_FALSE(game.undo());
+    EXPECT_FALSE(game.seekGeneration(5));
+}
+
+// Тест проверяет, что перемотка на 100 поколений назад стоит порядка одного шага, а не пересчета поля
+TEST(GenerationHistoryTest, FarSeekCostsAboutOneStep) {
+    GameOfLifeCore game(1024, 512, 11);
+    game.setHistoryBudget(GenerationHistory::DEFAULT_BUDGET);
+    using Clock = std::chrono::steady_clock;
+    double bestStep = 1e9;
+    for (int i = 0; i < 120; ++i) {
+        auto start = Clock::now();
+        game.update();
+        bestStep = std::min(bestStep, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    State last = capture(game);
+    double bestSeek = 1e9;
+    for (int i = 0; i < 10; ++i) {
+        auto start = Clock::now();
+        ASSERT_TRUE(game.seekGeneration(20));
+        bestSeek = std::min(bestSeek, std::chrono::duration<double>(Clock::now() - start).count());
+        ASSERT_TRUE(game.seekGeneration(120));
+    }
+    expectState(game, last);
+    EXPECT_LT(bestSeek, 2 * bestStep);
+}
@@ -0,0 +1,163 @@
+#include "GameOfLifeCore.hpp"
+#include "HashLife.hpp"
+#include <gtest/gtest.h>
+#include <limits>
+
+namespace {
+
+void clearField(GameOfLifeCore& game) {
+    for (int i = 0; i < game.getHeight(); ++i) {
+        for (int j = 0; j < game.getWidth(); ++j) {
+            game.setCell(i, j, false);
+        }
+    }
+}
+
+} // namespace
+
+// Тест проверяет, что шаг на 2^k поколений совпадает с k-кратным update() на поле по умолчанию
+TEST(HashLifeTest, StepPow2MatchesUpdateOnDefaultField) {
+    GameOfLifeCore reference; // поле по умолчанию одинаково: одно и то же зерно DEFAULT_SEED
+    GameOfLifeCore game;
+    HashLife hashLife;
+
+    for (int k = 0; k <= 6; ++k) {
+        for (int i = 0; i < (1 << k); ++i) {
+            reference.update();
+        }
+        hashLife.advance(game, k);
+
+        ASSERT_TRUE(game.getGrid() == reference.getGrid()) << "k = " << k;
+        EXPECT_EQ(game.getGeneration(), reference.getGeneration());
+    }
+}
+
+// Тест проверяет тор, размеры которого не степени двойки и не кратны друг другу
+TEST(HashLifeTest, StepPow2MatchesUpdateOnOddTorus) {
+    GameOfLifeCore reference(37, 23, 7);
+    GameOfLifeCore game(37, 23, 7);
+    HashLife hashLife;
+    hashLife.load(game);
+
+    for (int k = 0; k <= 5; ++k) {
+        for (int i = 0; i < (1 << k); ++i) {
+            reference.update();
+        }
+        hashLife.stepPow2(k);
+        ASSERT_TRUE(hashLife.getGrid() == reference.getGrid()) << "k = " << k;
+    }
+}
+
+// Тест проверяет правила на сценариях тестов ядра: одиночная клетка умирает, а мертвая с тремя соседями оживает
+TEST(HashLifeTest, FollowsBasicRules) {
+    GameOfLifeCore game;
+    clearField(game);
+    int centerX = GameOfLifeCore::FIELD_HEIGHT / 2;
+    int centerY = GameOfLifeCore::FIELD_WIDTH / 2;
+
+    game.setCell(centerX - 1, centerY - 1, true);
+    game.setCell(centerX - 1, centerY + 1, true);
+    game.setCell(centerX + 1, centerY, true);
+
+    HashLife hashLife;
+    hashLife.advance(game, 0);
+
+    EXPECT_TRUE(game.getGrid()[centerX][centerY]);
+    EXPECT_FALSE(game.getGrid()[centerX - 1][centerY - 1]);
+    EXPECT_EQ(game.getGeneration(), 1);
+}
+
+// Тест проверяет длинный прогон: глайдер на торе 64x64 за 256 поколений возвращается на место
+TEST(HashLifeTest, GliderReturnsAfterFullLap) {
+    GameOfLifeCore game(64, 64);
+    clearField(game);
+    game.setCell(10, 11, true);
+    game.setCell(11, 12, true);
+    game.setCell(12, 10, true);
+    game.setCell(12, 11, true);
+    game.setCell(12, 12, true);
+    BitGrid start = game.getGrid();
+
+    HashLife hashLife;
+    hashLife.advance(game, 8);
+
+    EXPECT_TRUE(game.getGrid() == start);
+    EXPECT_EQ(game.getGeneration(), 256);
+}
+
+// Тест проверяет, что при маленьком лимите кэш узлов собирается и результат не портится
+TEST(HashLifeTest, GarbageCollectionKeepsResultsCorrect) {
+    GameOfLifeCore reference(60, 60, 3);
+    GameOfLifeCore game(60, 60, 3);
+
+    HashLife hashLife(20000);
+    hashLife.load(game);
+    for (int step = 0; step < 12; ++step) {
+        for (int i = 0; i < 8; ++i) {
+            reference.update();
+        }
+        hashLife.stepPow2(3);
+        ASSERT_TRUE(hashLife.getGrid() == reference.getGrid()) << "step " << step;
+    }
+
+    EXPECT_GT(hashLife.getCollectionCount(), 0u);
+    EXPECT_LE(hashLife.getNodeCount(), 20000u);
+}
+
+// Тест проверяет, что длинный шаг не выходит за потолок узлов внутри шага, а делится на короткие
+TEST(HashLifeTest, LongStepStaysWithinNodeLimit) {
+    GameOfLifeCore reference(60, 60, 5);
+    GameOfLifeCore game(60, 60, 5);
+    for (int i = 0; i < 256; ++i) {
+        reference.update();
+    }
+
+    const std::size_t maxNodes = 6000;
+    HashLife hashLife(maxNodes);
+    ASSERT_TRUE(hashLife.advance(game, 8));
+    EXPECT_TRUE(game.getGrid() == reference.getGrid());
+    EXPECT_EQ(game.getGeneration(), 256);
+    EXPECT_LE(hashLife.getPeakNodeCount(), 2 * maxNodes);
+    EXPECT_GT(hashLife.getCollectionCount(), 0u);
+}
+
+// Тест проверяет, что номер поколения, не помещающийся в int, не записывается в поле
+TEST(HashLifeTest, RejectsGenerationOverflow) {
+    GameOfLifeCore game(40, 40, 2);
+    game.setGeneration(std::numeric_limits<int>::max() - 10);
+    BitGrid before = game.getGrid();
+    HashLife hashLife;
+    EXPECT_FALSE(hashLife.advance(game, 4));
+    EXPECT_FALSE(hashLife.advance(game, 63));
+    EXPECT_FALSE(hashLife.advance(game, -1)); // отрицательная степень — не сдвиг на отрицательное число
+    EXPECT_TRUE(game.getGrid() == before);
+    EXPECT_EQ(game.getGeneration(), std::numeric_limits<int>::max() - 10);
+    ASSERT_TRUE(hashLife.advance(game, 3));
+    EXPECT_EQ(game.getGeneration(), std::numeric_limits<int>::max() - 2);
+
+    // поколения самого HashLife 64-битные, но обратно в поле их уже не записать
+    hashLife.load(game);
+    hashLife.stepPow2(4);
+    EXPECT_FALSE(hashLife.store(game));
+    EXPECT_EQ(game.getGeneration(), std::numeric_limits<int>::max() - 2);
+}
+
+// Тест проверяет, что HashLife берет правило поля: HighLife совпадает с update(), а Generations не поддерживается
+TEST(HashLifeTest, UsesRuleOfLoadedField) {
+    GameOfLifeCore reference(50, 40, 9);
+    GameOfLifeCore game(50, 40, 9);
+    ASSERT_TRUE(reference.setRule("B36/S23"));
+    ASSERT_TRUE(game.setRule("B36/S23"));
+
+    HashLife hashLife;
+    for (int i = 0; i < 32; ++i) {
+        reference.update();
+    }
+    ASSERT_TRUE(hashLife.advance(game, 5));
+    EXPECT_TRUE(game.getGrid() == reference.getGrid());
+    EXPECT_TRUE(hashLife.getRule() == game.getRule());
+
+    ASSERT_TRUE(game.setRule("B2/S/C3"));
+    EXPECT_FALSE(hashLife.advance(game, 1));
+    EXPECT_EQ(game.getGeneration(), 32);
+}
@@ -0,0 +1,149 @@
+#include "GameOfLifeCore.hpp"
+#include "LifeRule.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+// прямой подсчет Larger than Life по определению, для сверки со скользящими суммами
+BitGrid bruteForceStep(const BitGrid& grid, const LifeRule& rule) {
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    int range = rule.getRange();
+    BitGrid next(width, height);
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            int neighbors = 0;
+            for (int dr = -range; dr <= range; ++dr) {
+                for (int dc = -range; dc <= range; ++dc) {
+                    if (dr == 0 && dc == 0) continue;
+                    neighbors += grid.get((i + dr + height) % height, (j + dc + width) % width);
+                }
+            }
+            next.set(i, j, rule.next(grid.get(i, j), neighbors));
+        }
+    }
+    return next;
+}
+
+} // namespace
+
+// Тест проверяет разбор записей B/S, S/B, Generations и Larger than Life
+TEST(LifeRuleTest, ParsesStandardRulestrings) {
+    LifeRule rule;
+    EXPECT_TRUE(rule.isConway());
+    EXPECT_EQ(rule.toString(), "B3/S23");
+
+    ASSERT_TRUE(LifeRule::parse("b36/s23", rule));
+    EXPECT_EQ(rule.toString(), "B36/S23");
+    LifeRule positional;
+    ASSERT_TRUE(LifeRule::parse("23/36", positional));
+    EXPECT_TRUE(positional == rule);
+    EXPECT_TRUE(positional.isLifeLike());
+    EXPECT_FALSE(positional.isConway());
+
+    LifeRule brain;
+    ASSERT_TRUE(LifeRule::parse("B2/S/C3", brain));
+    EXPECT_EQ(brain.getStates(), 3);
+    EXPECT_EQ(brain.toString(), "B2/S/C3");
+    ASSERT_TRUE(LifeRule::parse("/2/3", positional));
+    EXPECT_TRUE(positional == brain);
+
+    LifeRule bosco;
+    ASSERT_TRUE(LifeRule::parse("R5,C0,M1,S34..58,B34..45,NM", bosco));
+    EXPECT_EQ(bosco.getRange(), 5);
+    EXPECT_EQ(bosco.getMaxNeighbors(), 120);
+    EXPECT_EQ(bosco.toString(), "R5,C0,M1,S34..58,B34..45,NM");
+    EXPECT_TRUE(bosco.next(true, 33));  // с центром 34
+    EXPECT_FALSE(bosco.next(true, 58)); // с центром 59
+    EXPECT_TRUE(bosco.next(false, 45));
+    EXPECT_FALSE(bosco.next(false, 46));
+
+    const char* invalid[] = {"", "B3", "B9/S23", "X3/S23", "B3/B3", "B3/S23/C1000",
+                             "R0,C0,M0,S1..2,B3..3,NM", "R2,C0,M0,S1..2,NM", "R2,C0,M0,S1..2,B3..3,NN"};
+    for (const char* text : invalid) {
+        EXPECT_FALSE(LifeRule::parse(text, rule)) << text;
+    }
+    EXPECT_EQ(rule.toString(), "B36/S23"); // после ошибки правило не меняется
+}
+
+// Тест проверяет, что побитовое, векторные и табличное (Lut) ядра правила совпадают с
+// поклеточным шагом, в том числе на правилах с B0 и S8 и с учетом плиток
+TEST(LifeRuleTest, GenericKernelMatchesReference) {
+    const char* rules[] = {"B36/S23", "B3678/S34678", "B2/S", "B0123478/S01234678", "B1/S012345678", "B2/S/C3"};
+    const GameOfLifeCore::Kernel kernels[] = {GameOfLifeCore::Kernel::Swar, GameOfLifeCore::Kernel::Avx2,
+                                              GameOfLifeCore::Kernel::Avx512, GameOfLifeCore::Kernel::Lut};
+    for (const char* text : rules) {
+        for (GameOfLifeCore::Kernel kernel : kernels) {
+            if (!GameOfLifeCore::isKernelSupported(kernel)) {
+                continue;
+            }
+            // 11 слов в строке: векторным ядрам есть что считать между крайними словами
+            GameOfLifeCore reference(700, 37, 11);
+            GameOfLifeCore game(700, 37, 11);
+            ASSERT_TRUE(reference.setRule(text));
+            reference.setKernel(GameOfLifeCore::Kernel::Reference);
+            game.setKernel(kernel); // ядро и таблица выбираются и при смене правила после ядра
+            ASSERT_TRUE(game.setRule(text));
+            for (int generation = 0; generation < 30; ++generation) {
+                reference.update();
+                game.update();
+                ASSERT_TRUE(game.getGrid() == reference.getGrid())
+                    << text << ", kernel " << static_cast<int>(kernel) << ", generation " << generation;
+            }
+        }
+    }
+}
+
+// Тест проверяет Generations: не выжившая клетка проходит состояния 2..C-1 и не дает
+// родиться новой клетке на своем месте
+TEST(LifeRuleTest, GenerationsCellsAgeBeforeDying) {
+    GameOfLifeCore game(16, 16);
+    game.setGrid(BitGrid(16, 16));
+    ASSERT_TRUE(game.setRule("B2/S/C4"));
+    game.setCell(5, 5, true);
+    game.setCell(5, 6, true);
+
+    game.update();
+    EXPECT_EQ(game.getCellState(5, 5), 2);
+    EXPECT_EQ(game.getCellState(5, 6), 2);
+    EXPECT_EQ(game.getCellState(4, 5), 1); // два соседа — рождение
+    game.update();
+    EXPECT_EQ(game.getCellState(5, 5), 3);
+    game.update();
+    EXPECT_EQ(game.getCellState(5, 5), 0);
+
+    // ядра и число потоков не влияют на результат
+    GameOfLifeCore reference(100, 40, 5);
+    GameOfLifeCore threaded(100, 40, 5);
+    ASSERT_TRUE(reference.setRule("/2/3"));
+    ASSERT_TRUE(threaded.setRule("/2/3"));
+    reference.setKernel(GameOfLifeCore::Kernel::Reference);
+    threaded.setThreadCount(3);
+    for (int generation = 0; generation < 20; ++generation) {
+        reference.update();
+        threaded.update();
+    }
+    EXPECT_TRUE(threaded.getGrid() == reference.getGrid());
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 100; ++j) {
+            ASSERT_EQ(threaded.getCellState(i, j), reference.getCellState(i, j));
+        }
+    }
+}
+
+// Тест проверяет Larger than Life на торе против подсчета по определению
+TEST(LifeRuleTest, LargerThanLifeMatchesBruteForce) {
+    LifeRule rule;
+    ASSERT_TRUE(LifeRule::parse("R3,C0,M1,S9..17,B9..12,NM", rule));
+    GameOfLifeCore game(70, 29, 3);
+    ASSERT_TRUE(game.setRule(rule));
+    for (int generation = 0; generation < 10; ++generation) {
+        BitGrid expected = bruteForceStep(game.getGrid(), rule);
+        game.update();
+        ASSERT_TRUE(game.getGrid() == expected) << "generation " << generation;
+    }
+
+    GameOfLifeCore small(10, 6);
+    EXPECT_FALSE(small.setRule(rule)); // окрестность 7x7 не помещается в 6 строк
+    EXPECT_TRUE(small.getRule().isConway());
+}
@@ -0,0 +1,147 @@
+#include "GameOfLifeCore.hpp"
+#include "PatternIO.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace {
+
+const char* GLIDER_GUN_RLE =
+    "#N Gosper glider gun\n"
+    "#C comment lines are skipped\n"
+    "x = 36, y = 9, rule = B3/S23\n"
+    "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4b\n"
+    "obo$10bo5bo7bo$11bo3bo$12b2o!\n";
+
+} // namespace
+
+// Тест проверяет разбор RLE: размер поля, центрирование, перенос строк и повтор "$"
+TEST(PatternIOTest, LoadsRleIntoCenteredField) {
+    GameOfLifeCore game(20, 20);
+    std::istringstream in(GLIDER_GUN_RLE);
+    std::string error;
+    ASSERT_TRUE(PatternIO::load(in, game, error)) << error;
+
+    EXPECT_EQ(game.getWidth(), 36 + 2 * PatternIO::MARGIN);
+    EXPECT_EQ(game.getHeight(), 9 + 2 * PatternIO::MARGIN);
+    EXPECT_EQ(game.getGrid().population(), 36u);
+    EXPECT_EQ(game.getGeneration(), 0);
+    int left = PatternIO::MARGIN, top = PatternIO::MARGIN;
+    EXPECT_TRUE(game.getGrid().get(top, left + 24));
+    EXPECT_TRUE(game.getGrid().get(top + 4, left));
+    EXPECT_TRUE(game.getGrid().get(top + 8, left + 13));
+
+    // ружье с периодом 30 выпускает глайдер: на поле с рамкой после 30 поколений 36 + 5 клеток
+    for (int generation = 0; generation < 30; ++generation) {
+        game.update();
+    }
+    EXPECT_EQ(game.getGrid().population(), 41u);
+
+    std::istringstream gens("x = 3, y = 1, rule = B2/S/C3\n3o!\n");
+    ASSERT_TRUE(PatternIO::load(gens, game, error, 10, 10)) << error;
+    EXPECT_EQ(game.getRule().getStates(), 3);
+    EXPECT_EQ(game.getWidth(), 10);
+    EXPECT_EQ(game.getGrid().population(), 3u);
+}
+
+// Тест проверяет, что запись в RLE и Macrocell и обратное чтение возвращают то же поле, правило и поколение
+TEST(PatternIOTest, SaveAndLoadRoundTrip) {
+    GameOfLifeCore game(300, 130, 21);
+    game.setRule("B36/S23");
+    for (int generation = 0; generation < 5; ++generation) {
+        game.update();
+    }
+    // длинный отрезок поперек границ слов и пустые строки подряд
+    for (int j = 10; j < 290; ++j) game.setCell(60, j, true);
+    for (int i = 70; i < 90; ++i) {
+        for (int j = 0; j < 300; ++j) game.setCell(i, j, false);
+    }
+
+    for (PatternIO::Format format : {PatternIO::Format::Rle, PatternIO::Format::Macrocell}) {
+        std::stringstream buffer;
+        ASSERT_TRUE(PatternIO::save(buffer, game, format));
+        GameOfLifeCore loaded(8, 8);
+        std::string error;
+        // размер поля берется из файла, без рамки MARGIN
+        ASSERT_TRUE(PatternIO::load(buffer, loaded, error)) << error;
+        EXPECT_EQ(loaded.getRule().toString(), "B36/S23");
+        EXPECT_EQ(loaded.getGeneration(), 5);
+        EXPECT_EQ(loaded.getWidth(), 300);
+        EXPECT_EQ(loaded.getHeight(), 130);
+        EXPECT_TRUE(loaded.getGrid() == game.getGrid());
+
+        // повторная запись не растит поле
+        std::stringstream again;
+        ASSERT_TRUE(PatternIO::save(again, loaded, format));
+        GameOfLifeCore reloaded(8, 8);
+        ASSERT_TRUE(PatternIO::load(again, reloaded, error)) << error;
+        EXPECT_EQ(reloaded.getWidth(), 300);
+        EXPECT_EQ(reloaded.getHeight(), 130);
+        EXPECT_TRUE(reloaded.getGrid() == game.getGrid());
+    }
+}
+
+// Тест проверяет, что одинаковые блоки Macrocell хранятся один раз, а раскладка узлов дает нужные клетки
+TEST(PatternIOTest, MacrocellSharesRepeatedBlocks) {
+    GameOfLifeCore game(256, 256);
+    game.setGrid(BitGrid(256, 256));
+    // 64 одинаковых блинкера в узлах сетки с шагом 32
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            for (int k = 0; k < 3; ++k) game.setCell(i * 32 + 3, j * 32 + 2 + k, true);
+        }
+    }
+    std::stringstream buffer;
+    ASSERT_TRUE(PatternIO::save(buffer, game, PatternIO::Format::Macrocell));
+    std::string text = buffer.str();
+    // заголовок, правило, один лист и по одному узлу на уровни 4..8
+    int lines = 0;
+    for (char c : text) lines += c == '\n';
+    EXPECT_LE(lines, 2 + 1 + 5 * 2);
+
+    GameOfLifeCore loaded(256, 256);
+    std::string error;
+    ASSERT_TRUE(PatternIO::load(buffer, loaded, error)) << error;
+    EXPECT_EQ(loaded.getGrid().population(), 192u);
+    EXPECT_TRUE(loaded.getGrid().get(3, 2));
+    EXPECT_TRUE(loaded.getGrid().get(7 * 32 + 3, 7 * 32 + 4));
+    EXPECT_FALSE(loaded.getGrid().get(3, 1));
+
+    // без размера тора рамка живых клеток 227x225 встает в центр поля: сдвиг 14 по столбцам и 15 по строкам
+    std::string plain = text;
+    plain.erase(plain.find(":T"), plain.find('\n', plain.find(":T")) - plain.find(":T"));
+    std::istringstream in(plain);
+    ASSERT_TRUE(PatternIO::load(in, loaded, error, 256, 256)) << error;
+    EXPECT_EQ(loaded.getGrid().population(), 192u);
+    EXPECT_TRUE(loaded.getGrid().get(15, 14));
+    EXPECT_TRUE(loaded.getGrid().get(15 + 224, 14 + 226));
+    EXPECT_FALSE(loaded.getGrid().get(15, 13));
+}
+
+// Тест проверяет ошибки разбора: поле при этом не меняется
+TEST(PatternIOTest, RejectsMalformedInput) {
+    GameOfLifeCore game(40, 40);
+    BitGrid before = game.getGrid();
+    const char* inputs[] = {
+        "",
+        "#C only a comment\n",
+        "x = 2, y = 2\n3o!\n",           // строка длиннее объявленной
+        "x = 2, y = 2\n2o$2o$2o!\n",     // строк больше объявленных
+        "x = 2, y = 2, rule = Q1\n2o!\n",
+        "x = 2, y = 2\n2z!\n",
+        "[M2]\n4 1 0 0 0\n",              // ссылка на еще не прочитанный узел
+        "[M2]\n**$\n5 1 0 0 0\n",         // ребенок не того уровня
+        "x = 5, y = 2, rule = B3/S23:T4,4\n5o!\n", // образец больше тора
+        "[M2]\n#R B3/S23:T4,4\n**$\n4 0 1 0 0\n", // клетка за пределами тора
+        "#CXRLE Pos=0,0 Gen=1099511627776\nx = 2, y = 2\n2o$2o!\n", // поколение 2^40 не помещается в int
+        "[M2]\n#G 1099511627776\n**$\n4 0 1 0 0\n",
+    };
+    for (const char* text : inputs) {
+        std::istringstream in(text);
+        std::string error;
+        EXPECT_FALSE(PatternIO::load(in, game, error)) << text;
+        EXPECT_FALSE(error.empty());
+    }
+    EXPECT_TRUE(game.getGrid() == before);
+    EXPECT_EQ(game.getWidth(), 40);
+    EXPECT_EQ(game.getGeneration(), 0);
+}
@@ -0,0 +1,107 @@
+#include "Profiler.hpp"
+#include "GameOfLifeCore.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+} // namespace
+
+// Тест проверяет, что процентили гистограммы верны с точностью до ширины корзины (1/8)
+TEST(ProfilerTest, HistogramPercentilesWithinBucketWidth) {
+    Profiler::Histogram histogram;
+    for (std::uint64_t value = 1; value <= 100000; ++value) {
+        histogram.counts[Profiler::Histogram::bucketOf(value)]++;
+        histogram.count++;
+        histogram.sum += value;
+    }
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(0.5)), 50000.0, 50000.0 / 8);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(0.99)), 99000.0, 99000.0 / 8);
+    EXPECT_NEAR(histogram.mean(), 50000.5, 1e-6);
+    EXPECT_EQ(Profiler::Histogram::bucketValue(Profiler::Histogram::bucketOf(7)), 7u);
+    EXPECT_EQ(Profiler::Histogram::bucketOf(~std::uint64_t(0)), Profiler::Histogram::BUCKETS - 1);
+    EXPECT_EQ(Profiler::Histogram().percentile(0.5), 0u);
+}
+
+// Тест проверяет, что выключенный профилировщик ничего не копит, а включенный складывает потоки
+TEST(ProfilerTest, CollectsOnlyWhileEnabledAcrossThreads) {
+    Profiler::setEnabled(false);
+    Profiler::reset();
+    GameOfLifeCore game(64, 64, 5);
+    game.update();
+    EXPECT_EQ(Profiler::collect()[Profiler::Metric::Step].count, 0u);
+
+    Profiler::setEnabled(true);
+    game.update();
+    std::thread other([] {
+        for (int i = 0; i < 10; ++i) {
+            Profiler::record(Profiler::Metric::DrawCalls, 3);
+        }
+    });
+    other.join();
+    Profiler::Summary summary = Profiler::collect();
+    Profiler::setEnabled(false);
+
+    EXPECT_EQ(summary[Profiler::Metric::Step].count, 1u);
+    EXPECT_EQ(summary.last[static_cast<int>(Profiler::Metric::Population)], game.getPopulation());
+    EXPECT_EQ(summary.last[static_cast<int>(Profiler::Metric::CellsChanged)],
+              static_cast<std::uint64_t>(game.getChangedCells()));
+    EXPECT_EQ(summary[Profiler::Metric::DrawCalls].count, 10u);
+    EXPECT_EQ(summary[Profiler::Metric::DrawCalls].percentile(0.99), 3u);
+
+    Profiler::Summary later = summary;
+    later.subtract(summary);
+    EXPECT_EQ(later[Profiler::Metric::DrawCalls].count, 0u);
+}
+
+// Тест проверяет, что трасса записывается в JSON с именами потоков, отрезками и счетчиками
+TEST(ProfilerTest, WritesChromeTrace) {
+    Profiler::reset();
+    Profiler::setThreadName("test");
+    Profiler::setTracing(true);
+    GameOfLifeCore game(64, 64, 5);
+    for (int generation = 0; generation < 3; ++generation) {
+        game.update();
+    }
+    std::string path = tempPath("profiler.json");
+    std::string error;
+    ASSERT_TRUE(Profiler::writeTrace(path, error)) << error;
+    EXPECT_TRUE(Profiler::isTracing());
+    Profiler::setEnabled(false);
+    EXPECT_FALSE(Profiler::isTracing());
+
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::string json = text.str();
+    EXPECT_EQ(json.compare(0, 1, "{"), 0);
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"name\": \"test\"}"), std::string::npos);
+    EXPECT_NE(json.find("{\"name\": \"step\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(json.find("{\"name\": \"population\", \"ph\": \"C\""), std::string::npos);
+    EXPECT_NE(json.find("]}"), std::string::npos);
+    std::remove(path.c_str());
+
+    // новая запись без reset() не тянет за собой события прошлой
+    Profiler::setTracing(true);
+    Profiler::record(Profiler::Metric::DrawCalls, 3);
+    ASSERT_TRUE(Profiler::writeTrace(path, error)) << error;
+    Profiler::setEnabled(false);
+    std::ifstream again(path);
+    std::stringstream second;
+    second << again.rdbuf();
+    json = second.str();
+    EXPECT_EQ(json.find("{\"name\": \"step\""), std::string::npos);
+    EXPECT_NE(json.find("{\"name\": \"draw calls\""), std::string::npos);
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(Profiler::writeTrace(tempPath("missing/dir/trace.json"), error));
+    EXPECT_FALSE(error.empty());
+}
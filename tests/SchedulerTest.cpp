@@ -0,0 +1,51 @@
+#include "Scheduler.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+using Clock = Scheduler::Clock;
+
+Clock::time_point at(Clock::time_point start, int milliseconds) {
+    return start + std::chrono::milliseconds(milliseconds);
+}
+
+} // namespace
+
+// Тест проверяет, что фиксированный шаг копит остаток времени между вызовами
+TEST(SchedulerTest, FixedRateAccumulatesRemainder) {
+    Scheduler scheduler;
+    scheduler.setTargetRate(10.0); // период 100 мс
+    Clock::time_point start = Clock::now();
+    scheduler.restart(start);
+
+    EXPECT_EQ(scheduler.advance(at(start, 50)), 0);
+    EXPECT_EQ(scheduler.advance(at(start, 250)), 2);
+    EXPECT_EQ(scheduler.advance(at(start, 299)), 0); // осталось 99 мс из периода
+    EXPECT_EQ(scheduler.advance(at(start, 300)), 1);
+    EXPECT_TRUE(scheduler.nextDeadline() == at(start, 400));
+}
+
+// Тест проверяет, что после долгой задержки FixedRate догоняет не больше MAX_BACKLOG
+// поколений, а FrameSkip — все отставание, но не дольше MAX_CATCH_UP_SECONDS
+TEST(SchedulerTest, BacklogPolicies) {
+    Clock::time_point start = Clock::now();
+
+    Scheduler fixed;
+    fixed.setTargetRate(10.0);
+    fixed.restart(start);
+    EXPECT_EQ(fixed.advance(at(start, 5000)), Scheduler::MAX_BACKLOG);
+    EXPECT_EQ(fixed.advance(at(start, 5050)), 0); // отставание отброшено
+
+    Scheduler skip;
+    skip.setMode(Scheduler::Mode::FrameSkip);
+    skip.setTargetRate(10.0);
+    skip.restart(start);
+    EXPECT_EQ(skip.advance(at(start, 730)), 7);
+    EXPECT_EQ(skip.advance(at(start, 60000)), 10);
+
+    Scheduler uncapped;
+    uncapped.setMode(Scheduler::Mode::Uncapped);
+    uncapped.restart(start);
+    EXPECT_EQ(uncapped.advance(at(start, 1)), 1);
+    EXPECT_TRUE(uncapped.nextDeadline() <= at(start, 1)); // следующее поколение уже должно
+}
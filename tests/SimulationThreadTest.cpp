@@ -0,0 +1,137 @@
+#include "GameOfLifeCore.hpp"
+#include "SimulationThread.hpp"
+#include "TripleBuffer.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// ждет, пока окно не получит снимок, удовлетворяющий условию
+template <typename Predicate>
+bool waitForSnapshot(SimulationThread& simulation, Predicate predicate) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (std::chrono::steady_clock::now() < deadline) {
+        simulation.acquireSnapshot();
+        if (predicate(simulation.getSnapshot())) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+} // namespace
+
+// Тест проверяет, что читатель тройного буфера видит только целые опубликованные значения
+// и что значения не идут назад
+TEST(SimulationThreadTest, TripleBufferHandsOverWholeValues) {
+    struct Value {
+        int first;
+        int second;
+    };
+    TripleBuffer<Value> buffer(Value{0, 0});
+    const int count = 200000;
+
+    std::thread writer([&buffer] {
+        for (int i = 1; i <= count; ++i) {
+            Value& value = buffer.getWriteBuffer();
+            value.first = i;
+            value.second = -i;
+            buffer.publish();
+        }
+    });
+
+    int last = 0;
+    while (last < count) {
+        if (buffer.acquire()) {
+            const Value& value = buffer.getReadBuffer();
+            ASSERT_EQ(value.second, -value.first);
+            ASSERT_GT(value.first, last);
+            last = value.first;
+        }
+    }
+    writer.join();
+    EXPECT_FALSE(buffer.acquire()); // все уже прочитано
+}
+
+// Тест проверяет, что поколения из потока симуляции совпадают с обычными шагами,
+// а правки применяются между поколениями
+TEST(SimulationThreadTest, SnapshotsMatchSerialUpdates) {
+    GameOfLifeCore game(120, 80, 5);
+    GameOfLifeCore reference(120, 80, 5);
+
+    SimulationThread simulation(game);
+    simulation.start();
+
+    // правка на паузе доходит до снимка без смены поколения
+    simulation.post({SimulationThread::Command::Type::SetCell, 3, 4, !reference.getGrid().get(3, 4)});
+    reference.setCell(3, 4, !reference.getGrid().get(3, 4));
+    ASSERT_TRUE(waitForSnapshot(simulation, [&reference](const SimulationThread::Snapshot& snapshot) {
+        return snapshot.grid == reference.getGrid();
+    }));
+    EXPECT_EQ(simulation.getSnapshot().generation, 0);
+
+    simulation.setMode(Scheduler::Mode::Uncapped);
+    simulation.setRunning(true);
+    ASSERT_TRUE(waitForSnapshot(simulation, [](const SimulationThread::Snapshot& snapshot) {
+        return snapshot.generation >= 50;
+    }));
+    simulation.setRunning(false);
+    simulation.stop();
+
+    // после остановки поле принадлежит вызывающему, а последний снимок — его копия
+    simulation.acquireSnapshot();
+    EXPECT_EQ(simulation.getSnapshot().generation, game.getGeneration());
+    EXPECT_TRUE(simulation.getSnapshot().grid == game.getGrid());
+    while (reference.getGeneration() < game.getGeneration()) {
+        reference.update();
+    }
+    EXPECT_TRUE(game.getGrid() == reference.getGrid());
+}
+
+// Тест проверяет, что снимок помечает новыми номерами только изменившиеся плитки
+TEST(SimulationThreadTest, SnapshotMarksOnlyChangedTiles) {
+    GameOfLifeCore game(256, 64);
+    BitGrid block(256, 64);
+    block.set(40, 200, true); // блок не меняется и не должен попадать в изменения
+    block.set(40, 201, true);
+    block.set(41, 200, true);
+    block.set(41, 201, true);
+    game.setGrid(block);
+    game.update();
+
+    SimulationThread simulation(game);
+    simulation.start();
+    simulation.post({SimulationThread::Command::Type::SetCell, 20, 70, true}); // плитка (1, 1)
+    ASSERT_TRUE(waitForSnapshot(simulation, [](const SimulationThread::Snapshot& snapshot) {
+        return snapshot.version > 0;
+    }));
+
+    const int tilesX = game.getActivity().getTilesX();
+    const SimulationThread::Snapshot& edited = simulation.getSnapshot();
+    for (int tile = 0; tile < static_cast<int>(edited.tileVersions.size()); ++tile) {
+        EXPECT_EQ(edited.tileVersions[tile] != 0, tile == 1 * tilesX + 1) << "tile " << tile;
+    }
+    std::uint32_t editVersion = edited.version;
+
+    // одинокая клетка умирает за поколение, дальше поле не меняется
+    simulation.setMode(Scheduler::Mode::Uncapped);
+    simulation.setRunning(true);
+    ASSERT_TRUE(waitForSnapshot(simulation, [](const SimulationThread::Snapshot& snapshot) {
+        return snapshot.generation >= 10;
+    }));
+    simulation.stop();
+    simulation.acquireSnapshot();
+
+    const SimulationThread::Snapshot& settled = simulation.getSnapshot();
+    EXPECT_EQ(settled.version, editVersion + 1);
+    EXPECT_EQ(settled.grid.population(), 4u);
+    for (int tile = 0; tile < static_cast<int>(settled.tileVersions.size()); ++tile) {
+        if (tile == 1 * tilesX + 1) {
+            EXPECT_EQ(settled.tileVersions[tile], editVersion + 1); // смерть клетки в первом поколении
+        } else {
+            EXPECT_EQ(settled.tileVersions[tile], 0u) << "tile " << tile;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "SoupSearch.hpp"
+#include "GameOfLifeCore.hpp"
+#include <gtest/gtest.h>
+
+// Тест проверяет, что генератор воспроизводим по зерну и потоку, а nextBits дает заданную плотность
+TEST(SoupSearchTest, RandomIsReproducibleAndHonoursDensity) {
+    Random a(42, 7);
+    Random b(42, 7);
+    Random c(42, 8);
+    bool differs = false;
+    for (int i = 0; i < 16; ++i) {
+        std::uint64_t value = a.next();
+        EXPECT_EQ(value, b.next());
+        differs |= value != c.next();
+    }
+    EXPECT_TRUE(differs);
+
+    for (int percent : {10, 25, 50, 75}) {
+        Random random(1);
+        std::uint64_t ones = 0;
+        const int words = 4000;
+        for (int i = 0; i < words; ++i) {
+            ones += static_cast<std::uint64_t>(__builtin_popcountll(random.nextBits(percent)));
+        }
+        EXPECT_NEAR(100.0 * ones / (words * 64.0), percent, 1.0);
+    }
+}
+
+// Тест проверяет перепись объектов: формы узнаются в любом повороте, фигура на краю тора не разрывается
+TEST(SoupSearchTest, CountsObjectsByShape) {
+    BitGrid grid(40, 30);
+    // блок через угол тора
+    grid.set(0, 0, true);
+    grid.set(0, 39, true);
+    grid.set(29, 0, true);
+    grid.set(29, 39, true);
+    // вертикальная мигалка
+    grid.set(10, 10, true);
+    grid.set(11, 10, true);
+    grid.set(12, 10, true);
+    // отраженный глайдер
+    grid.set(20, 21, true);
+    grid.set(21, 20, true);
+    grid.set(22, 20, true);
+    grid.set(22, 21, true);
+    grid.set(22, 22, true);
+    // незнакомая форма
+    grid.set(5, 25, true);
+    grid.set(5, 26, true);
+
+    SoupSearch::Census census;
+    EXPECT_EQ(SoupSearch::countObjects(grid, census), 4);
+    EXPECT_EQ(census["block"], 1u);
+    EXPECT_EQ(census["blinker"], 1u);
+    EXPECT_EQ(census["glider"], 1u);
+    EXPECT_EQ(census["xs2_3"], 1u);
+}
+
+// Тест проверяет, что итог переписи не зависит от числа потоков и порядка, в котором досчитаны супы
+TEST(SoupSearchTest, ReportDoesNotDependOnThreadCount) {
+    SoupSearch::Options options;
+    options.seed = 2024;
+    options.soups = 60;
+    options.fieldWidth = 64;
+    options.fieldHeight = 64;
+    options.maxGenerations = 3000;
+
+    options.threads = 1;
+    SoupSearch::Report serial = SoupSearch::run(options);
+    options.threads = 4;
+    SoupSearch::Report parallel = SoupSearch::run(options);
+
+    EXPECT_EQ(serial.soups, 60u);
+    EXPECT_GT(serial.settled, 0u);
+    EXPECT_EQ(parallel.soups, serial.soups);
+    EXPECT_EQ(parallel.settled, serial.settled);
+    EXPECT_EQ(parallel.extinct, serial.extinct);
+    EXPECT_EQ(parallel.lifespanSum, serial.lifespanSum);
+    EXPECT_EQ(parallel.maxLifespan, serial.maxLifespan);
+    EXPECT_EQ(parallel.maxLifespanSoup, serial.maxLifespanSoup);
+    EXPECT_EQ(parallel.populationSum, serial.populationSum);
+    EXPECT_EQ(parallel.periods, serial.periods);
+    EXPECT_EQ(parallel.objects, serial.objects);
+
+    // отдельный суп досчитывается так же, как внутри прогона
+    GameOfLifeCore game(64, 64);
+    SoupSearch::SoupResult result = SoupSearch::runSoup(game, options, serial.maxLifespanSoup, nullptr);
+    EXPECT_TRUE(result.settled);
+    EXPECT_EQ(result.lifespan, serial.maxLifespan);
+}
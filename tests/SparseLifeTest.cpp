@@ -0,0 +1,91 @@
+#include "GameOfLifeCore.hpp"
+#include "SparseLife.hpp"
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+namespace {
+
+// глайдер, летящий вправо-вниз: за 4 поколения смещается на клетку по обеим осям
+void addGlider(SparseLife& life, std::int64_t row, std::int64_t col) {
+    life.setCell(row, col + 1, true);
+    life.setCell(row + 1, col + 2, true);
+    life.setCell(row + 2, col, true);
+    life.setCell(row + 2, col + 1, true);
+    life.setCell(row + 2, col + 2, true);
+}
+
+} // namespace
+
+// Тест проверяет, что разреженное поле совпадает с тором, пока фигура не дошла до его краев,
+// в том числе на стыках кусков и при отрицательных координатах
+TEST(SparseLifeTest, MatchesTorusAwayFromEdges) {
+    const int size = 256;
+    const int soup = 40;
+    const std::int64_t offsets[][2] = {{0, 0}, {-100, -37}, {-(std::int64_t(1) << 40), 12345}};
+
+    for (const auto& offset : offsets) {
+        GameOfLifeCore torus(size, size, 11);
+        torus.setGrid(BitGrid(size, size));
+        SparseLife sparse;
+        for (int i = 0; i < soup; ++i) {
+            for (int j = 0; j < soup; ++j) {
+                if (std::rand() % 2) {
+                    // суп по центру тора, на разреженном поле — со сдвигом
+                    torus.setCell(100 + i, 100 + j, true);
+                    sparse.setCell(offset[0] + 100 + i, offset[1] + 100 + j, true);
+                }
+            }
+        }
+
+        for (int gen = 0; gen < 50; ++gen) {
+            torus.update();
+            sparse.update();
+        }
+        EXPECT_EQ(sparse.getGeneration(), 50u);
+        EXPECT_EQ(sparse.getPopulation(), torus.getGrid().population());
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                ASSERT_EQ(sparse.getCell(offset[0] + i, offset[1] + j), torus.getGrid()[i][j])
+                    << "offset " << offset[0] << "," << offset[1] << ", cell " << i << "," << j;
+            }
+        }
+    }
+}
+
+// Тест проверяет, что память зависит от населения, а не от расстояния между фигурами
+TEST(SparseLifeTest, MemoryFollowsPopulation) {
+    SparseLife life;
+    const std::int64_t far = std::int64_t(1) << 60;
+    addGlider(life, 0, 0);
+    addGlider(life, far, -far);
+    addGlider(life, -far, far);
+
+    for (int gen = 0; gen < 1000; ++gen) {
+        life.update();
+        // каждый глайдер занимает не больше четырех кусков
+        ASSERT_LE(life.getChunkCount(), 12u) << "generation " << gen;
+    }
+    EXPECT_EQ(life.getPopulation(), 15u);
+    // за 1000 поколений глайдер у начала координат сместился на 250 клеток
+    EXPECT_TRUE(life.getCell(250 + 2, 250 + 2));
+
+    std::int64_t minRow, minCol, maxRow, maxCol;
+    ASSERT_TRUE(life.getBounds(minRow, minCol, maxRow, maxCol));
+    EXPECT_EQ(minRow, -far + 250);
+    EXPECT_EQ(maxRow, far + 250 + 2);
+    EXPECT_EQ(minCol, -far + 250);
+    EXPECT_EQ(maxCol, far + 250 + 2);
+}
+
+// Тест проверяет, что вымершая фигура освобождает все куски
+TEST(SparseLifeTest, EmptyChunksAreReleased) {
+    SparseLife life;
+    life.setCell(63, 63, true); // одинокая клетка на углу куска умирает за поколение
+    life.setCell(63, 64, true);
+    life.update();
+    EXPECT_EQ(life.getPopulation(), 0u);
+    EXPECT_EQ(life.getChunkCount(), 0u);
+
+    std::int64_t minRow, minCol, maxRow, maxCol;
+    EXPECT_FALSE(life.getBounds(minRow, minCol, maxRow, maxCol));
+}
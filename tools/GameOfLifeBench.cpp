@@ -0,0 +1,264 @@
+// Консольный бенчмарк ядра без SFML. Прогоняет фиксированный набор нагрузок с одинаковыми
+// начальными полями и печатает результаты в JSON, чтобы сравнивать версии между собой.
+// --temporal N считает поколения через step() блоками по N поколений вместо update():
+//
+//   GameOfLifeBench [--workload NAME] [--generations N] [--threads N] [--kernel NAME] [--rule RULE]
+//                   [--no-tracking] [--temporal N]
+#include "BitGrid.hpp"
+#include "GameOfLifeCore.hpp"
+#include <sys/resource.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace {
+
+// все выделения памяти через operator new, чтобы увидеть выделения внутри цикла шагов
+std::atomic<std::size_t> heapAllocations{0};
+
+// буферы полей выделяются через aligned_alloc мимо operator new и считаются отдельно
+std::size_t allocationCount() {
+    return heapAllocations.load() + BitGrid::getAllocationCount();
+}
+
+struct Cell {
+    int row;
+    int col;
+};
+
+// ружье Госпера: выпускает глайдер каждые 30 поколений
+const Cell GOSPER_GUN[] = {
+    {0, 24}, {1, 22}, {1, 24}, {2, 12}, {2, 13}, {2, 20}, {2, 21}, {2, 34}, {2, 35},
+    {3, 11}, {3, 15}, {3, 20}, {3, 21}, {3, 34}, {3, 35}, {4, 0}, {4, 1}, {4, 10},
+    {4, 16}, {4, 20}, {4, 21}, {5, 0}, {5, 1}, {5, 10}, {5, 14}, {5, 16}, {5, 17},
+    {5, 22}, {5, 24}, {6, 10}, {6, 16}, {6, 24}, {7, 11}, {7, 15}, {8, 12}, {8, 13}};
+
+// R-пентамино: из пяти клеток вырастает суп, успокаивающийся только через 1103 поколения
+const Cell R_PENTOMINO[] = {{0, 1}, {0, 2}, {1, 0}, {1, 1}, {2, 1}};
+
+const unsigned BENCH_SEED = 20240601;
+
+struct Workload {
+    const char* name;
+    int width;
+    int height;
+    int generations;
+    void (*setup)(GameOfLifeCore& game);
+};
+
+void clearField(GameOfLifeCore& game) {
+    game.setGrid(BitGrid(game.getWidth(), game.getHeight()));
+}
+
+template <std::size_t N>
+void stamp(GameOfLifeCore& game, const Cell (&pattern)[N], int row, int col) {
+    for (const Cell& cell : pattern) {
+        game.setCell(row + cell.row, col + cell.col, true);
+    }
+}
+
+// случайное заполнение с заданной плотностью в процентах, начальное поле зависит только от seed
+void fillRandom(GameOfLifeCore& game, int percentage) {
+    game.randomizeGrid(BENCH_SEED, percentage);
+}
+
+void setupRandom(GameOfLifeCore& game) {
+    fillRandom(game, GameOfLifeCore::RANDOM_FILL_PERCENTAGE);
+}
+
+void setupGliderGuns(GameOfLifeCore& game) {
+    clearField(game);
+    // ружья стоят сеткой с шагом 128 клеток, их глайдеры со временем сталкиваются
+    for (int row = 16; row + 16 < game.getHeight(); row += 128) {
+        for (int col = 16; col + 48 < game.getWidth(); col += 128) {
+            stamp(game, GOSPER_GUN, row, col);
+        }
+    }
+}
+
+void setupRPentomino(GameOfLifeCore& game) {
+    clearField(game);
+    stamp(game, R_PENTOMINO, game.getHeight() / 2, game.getWidth() / 2);
+}
+
+void setupSparse(GameOfLifeCore& game) {
+    fillRandom(game, 1);
+}
+
+const Workload WORKLOADS[] = {
+    {"random40", 1024, 1024, 500, setupRandom},
+    {"gliderGuns", 2048, 2048, 500, setupGliderGuns},
+    {"rPentomino", 1024, 1024, 1200, setupRPentomino},
+    {"sparseLarge", 8192, 8192, 50, setupSparse},
+    {"denseLarge", 8192, 8192, 50, setupRandom},
+    {"denseHuge", 32768, 32768, 16, setupRandom}, // по 128 МБ на буфер: больше кэша любого процессора
+};
+
+struct Options {
+    const char* workload = nullptr;
+    int generations = 0; // 0 — число поколений нагрузки по умолчанию
+    int threads = 1;
+    GameOfLifeCore::Kernel kernel = GameOfLifeCore::bestKernel();
+    LifeRule rule;
+    bool tracking = true;
+    int temporal = 0; // 0 — update() на каждое поколение
+};
+
+const char* kernelName(GameOfLifeCore::Kernel kernel) {
+    switch (kernel) {
+    case GameOfLifeCore::Kernel::Reference: return "reference";
+    case GameOfLifeCore::Kernel::Swar: return "swar";
+    case GameOfLifeCore::Kernel::Avx2: return "avx2";
+    case GameOfLifeCore::Kernel::Avx512: return "avx512";
+    case GameOfLifeCore::Kernel::Lut: return "lut";
+    }
+    return "unknown";
+}
+
+bool parseKernel(const char* name, GameOfLifeCore::Kernel& kernel) {
+    const GameOfLifeCore::Kernel kernels[] = {
+        GameOfLifeCore::Kernel::Reference, GameOfLifeCore::Kernel::Swar,
+        GameOfLifeCore::Kernel::Avx2, GameOfLifeCore::Kernel::Avx512, GameOfLifeCore::Kernel::Lut};
+    for (GameOfLifeCore::Kernel candidate : kernels) {
+        if (std::strcmp(name, kernelName(candidate)) == 0) {
+            kernel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--workload") == 0 && hasValue) {
+            options.workload = argv[++i];
+        } else if (std::strcmp(argv[i], "--generations") == 0 && hasValue) {
+            options.generations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+            if (options.threads < 1) {
+                std::fprintf(stderr, "bad thread count: %s\n", argv[i]);
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--kernel") == 0 && hasValue) {
+            if (!parseKernel(argv[++i], options.kernel)) {
+                std::fprintf(stderr, "unknown kernel: %s\n", argv[i]);
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--rule") == 0 && hasValue) {
+            if (!LifeRule::parse(argv[++i], options.rule)) {
+                std::fprintf(stderr, "invalid rule: %s\n", argv[i]);
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--no-tracking") == 0) {
+            options.tracking = false;
+        } else if (std::strcmp(argv[i], "--temporal") == 0 && hasValue) {
+            options.temporal = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--workload NAME] [--generations N] [--threads N] "
+                         "[--kernel reference|swar|avx2|avx512|lut] [--rule RULE] [--no-tracking] [--temporal N]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    if (!GameOfLifeCore::isKernelSupported(options.kernel)) {
+        std::fprintf(stderr, "kernel %s is not supported on this CPU\n", kernelName(options.kernel));
+        return false;
+    }
+    return true;
+}
+
+// пиковый размер резидентной памяти процесса в килобайтах
+long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void runWorkload(const Workload& workload, const Options& options, bool first) {
+    int generations = options.generations > 0 ? options.generations : workload.generations;
+
+    GameOfLifeCore game(workload.width, workload.height);
+    game.setKernel(options.kernel);
+    game.setThreadCount(options.threads);
+    game.setActivityTracking(options.tracking);
+    if (!game.setRule(options.rule)) {
+        std::fprintf(stderr, "rule %s does not fit workload %s\n", options.rule.toString().c_str(), workload.name);
+        std::exit(1);
+    }
+    workload.setup(game);
+    game.update(); // прогрев: первый шаг будит потоки и трогает память второго буфера
+
+    std::size_t allocations = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    if (options.temporal > 0) {
+        game.step(generations, options.temporal);
+    } else {
+        for (int gen = 0; gen < generations; ++gen) {
+            game.update();
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+    allocations = allocationCount() - allocations;
+
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    double cells = static_cast<double>(workload.width) * workload.height * generations;
+    std::printf("%s    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"generations\": %d, "
+                "\"population\": %zu, \"seconds\": %.6f, \"nsPerGeneration\": %.1f, "
+                "\"cellsPerSecond\": %.4e, \"allocations\": %zu, \"peakRssKb\": %ld}",
+                first ? "" : ",\n", workload.name, workload.width, workload.height, generations,
+                game.getGrid().population(), seconds, seconds * 1e9 / generations,
+                cells / seconds, allocations, peakRssKb());
+    std::fflush(stdout);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::printf("{\n  \"kernel\": \"%s\",\n  \"rule\": \"%s\",\n  \"threads\": %d,\n  \"tracking\": %s,\n"
+                "  \"temporal\": %d,\n  \"workloads\": [\n",
+                kernelName(options.kernel), options.rule.toString().c_str(), options.threads,
+                options.tracking ? "true" : "false", options.temporal);
+    bool first = true;
+    for (const Workload& workload : WORKLOADS) {
+        if (options.workload && std::strcmp(options.workload, workload.name) != 0) {
+            continue;
+        }
+        runWorkload(workload, options, first);
+        first = false;
+    }
+    std::printf("\n  ]\n}\n");
+
+    if (first) {
+        std::fprintf(stderr, "unknown workload: %s\n", options.workload);
+        return 1;
+    }
+    return 0;
+}
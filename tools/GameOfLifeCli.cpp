@@ -0,0 +1,183 @@
+// Консольный запуск ядра без окна: загружает образец RLE, Macrocell или снимок (.ckpt),
+// считает поколения и сохраняет результат (формат — по расширению выходного файла).
+// --checkpoint пишет снимок в фоне каждые --checkpoint-every поколений, --stop-when-stable
+// заканчивает счет, как только поле вымерло, застыло или пошло по циклу, --trace сохраняет
+// замеры шагов в Chrome trace JSON. --tiles делит поле между процессами, обменивающимися
+// ореолами через каждые --halo-steps поколений (без снимков и остановки по устойчивости):
+//
+//   GameOfLifeCli INPUT [--output FILE] [--generations N] [--rule RULE] [--threads N] [--size WxH]
+//                 [--checkpoint FILE] [--checkpoint-every N] [--stop-when-stable] [--trace FILE]
+//                 [--tiles XxY] [--halo-steps N]
+#include "Checkpoint.hpp"
+#include "Distributed.hpp"
+#include "GameOfLifeCore.hpp"
+#include "PatternIO.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace {
+
+struct Options {
+    const char* input = nullptr;
+    const char* output = nullptr;
+    const char* rule = nullptr; // правило из файла, если не задано
+    int generations = 0;
+    int threads = 1;
+    int width = 0; // 0 — по размеру образца
+    int height = 0;
+    const char* checkpoint = nullptr;
+    int checkpointEvery = 1000;
+    bool stopWhenStable = false;
+    const char* trace = nullptr;
+    bool distributed = false;
+    Distributed::Options tiles;
+};
+
+const char* stateName(CycleDetector::State state) {
+    switch (state) {
+    case CycleDetector::State::Extinct:
+        return "extinct";
+    case CycleDetector::State::StillLife:
+        return "still";
+    case CycleDetector::State::Oscillating:
+        return "oscillating";
+    default:
+        return "running";
+    }
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            options.output = argv[++i];
+        } else if (std::strcmp(argv[i], "--generations") == 0 && hasValue) {
+            options.generations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rule") == 0 && hasValue) {
+            options.rule = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+            if (options.threads < 1) {
+                std::fprintf(stderr, "bad thread count: %s\n", argv[i]);
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                std::fprintf(stderr, "bad size: %s\n", argv[i]);
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--checkpoint") == 0 && hasValue) {
+            options.checkpoint = argv[++i];
+        } else if (std::strcmp(argv[i], "--checkpoint-every") == 0 && hasValue) {
+            options.checkpointEvery = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--stop-when-stable") == 0) {
+            options.stopWhenStable = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options.trace = argv[++i];
+        } else if (std::strcmp(argv[i], "--tiles") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.tiles.tilesX, &options.tiles.tilesY) != 2 ||
+                options.tiles.tilesX <= 0 || options.tiles.tilesY <= 0) {
+                std::fprintf(stderr, "bad tiles: %s\n", argv[i]);
+                return false;
+            }
+            options.distributed = true;
+        } else if (std::strcmp(argv[i], "--halo-steps") == 0 && hasValue) {
+            options.tiles.stepsPerExchange = std::max(1, std::atoi(argv[++i]));
+        } else if (argv[i][0] != '-' && !options.input) {
+            options.input = argv[i];
+        } else {
+            options.input = nullptr;
+            break;
+        }
+    }
+    if (!options.input) {
+        std::fprintf(stderr,
+                     "usage: %s INPUT [--output FILE] [--generations N] [--rule RULE] [--threads N] "
+                     "[--size WxH] [--checkpoint FILE] [--checkpoint-every N] [--stop-when-stable] [--trace FILE] "
+                     "[--tiles XxY] [--halo-steps N]\n",
+                     argv[0]);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    GameOfLifeCore game(1, 1); // поле заменит загруженный образец
+    std::string error;
+    bool loaded = Checkpoint::isCheckpoint(options.input)
+                      ? Checkpoint::restore(options.input, game, error)
+                      : PatternIO::loadFile(options.input, game, error, options.width, options.height);
+    if (!loaded) {
+        std::fprintf(stderr, "%s: %s\n", options.input, error.c_str());
+        return 1;
+    }
+    if (options.rule && !game.setRule(options.rule)) {
+        std::fprintf(stderr, "invalid rule for this field: %s\n", options.rule);
+        return 1;
+    }
+    game.setThreadCount(options.threads);
+
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    if (options.checkpoint) {
+        checkpoints = std::make_unique<CheckpointWriter>(options.checkpoint);
+    }
+
+    if (options.trace) {
+        Profiler::setThreadName("main");
+        Profiler::setTracing(true);
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (options.distributed && !Distributed::run(game, options.generations, options.tiles, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    for (int gen = 0; !options.distributed && gen < options.generations; ++gen) {
+        if (options.stopWhenStable && game.isFinished()) {
+            break;
+        }
+        game.update();
+        if (checkpoints && game.getGeneration() % options.checkpointEvery == 0) {
+            checkpoints->request(game.getGrid(), game.getRule(), static_cast<std::uint64_t>(game.getGeneration()));
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    checkpoints.reset(); // дописывает последний принятый снимок
+    if (options.trace && !Profiler::writeTrace(options.trace, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    if (options.output) {
+        bool saved = endsWith(options.output, ".ckpt")
+                         ? Checkpoint::save(options.output, game, error)
+                         : PatternIO::saveFile(options.output, game, PatternIO::formatFromPath(options.output));
+        if (!saved) {
+            std::fprintf(stderr, "cannot write %s %s\n", options.output, error.c_str());
+            return 1;
+        }
+    }
+    const CycleDetector& cycles = game.getCycles();
+    std::printf("{\"width\": %d, \"height\": %d, \"rule\": \"%s\", \"generation\": %d, \"population\": %zu, "
+                "\"state\": \"%s\", \"period\": %d, \"seconds\": %.6f}\n",
+                game.getWidth(), game.getHeight(), game.getRule().toString().c_str(), game.getGeneration(),
+                game.getPopulation(), stateName(cycles.getState()), cycles.getPeriod(), seconds);
+    return 0;
+}
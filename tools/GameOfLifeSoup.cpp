@@ -0,0 +1,108 @@
+// Перепись случайных супов без окна: считает --soups независимых полей на всех ядрах,
+// каждое до вымирания, устойчивой фигуры или цикла, и печатает сводку в JSON
+// (время жизни, население, периоды, объекты по формам):
+//
+//   GameOfLifeSoup [--soups N] [--seed N] [--threads N] [--soup-size N] [--fill PERCENT]
+//                  [--field WxH] [--max-generations N] [--rule RULE]
+#include "SoupSearch.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+bool parseOptions(int argc, char** argv, SoupSearch::Options& options) {
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--soups") == 0 && hasValue) {
+            options.soups = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--soup-size") == 0 && hasValue) {
+            options.soupSize = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--fill") == 0 && hasValue) {
+            options.fillPercent = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--field") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.fieldWidth, &options.fieldHeight) != 2 ||
+                options.fieldWidth <= 0 || options.fieldHeight <= 0) {
+                std::fprintf(stderr, "bad field size: %s\n", argv[i]);
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--max-generations") == 0 && hasValue) {
+            options.maxGenerations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rule") == 0 && hasValue) {
+            if (!LifeRule::parse(argv[++i], options.rule)) {
+                std::fprintf(stderr, "invalid rule: %s\n", argv[i]);
+                return false;
+            }
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--soups N] [--seed N] [--threads N] [--soup-size N] [--fill PERCENT] "
+                         "[--field WxH] [--max-generations N] [--rule RULE]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    int side = 2 * options.rule.getRange() + 1;
+    if (side > options.fieldWidth || side > options.fieldHeight) {
+        std::fprintf(stderr, "rule %s does not fit the field\n", options.rule.toString().c_str());
+        return false;
+    }
+    return true;
+}
+
+double mean(std::uint64_t sum, std::uint64_t count) {
+    return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SoupSearch::Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    SoupSearch::Report report = SoupSearch::run(options);
+
+    std::printf("{\n  \"rule\": \"%s\", \"seed\": %llu, \"soupSize\": %d, \"fill\": %d, \"field\": \"%dx%d\", "
+                "\"threads\": %d,\n",
+                options.rule.toString().c_str(), static_cast<unsigned long long>(options.seed), options.soupSize,
+                options.fillPercent, options.fieldWidth, options.fieldHeight, options.threads);
+    std::printf("  \"soups\": %llu, \"settled\": %llu, \"extinct\": %llu, \"seconds\": %.6f, \"soupsPerSecond\": %.1f,\n",
+                static_cast<unsigned long long>(report.soups), static_cast<unsigned long long>(report.settled),
+                static_cast<unsigned long long>(report.extinct), report.seconds,
+                report.seconds > 0 ? report.soups / report.seconds : 0.0);
+    std::printf("  \"lifespan\": {\"mean\": %.1f, \"max\": %d, \"maxSoup\": %llu},\n",
+                mean(report.lifespanSum, report.settled), report.maxLifespan,
+                static_cast<unsigned long long>(report.maxLifespanSoup));
+    std::printf("  \"population\": {\"mean\": %.1f, \"max\": %zu},\n", mean(report.populationSum, report.soups),
+                report.maxPopulation);
+    std::printf("  \"periods\": {");
+    const char* separator = "";
+    for (const auto& entry : report.periods) {
+        std::printf("%s\"%d\": %llu", separator, entry.first, static_cast<unsigned long long>(entry.second));
+        separator = ", ";
+    }
+    std::printf("},\n");
+
+    // объекты от частых к редким
+    std::vector<std::pair<std::string, std::uint64_t>> objects(report.objects.begin(), report.objects.end());
+    std::stable_sort(objects.begin(), objects.end(),
+                     [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::printf("  \"objectsTotal\": %llu,\n  \"objects\": {", static_cast<unsigned long long>(report.objectSum));
+    separator = "\n    ";
+    for (const auto& entry : objects) {
+        std::printf("%s\"%s\": %llu", separator, entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+        separator = ",\n    ";
+    }
+    std::printf("\n  }\n}\n");
+    return 0;
+}